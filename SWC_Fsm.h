@@ -16,27 +16,98 @@
  * <tr><td>2024/03/04  <td>1.0      <td>                <td>init version
  * <tr><td>2025/09/18  <td>1.1      <td>                <td>make all in one header file
  * <tr><td>2025/09/21  <td>1.2      <td>                <td>add error type and handler
+ * <tr><td>2026/10/17  <td>1.3      <td>                <td>add CSR transition index, widen table size
+ * <tr><td>2026/10/17  <td>1.4      <td>                <td>add FSM_STATE_MAP dense state slot map
+ * <tr><td>2026/10/17  <td>1.5      <td>                <td>add FSM_INSTANCE_POOL shared definition with SoA instances
+ * <tr><td>2026/10/17  <td>1.6      <td>                <td>add FSM_EVENT_QUEUE lock-free event queue and dispatch
+ * <tr><td>2026/10/17  <td>1.7      <td>                <td>add FSM_EVENT_TABLE event keyed transition matrix
+ * <tr><td>2026/10/17  <td>1.8      <td>                <td>add FSM_CONCURRENT atomic state word
+ * <tr><td>2026/10/17  <td>1.9      <td>                <td>add FSM_ROUTINE_BATCH batch routine executor
+ * <tr><td>2026/10/17  <td>1.10     <td>                <td>add FSM_SCHEDULER work-stealing routine scheduler
+ * <tr><td>2026/10/17  <td>1.11     <td>                <td>add FSM_TIMER_WHEEL routine intervals and state timeouts
+ * <tr><td>2026/10/17  <td>1.12     <td>                <td>add FSM_TRACE binary transition trace ring
+ * <tr><td>2026/10/17  <td>1.13     <td>                <td>add FSM_STATS latency histograms and transition counters
+ * <tr><td>2026/10/17  <td>1.14     <td>                <td>add microbenchmark suite and CMake build, FSM_FUNC overridable for FSM_IMPLEMENTATION
+ * <tr><td>2026/10/17  <td>1.15     <td>                <td>add SWC_Fsm.hpp compile-time C++ front-end, C++ safe NULL and initializer order
+ * <tr><td>2026/10/17  <td>1.16     <td>                <td>add FSM_HIERARCHY nested states with precomputed exit/entry paths
+ * <tr><td>2026/10/17  <td>1.17     <td>                <td>add FSM_DEFERRED transition requests applied after the running action
+ * <tr><td>2026/10/17  <td>1.18     <td>                <td>add FSM_SNAPSHOT memory-mapped snapshot and restore checked by a table hash
+ * <tr><td>2026/10/18  <td>1.19     <td>                <td>add DECLARE_SWC_FSM_CONTEXT_PREBUILT for tables emitted by tools/fsmc
+ * <tr><td>2026/10/18  <td>1.20     <td>                <td>add FSM_ROUTE swcFsmRouteTo over a precomputed next-hop table
+ * <tr><td>2026/10/18  <td>1.21     <td>                <td>add FSM_DFA bulk stepping of callback-free event tables, AVX2 gather kernel
+ * <tr><td>2026/10/18  <td>1.22     <td>                <td>add FSM_ASYNC actions returning FSM_PENDING, resumed by swcFsmRoutine
+ * <tr><td>2026/10/18  <td>1.23     <td>                <td>add FSM_BUILDER contexts assembled at runtime into one caller arena
+ * <tr><td>2026/10/18  <td>1.24     <td>                <td>add FSM_RECORD transition recorder and table replay with logged guard outcomes
+ * <tr><td>2026/10/18  <td>1.25     <td>                <td>add FSM_REGISTRY direct-indexed context registry keyed by fsmContextID
+ * <tr><td>2026/10/18  <td>1.26     <td>                <td>add FSM_ERROR_QUEUE coalesced, rate-limited error records drained off the hot path
+ * <tr><td>2026/10/18  <td>1.27     <td>                <td>add FSM_SHARD_POOL per-thread instance shards, page isolated and pinned to a cpu
  * </table>
  */
 #ifndef SWC_FSM_H_
 #define SWC_FSM_H_
 
+/**
+ * clock_gettime, clock_nanosleep, ftruncate and fsync are POSIX, and syscall is not even that, a strict
+ * -std=c99 / -std=c11 hides them. the feature test macro only works ahead of the first system header,
+ * include this header first or define one yourself.
+ */
+#if defined( __STRICT_ANSI__ ) && !defined( _GNU_SOURCE ) && !defined( _DEFAULT_SOURCE ) && !defined( _POSIX_C_SOURCE ) && !defined( _XOPEN_SOURCE )
+#if defined( FSM_SHARD_POOL ) && defined( __linux__ )
+// POSIX 2008 as well
+#define _DEFAULT_SOURCE
+#elif defined( FSM_SCHEDULER ) || defined( FSM_TRACE ) || defined( FSM_STATS ) || defined( FSM_ERROR_QUEUE ) || defined( FSM_SNAPSHOT )
+#define _POSIX_C_SOURCE 200809L
+#endif
+#endif
+
 #include <stdint.h>
+#if defined( FSM_SCHEDULER ) || defined( FSM_TRACE ) || defined( FSM_STATS ) || defined( FSM_ERROR_QUEUE )
+#include <time.h>
+#endif
+#ifdef FSM_SCHEDULER
+#include <errno.h>
+#include <pthread.h>
+#endif
+#ifdef FSM_TRACE
+#include <stdio.h>
+#endif
+#ifdef FSM_SNAPSHOT
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined( FSM_DFA ) && defined( __AVX2__ ) && !defined( FSM_DFA_SCALAR )
+#include <immintrin.h>
+#endif
+#if defined( FSM_SHARD_POOL ) && defined( __linux__ )
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define FSM_MAJOR_VERSION   1
-#define FSM_MINOR_VERSION   2
+#define FSM_MINOR_VERSION   27
 
 // Inline control for debugging and optimization
 #ifdef FSM_DEBUG
 #define FSM_INLINE static
-#define FSM_FUNC static
 #else
 #define FSM_INLINE static inline
+#endif
+// FSM_FUNC may be predefined empty by the one source file that provides the
+// functions declared extern under FSM_IMPLEMENTATION, the small getters then
+// follow it and stay inline everywhere else
+#ifdef FSM_FUNC
+#define FSM_GETTER FSM_FUNC
+#else
 #define FSM_FUNC static
+#define FSM_GETTER FSM_INLINE
 #endif
 
 typedef uint8_t                                 fsm_bool_t;
@@ -44,42 +115,434 @@ typedef uint8_t                                 fsm_bool_t;
 #define DEF_FSM_FALSE                           0
 
 #ifndef NULL
+#ifdef __cplusplus
+#define NULL                                    0
+#else
 #define NULL                                    ( ( void* )0 )
 #endif
+#endif
 
 #ifndef UNUSED
 #define UNUSED(X)                               ( void )( X )
 #endif
 
+#ifndef DEF_SWC_FSM_CACHE_LINE
+#define DEF_SWC_FSM_CACHE_LINE                  ( 64U )
+#endif
+
+// alignment of static tables, used by the headers tools/fsmc emits
+#ifndef FSM_ALIGNED
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define FSM_ALIGNED( _n )                       __attribute__( ( aligned( _n ) ) )
+#else
+#define FSM_ALIGNED( _n )
+#endif
+#endif
+
+// atomics used by the lock-free options, provide your own for compilers without __atomic builtins
+#ifndef FSM_ATOMIC_LOAD
+#define FSM_ATOMIC_LOAD( _ptr )                         __atomic_load_n( _ptr, __ATOMIC_ACQUIRE )
+#define FSM_ATOMIC_LOAD_RELAXED( _ptr )                 __atomic_load_n( _ptr, __ATOMIC_RELAXED )
+#define FSM_ATOMIC_STORE( _ptr, _val )                  __atomic_store_n( _ptr, _val, __ATOMIC_RELEASE )
+#define FSM_ATOMIC_STORE_RELAXED( _ptr, _val )          __atomic_store_n( _ptr, _val, __ATOMIC_RELAXED )
+#define FSM_ATOMIC_CAS( _ptr, _expected, _desired )     __atomic_compare_exchange_n( _ptr, _expected, _desired, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+#define FSM_ATOMIC_CAS_STRONG( _ptr, _expected, _desired )  __atomic_compare_exchange_n( _ptr, _expected, _desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED )
+#define FSM_ATOMIC_FETCH_ADD( _ptr, _val )              __atomic_fetch_add( _ptr, _val, __ATOMIC_ACQ_REL )
+#define FSM_ATOMIC_FENCE()                              __atomic_thread_fence( __ATOMIC_SEQ_CST )
+#define FSM_ATOMIC_FENCE_RELEASE()                      __atomic_thread_fence( __ATOMIC_RELEASE )
+#define FSM_ATOMIC_FENCE_ACQUIRE()                      __atomic_thread_fence( __ATOMIC_ACQUIRE )
+#endif
+#ifndef FSM_ATOMIC_FETCH_OR
+#define FSM_ATOMIC_FETCH_OR( _ptr, _val )               __atomic_fetch_or( _ptr, _val, __ATOMIC_ACQ_REL )
+#define FSM_ATOMIC_FETCH_AND( _ptr, _val )              __atomic_fetch_and( _ptr, _val, __ATOMIC_ACQ_REL )
+#define FSM_ATOMIC_EXCHANGE( _ptr, _val )               __atomic_exchange_n( _ptr, _val, __ATOMIC_ACQ_REL )
+#endif
+
+// count trailing / leading zeros of a non zero 64 bit word
+#ifndef FSM_CTZ64
+#define FSM_CTZ64( _x )                                 __builtin_ctzll( _x )
+#endif
+#ifndef FSM_CLZ64
+#define FSM_CLZ64( _x )                                 __builtin_clzll( _x )
+#endif
+
 typedef uint16_t                                fsm_context_id_t;
 typedef uint16_t                                fsm_state_t;
+typedef uint32_t                                fsm_index_t;
+typedef uint16_t                                fsm_event_t;
 
 #define DEF_SWC_FSM_CONTEXT_ID_RESERVE          ( ( fsm_context_id_t )0U )
 #define DEF_SWC_FSM_CONTEXT_ID_INVALID          ( ( fsm_context_id_t )0xFFFFU )
 
 //#define DEF_SWC_FSM_STATE_RESERVE               ( ( fsm_state_t )0U )
 #define DEF_SWC_FSM_STATE_INVALID               ( ( fsm_state_t )0xFFFFU )
+#define DEF_SWC_FSM_INDEX_INVALID               ( ( fsm_index_t )0xFFFFFFFFU )
+#define DEF_SWC_FSM_EVENT_INVALID               ( ( fsm_event_t )0xFFFFU )
 
-#define DECLARE_SWC_FSM_CONTEXT( _name, _fsmID, _fsmStateList, _fsmTransTable, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit ) \
-    static SWCFsmStateItem s_fsmState##_name[] = {_fsmStateList}; \
-    static SWCFsmTransItem s_fsmTransTable##_name[] = {_fsmTransTable}; \
+#if defined( FSM_STATE_FF ) && defined( FSM_STATE_MAP )
+#error "FSM_STATE_FF and FSM_STATE_MAP are exclusive"
+#endif
+
+#if defined( FSM_DFA ) && !defined( FSM_EVENT_TABLE )
+#error "FSM_DFA steps the transitions of an event table, it needs FSM_EVENT_TABLE"
+#endif
+
+#if defined( FSM_SHARD_POOL ) && !defined( FSM_INSTANCE_POOL )
+#error "FSM_SHARD_POOL shards instance pools, it needs FSM_INSTANCE_POOL"
+#endif
+
+#ifdef FSM_STATE_MAP
+// map entries per state, ids spread over a wider range than this use the hash map
+#ifndef DEF_SWC_FSM_STATE_MAP_FACTOR
+#define DEF_SWC_FSM_STATE_MAP_FACTOR            ( 4U )
+#endif
+#define DEF_SWC_FSM_STATE_MAP_SIZE( _stateSize )    ( ( _stateSize ) * DEF_SWC_FSM_STATE_MAP_FACTOR )
+
+#define DEF_SWC_FSM_STATE_MAP_NONE              ( 0U )
+#define DEF_SWC_FSM_STATE_MAP_DIRECT            ( 1U )
+#define DEF_SWC_FSM_STATE_MAP_HASH              ( 2U )
+
+#define DECLARE_SWC_FSM_STATE_MAP_STORAGE( _name ) \
+    static fsm_index_t s_fsmStateMap##_name[ DEF_SWC_FSM_STATE_MAP_SIZE( sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ) ];
+#define DECLARE_SWC_FSM_STATE_MAP_REF( _name ) \
+        .fsmStateMap            = ( s_fsmStateMap##_name ), \
+        .fsmStateMapSize        = DEF_SWC_FSM_STATE_MAP_SIZE( sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ),
+#else
+#define DECLARE_SWC_FSM_STATE_MAP_STORAGE( _name )
+#define DECLARE_SWC_FSM_STATE_MAP_REF( _name )
+#endif
+
+#ifdef FSM_EVENT_QUEUE
+// events per context, must be a power of 2
+#ifndef DEF_SWC_FSM_EVENT_QUEUE_SIZE
+#define DEF_SWC_FSM_EVENT_QUEUE_SIZE            ( 32U )
+#endif
+// the cells are indexed through a mask, and with a single cell "filled" ( base + 1 ) and "free" ( base + size ) are one value
+#if ( DEF_SWC_FSM_EVENT_QUEUE_SIZE < 2 ) || ( ( DEF_SWC_FSM_EVENT_QUEUE_SIZE & ( DEF_SWC_FSM_EVENT_QUEUE_SIZE - 1 ) ) != 0 )
+#error "DEF_SWC_FSM_EVENT_QUEUE_SIZE must be a power of 2 and at least 2"
+#endif
+
+#define DECLARE_SWC_FSM_EVENT_QUEUE_STORAGE( _name ) \
+    static SWCFsmEventCell s_fsmEventCell##_name[ DEF_SWC_FSM_EVENT_QUEUE_SIZE ]; \
+    static SWCFsmEventQueue s_fsmEventQueue##_name = { \
+        .mask                   = DEF_SWC_FSM_EVENT_QUEUE_SIZE - 1U, \
+        .cells                  = ( s_fsmEventCell##_name ) \
+    };
+#define DECLARE_SWC_FSM_EVENT_QUEUE_REF( _name ) \
+        .fsmEventQueue          = &( s_fsmEventQueue##_name ),
+#else
+#define DECLARE_SWC_FSM_EVENT_QUEUE_STORAGE( _name )
+#define DECLARE_SWC_FSM_EVENT_QUEUE_REF( _name )
+#endif
+
+#ifdef FSM_CONCURRENT
+// packed state word: curState in bits 0-15, preState in bits 16-31, sequence in bits 32-63, odd while a transition runs
+#define DEF_SWC_FSM_WORD_PACK( _cur, _pre, _seq )   ( ( uint64_t )( _cur ) | ( ( uint64_t )( _pre ) << 16 ) | ( ( uint64_t )( _seq ) << 32 ) )
+#define DEF_SWC_FSM_WORD_CUR( _word )               ( ( fsm_state_t )( ( _word ) & 0xFFFFU ) )
+#define DEF_SWC_FSM_WORD_PRE( _word )               ( ( fsm_state_t )( ( ( _word ) >> 16 ) & 0xFFFFU ) )
+#define DEF_SWC_FSM_WORD_SEQ( _word )               ( ( uint32_t )( ( _word ) >> 32 ) )
+
+#define DECLARE_SWC_FSM_CONCURRENT_REF( _name ) \
+        .fsmStateWord           = DEF_SWC_FSM_WORD_PACK( DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID, 0U ),
+#else
+#define DECLARE_SWC_FSM_CONCURRENT_REF( _name )
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+// 4 levels of 64 slots with 1 ms resolution, timers further out than 2^24 ms are placed again on the way down
+#define DEF_SWC_FSM_WHEEL_BITS                  ( 6U )
+#define DEF_SWC_FSM_WHEEL_SLOTS                 ( 1U << DEF_SWC_FSM_WHEEL_BITS )
+#define DEF_SWC_FSM_WHEEL_MASK                  ( DEF_SWC_FSM_WHEEL_SLOTS - 1U )
+#define DEF_SWC_FSM_WHEEL_LEVELS                ( 4U )
+#define DEF_SWC_FSM_WHEEL_RANGE                 ( 1ULL << ( DEF_SWC_FSM_WHEEL_BITS * DEF_SWC_FSM_WHEEL_LEVELS ) )
+#define DEF_SWC_FSM_WHEEL_IDLE                  ( 0xFFFFFFFFU )
+
+#define DEF_SWC_FSM_TIMER_ROUTINE               ( 0U )      // fsmRoutine every fsmRoutineInterval
+#define DEF_SWC_FSM_TIMER_STATE                 ( 1U )      // state routine every routineInterval
+#define DEF_SWC_FSM_TIMER_TIMEOUT               ( 2U )      // one shot timeout of the current state
+#define DEF_SWC_FSM_TIMER_KINDS                 ( 3U )
+
+#define DECLARE_SWC_FSM_TIMER_STORAGE( _name ) \
+    static SWCFsmTimer s_fsmTimer##_name[ DEF_SWC_FSM_TIMER_KINDS ];
+#define DECLARE_SWC_FSM_TIMER_REF( _name ) \
+        .fsmTimers              = ( s_fsmTimer##_name ),
+
+#define DECLARE_SWC_FSM_TIMER_WHEEL( _name ) \
+    static SWCFsmTimerWheel s_fsmTimerWheel##_name;
+#define DECLARE_SWC_FSM_TIMER_WHEEL_REF( _name )    ( &( s_fsmTimerWheel##_name ) )
+#else
+#define DECLARE_SWC_FSM_TIMER_STORAGE( _name )
+#define DECLARE_SWC_FSM_TIMER_REF( _name )
+#endif
+
+#ifdef FSM_TRACE
+// records per ring, must be a power of 2
+#ifndef DEF_SWC_FSM_TRACE_SIZE
+#define DEF_SWC_FSM_TRACE_SIZE                  ( 1024U )
+#endif
+
+#define DEF_SWC_FSM_TRACE_TRANS                 ( 1U )      // swcFsmTransTo, swcFsmHandleEvent
+#define DEF_SWC_FSM_TRACE_ROUTINE               ( 2U )      // swcFsmRoutine
+
+// timestamps and durations in ns by default, define FSM_TRACE_CLOCK for a cheaper counter such as the TSC
+#ifndef FSM_TRACE_CLOCK
+#define FSM_TRACE_CLOCK()                       swcFsmClockNs()
+#endif
+
+// one ring may be shared by several contexts, e.g. all contexts run by one thread
+#define DECLARE_SWC_FSM_TRACE_RING( _name ) \
+    static SWCFsmTraceRecord s_fsmTraceRecord##_name[ DEF_SWC_FSM_TRACE_SIZE ]; \
+    static SWCFsmTraceRing s_fsmTraceRing##_name = { \
+        .head                   = 0, \
+        .padding                = { 0 }, \
+        .mask                   = DEF_SWC_FSM_TRACE_SIZE - 1U, \
+        .records                = ( s_fsmTraceRecord##_name ) \
+    };
+
+#define DECLARE_SWC_FSM_TRACE_RING_REF( _name )     ( &( s_fsmTraceRing##_name ) )
+#endif
+
+#ifdef FSM_RECORD
+#define DEF_SWC_FSM_RECORD_FORCE                ( 0x01U )   // bForce of the request
+#define DEF_SWC_FSM_RECORD_REJECTED             ( 0x02U )   // the guards of the row found refused the transition
+#define DEF_SWC_FSM_RECORD_RESUME               ( 0x04U )   // swcFsmResume of a pending transition to state
+#define DEF_SWC_FSM_RECORD_START                ( 0x08U )   // swcFsmRecordAttach, nextState is the state recording starts from
+#define DEF_SWC_FSM_RECORD_EVENT                ( 0x10U )   // swcFsmHandleEvent, state holds the event
+
+// one recorder may be shared by the contexts of many threads, records are appended until it is full
+#define DECLARE_SWC_FSM_RECORDER( _name, _capacity ) \
+    static SWCFsmRecord s_fsmRecord##_name[ _capacity ]; \
+    static SWCFsmRecorder s_fsmRecorder##_name = { \
+        .head                   = 0, \
+        .dropped                = 0, \
+        .capacity               = ( _capacity ), \
+        .records                = ( s_fsmRecord##_name ) \
+    };
+
+#define DECLARE_SWC_FSM_RECORDER_REF( _name )   ( &( s_fsmRecorder##_name ) )
+#endif
+
+#ifdef FSM_REGISTRY
+// registered IDs are below this, a multiple of 64, the whole 16 bit ID space by default
+#ifndef DEF_SWC_FSM_REGISTRY_SIZE
+#define DEF_SWC_FSM_REGISTRY_SIZE               ( 65536U )
+#endif
+
+#define DECLARE_SWC_FSM_REGISTRY( _name ) \
+    static SWCFsmContext* s_fsmRegistryContexts##_name[ DEF_SWC_FSM_REGISTRY_SIZE ] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ); \
+    static uint64_t s_fsmRegistryOccupied##_name[ DEF_SWC_FSM_REGISTRY_SIZE / 64U ]; \
+    static SWCFsmRegistry s_fsmRegistry##_name = { \
+        .contexts               = ( s_fsmRegistryContexts##_name ), \
+        .occupied               = ( s_fsmRegistryOccupied##_name ), \
+        .count                  = 0 \
+    };
+
+#define DECLARE_SWC_FSM_REGISTRY_REF( _name )   ( &( s_fsmRegistry##_name ) )
+#endif
+
+// action kinds of a state item
+#define DEF_SWC_FSM_ACTION_ENTRY                ( 0U )
+#define DEF_SWC_FSM_ACTION_EXIT                 ( 1U )
+#define DEF_SWC_FSM_ACTION_ROUTINE              ( 2U )
+#define DEF_SWC_FSM_ACTION_COUNT                ( 3U )
+
+#ifdef FSM_ASYNC
+// phase of the transition a context is in the middle of, zero so contexts start with none
+#define DEF_SWC_FSM_PENDING_NONE                ( 0U )
+#define DEF_SWC_FSM_PENDING_EXIT                ( 1U )
+#define DEF_SWC_FSM_PENDING_ENTRY               ( 2U )
+
+#define FSM_IN_TRANSITION( _context )           ( ( _context )->fsmPending.phase != DEF_SWC_FSM_PENDING_NONE )
+
+// per thread, the frame slot of the action running for a transition
+#if defined( __cplusplus )
+#define FSM_THREAD_LOCAL                        thread_local
+#elif defined( __STDC_VERSION__ ) && ( __STDC_VERSION__ >= 201112L )
+#define FSM_THREAD_LOCAL                        _Thread_local
+#else
+#define FSM_THREAD_LOCAL                        __thread
+#endif
+#else
+#define FSM_IN_TRANSITION( _context )           ( DEF_FSM_FALSE )
+#endif
+
+#ifdef FSM_STATS
+// log2 latency buckets, bucket 0 holds 0 ns, bucket b holds [ 2^(b-1), 2^b ) ns, the last one everything above
+#ifndef DEF_SWC_FSM_STATS_BUCKETS
+#define DEF_SWC_FSM_STATS_BUCKETS               ( 32U )
+#endif
+
+#ifndef FSM_STATS_CLOCK
+#define FSM_STATS_CLOCK()                       swcFsmClockNs()
+#endif
+
+// single writer increment, readers see whole values without a locked instruction on the hot path
+#define FSM_STATS_ADD( _ptr, _val )             FSM_ATOMIC_STORE_RELAXED( _ptr, FSM_ATOMIC_LOAD_RELAXED( _ptr ) + ( _val ) )
+
+#define DECLARE_SWC_FSM_STATS_STORAGE( _name ) \
+    static SWCFsmStateStats s_fsmStateStats##_name[ sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ]; \
+    static SWCFsmTransStats s_fsmTransStats##_name[ sizeof( s_fsmTransTable##_name ) / sizeof( SWCFsmTransItem ) ];
+#define DECLARE_SWC_FSM_STATS_REF( _name ) \
+        .fsmStateStats          = ( s_fsmStateStats##_name ), \
+        .fsmTransStats          = ( s_fsmTransStats##_name ),
+#else
+#define DECLARE_SWC_FSM_STATS_STORAGE( _name )
+#define DECLARE_SWC_FSM_STATS_REF( _name )
+#endif
+
+#ifdef FSM_HIERARCHY
+// levels of nesting, the state itself included
+#ifndef DEF_SWC_FSM_HIERARCHY_DEPTH
+#define DEF_SWC_FSM_HIERARCHY_DEPTH             ( 8U )
+#endif
+
+#define DECLARE_SWC_FSM_HIERARCHY_STORAGE( _name ) \
+    static SWCFsmStateChain s_fsmStateChain##_name[ sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ];
+#define DECLARE_SWC_FSM_HIERARCHY_REF( _name ) \
+        .fsmStateChain          = ( s_fsmStateChain##_name ),
+#define DECLARE_SWC_FSM_PARENT_REF( _parent ) \
+        , .parent               = ( _parent )
+// superstates shared by both ends of an index edge, see swcFsmLcaLevel
+#define DEF_SWC_FSM_EDGE_LCA( _edge )           ( ( _edge )->lcaLevel )
+#else
+#define DECLARE_SWC_FSM_HIERARCHY_STORAGE( _name )
+#define DECLARE_SWC_FSM_HIERARCHY_REF( _name )
+#define DECLARE_SWC_FSM_PARENT_REF( _parent )
+#define DEF_SWC_FSM_EDGE_LCA( _edge )           ( 0U )
+#endif
+
+#ifdef FSM_DEFERRED
+// transitions requested per context while its actions run, must be a power of 2
+#ifndef DEF_SWC_FSM_DEFER_SIZE
+#define DEF_SWC_FSM_DEFER_SIZE                  ( 8U )
+#endif
+#if ( DEF_SWC_FSM_DEFER_SIZE < 1 ) || ( ( DEF_SWC_FSM_DEFER_SIZE & ( DEF_SWC_FSM_DEFER_SIZE - 1 ) ) != 0 )
+#error "DEF_SWC_FSM_DEFER_SIZE must be a power of 2"
+#endif
+// the queue and its depth belong to the thread running the context, a claim does not cover requests of other threads
+#ifdef FSM_CONCURRENT
+#error "FSM_DEFERRED cannot be combined with FSM_CONCURRENT"
+#endif
+
+#define DECLARE_SWC_FSM_DEFER_STORAGE( _name ) \
+    static SWCFsmDeferQueue s_fsmDeferQueue##_name;
+#define DECLARE_SWC_FSM_DEFER_REF( _name ) \
+        .fsmDeferQueue          = &( s_fsmDeferQueue##_name ),
+#else
+#define DECLARE_SWC_FSM_DEFER_STORAGE( _name )
+#define DECLARE_SWC_FSM_DEFER_REF( _name )
+#endif
+
+#ifdef FSM_ROUTE
+// next-hop slot for every pair of slots plus one row of search scratch, 4 * ( N + 1 ) * N bytes for N states
+#define DECLARE_SWC_FSM_ROUTE_STORAGE( _name ) \
+    static fsm_index_t s_fsmRouteNext##_name[ ( sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) + 1 ) * \
+        ( sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ) ];
+#define DECLARE_SWC_FSM_ROUTE_REF( _name ) \
+        .fsmRouteNext           = ( s_fsmRouteNext##_name ),
+#else
+#define DECLARE_SWC_FSM_ROUTE_STORAGE( _name )
+#define DECLARE_SWC_FSM_ROUTE_REF( _name )
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+// records per queue, must be a power of 2
+#ifndef DEF_SWC_FSM_ERROR_QUEUE_SIZE
+#define DEF_SWC_FSM_ERROR_QUEUE_SIZE            ( 256U )
+#endif
+// one gate per error code, indexed by -error, gate 0 takes codes out of range
+#define DEF_SWC_FSM_ERROR_CODES                 ( 18U )
+#define DEF_SWC_FSM_ERROR_GATE( _error )        ( ( ( ( _error ) < 0 ) && ( -( _error ) < ( int )DEF_SWC_FSM_ERROR_CODES ) ) ? ( uint32_t )( -( _error ) ) : 0U )
+
+// ms, define FSM_ERROR_CLOCK for a cheaper coarse clock
+#ifndef FSM_ERROR_CLOCK
+#define FSM_ERROR_CLOCK()                       ( swcFsmClockNs() / 1000000ULL )
+#endif
+
+#define DECLARE_SWC_FSM_ERROR_STORAGE( _name ) \
+    static SWCFsmErrorGate s_fsmErrorGate##_name[ DEF_SWC_FSM_ERROR_CODES ];
+#define DECLARE_SWC_FSM_ERROR_REF( _name ) \
+        .fsmErrorGates          = ( s_fsmErrorGate##_name ),
+
+// one queue may take the errors of many contexts, at most one record per context and code every _interval ms
+#define DECLARE_SWC_FSM_ERROR_QUEUE( _name, _interval ) \
+    static SWCFsmErrorRecord s_fsmErrorRecord##_name[ DEF_SWC_FSM_ERROR_QUEUE_SIZE ]; \
+    static SWCFsmErrorQueue s_fsmErrorQueue##_name = { \
+        .mask                   = DEF_SWC_FSM_ERROR_QUEUE_SIZE - 1U, \
+        .interval               = ( _interval ), \
+        .records                = ( s_fsmErrorRecord##_name ) \
+    };
+
+#define DECLARE_SWC_FSM_ERROR_QUEUE_REF( _name )    ( &( s_fsmErrorQueue##_name ) )
+#else
+#define DECLARE_SWC_FSM_ERROR_STORAGE( _name )
+#define DECLARE_SWC_FSM_ERROR_REF( _name )
+#endif
+
+/**
+ * context over s_fsmState##_name, s_fsmTransTable##_name, s_fsmTransOffset##_name, s_fsmTransEdge##_name
+ * and s_fsmStateTarget##_name declared beforehand, with the storage of the enabled features.
+ * _indexReady tells swcFsmInit whether the offsets, edges and target flags are filled in already.
+ */
+#define DECLARE_SWC_FSM_CONTEXT_BODY( _name, _fsmID, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit, _indexReady ) \
+    DECLARE_SWC_FSM_STATE_MAP_STORAGE( _name ) \
+    DECLARE_SWC_FSM_EVENT_QUEUE_STORAGE( _name ) \
+    DECLARE_SWC_FSM_TIMER_STORAGE( _name ) \
+    DECLARE_SWC_FSM_STATS_STORAGE( _name ) \
+    DECLARE_SWC_FSM_HIERARCHY_STORAGE( _name ) \
+    DECLARE_SWC_FSM_DEFER_STORAGE( _name ) \
+    DECLARE_SWC_FSM_ROUTE_STORAGE( _name ) \
+    DECLARE_SWC_FSM_ERROR_STORAGE( _name ) \
     static SWCFsmContext s_fsmContext##_name = { \
         .initState              = _fsmInitState, \
         .curState               = DEF_SWC_FSM_STATE_INVALID, \
         .preState               = DEF_SWC_FSM_STATE_INVALID, \
+        .curSlot                = DEF_SWC_FSM_INDEX_INVALID, \
         .fsmStateList           = ( s_fsmState##_name ), \
         .fsmTransTable          = ( s_fsmTransTable##_name ), \
+        .fsmTransOffset         = ( s_fsmTransOffset##_name ), \
+        .fsmTransEdge           = ( s_fsmTransEdge##_name ), \
+        .fsmStateTarget         = ( s_fsmStateTarget##_name ), \
+        DECLARE_SWC_FSM_STATE_MAP_REF( _name ) \
         .fsmCommonCheck         = _fsmCommonCheck, \
-        .fsmErrorHandler        = _fsmErrorHandler, \
         .fsmStateSize           = sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ), \
         .fsmTransitionSize      = sizeof( s_fsmTransTable##_name ) / sizeof( SWCFsmTransItem ), \
+        .fsmIndexReady          = _indexReady, \
         .fsmRoutineInterval     = _fsmRoutineInterval, \
         .fsmContextID           = _fsmID, \
         .fsmInit                = _fsmInit, \
         .fsmRoutine             = _fsmRoutine, \
-        .fsmExit                = _fsmExit \
+        .fsmExit                = _fsmExit, \
+        .fsmErrorHandler        = _fsmErrorHandler, \
+        DECLARE_SWC_FSM_EVENT_QUEUE_REF( _name ) \
+        DECLARE_SWC_FSM_CONCURRENT_REF( _name ) \
+        DECLARE_SWC_FSM_TIMER_REF( _name ) \
+        DECLARE_SWC_FSM_STATS_REF( _name ) \
+        DECLARE_SWC_FSM_HIERARCHY_REF( _name ) \
+        DECLARE_SWC_FSM_DEFER_REF( _name ) \
+        DECLARE_SWC_FSM_ROUTE_REF( _name ) \
+        DECLARE_SWC_FSM_ERROR_REF( _name ) \
     };
 
+#define DECLARE_SWC_FSM_CONTEXT( _name, _fsmID, _fsmStateList, _fsmTransTable, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit ) \
+    static SWCFsmStateItem s_fsmState##_name[] = {_fsmStateList}; \
+    static SWCFsmTransItem s_fsmTransTable##_name[] = {_fsmTransTable}; \
+    static fsm_index_t s_fsmTransOffset##_name[ sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) + 1 ]; \
+    static SWCFsmTransEdge s_fsmTransEdge##_name[ sizeof( s_fsmTransTable##_name ) / sizeof( SWCFsmTransItem ) ]; \
+    static fsm_bool_t s_fsmStateTarget##_name[ sizeof( s_fsmState##_name ) / sizeof( SWCFsmStateItem ) ]; \
+    DECLARE_SWC_FSM_CONTEXT_BODY( _name, _fsmID, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit, DEF_FSM_FALSE )
+
+// the state map and the superstate chains are still built by swcFsmInit
+#if defined( FSM_STATE_MAP ) || defined( FSM_HIERARCHY )
+#define DEF_SWC_FSM_PREBUILT_INDEX              DEF_FSM_FALSE
+#else
+#define DEF_SWC_FSM_PREBUILT_INDEX              DEF_FSM_TRUE
+#endif
+
+// context over tables with a precomputed index, as emitted by tools/fsmc
+#define DECLARE_SWC_FSM_CONTEXT_PREBUILT( _name, _fsmID, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit ) \
+    DECLARE_SWC_FSM_CONTEXT_BODY( _name, _fsmID, _fsmCommonCheck, _fsmErrorHandler, _fsmInitState, _fsmRoutineInterval, _fsmInit, _fsmRoutine, _fsmExit, DEF_SWC_FSM_PREBUILT_INDEX )
+
 #define DECLARE_SWC_FSM_CONTEXT_REF( _name ) ( &( s_fsmContext##_name ) )
 
 #define DECLARE_SWC_FSM_STATE( _state, _entry, _routine, _exit, _routineInterval ) \
@@ -89,7 +552,67 @@ typedef uint16_t                                fsm_state_t;
         .routine                = _routine, \
         .exit                   = _exit, \
         .routineInterval        = _routineInterval \
+        DECLARE_SWC_FSM_PARENT_REF( DEF_SWC_FSM_STATE_INVALID ) \
+    }
+
+#ifdef FSM_HIERARCHY
+// _state nested in _parent: rows leaving _parent apply to _state too, entering _state enters _parent first
+#define DECLARE_SWC_FSM_STATE_CHILD( _state, _parent, _entry, _routine, _exit, _routineInterval ) \
+    { \
+        .state                  = _state, \
+        .entry                  = _entry, \
+        .routine                = _routine, \
+        .exit                   = _exit, \
+        .routineInterval        = _routineInterval \
+        DECLARE_SWC_FSM_PARENT_REF( _parent ) \
+    }
+#endif
+
+#ifdef FSM_EVENT_QUEUE
+#define DECLARE_SWC_FSM_STATE_EVENT( _state, _entry, _routine, _exit, _routineInterval, _event ) \
+    { \
+        .state                  = _state, \
+        .entry                  = _entry, \
+        .routine                = _routine, \
+        .exit                   = _exit, \
+        .routineInterval        = _routineInterval, \
+        .event                  = _event \
+        DECLARE_SWC_FSM_PARENT_REF( DEF_SWC_FSM_STATE_INVALID ) \
+    }
+#endif
+
+#ifdef FSM_ROUTINE_BATCH
+// distinct state routines grouped per swcFsmRoutineBatch call
+#ifndef DEF_SWC_FSM_BATCH_BUCKETS
+#define DEF_SWC_FSM_BATCH_BUCKETS               ( 32U )
+#endif
+
+#define DECLARE_SWC_FSM_STATE_BATCH( _state, _entry, _routine, _exit, _routineInterval, _routineBatch ) \
+    { \
+        .state                  = _state, \
+        .entry                  = _entry, \
+        .routine                = _routine, \
+        .exit                   = _exit, \
+        .routineInterval        = _routineInterval, \
+        .routineBatch           = _routineBatch \
+        DECLARE_SWC_FSM_PARENT_REF( DEF_SWC_FSM_STATE_INVALID ) \
     }
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+// after _timeout ms in _state without leaving it, swcFsmWheelAdvance moves to _timeoutState
+#define DECLARE_SWC_FSM_STATE_TIMEOUT( _state, _entry, _routine, _exit, _routineInterval, _timeout, _timeoutState ) \
+    { \
+        .state                  = _state, \
+        .entry                  = _entry, \
+        .routine                = _routine, \
+        .exit                   = _exit, \
+        .routineInterval        = _routineInterval, \
+        .timeout                = _timeout, \
+        .timeoutState           = _timeoutState \
+        DECLARE_SWC_FSM_PARENT_REF( DEF_SWC_FSM_STATE_INVALID ) \
+    }
+#endif
 
 #define DECLARE_SWC_FSM_TRANSITION( _curState, _nextState, _transCheck ) \
     { \
@@ -98,11 +621,245 @@ typedef uint16_t                                fsm_state_t;
         .transCheck             = _transCheck \
     }
 
+#ifdef FSM_EVENT_TABLE
+// events of _fsmName are numbered 0 .. _eventCount - 1, the matrix holds one cell per ( state, event )
+#define DECLARE_SWC_FSM_EVENT_TABLE( _name, _fsmName, _eventCount, _eventTransTable ) \
+    static SWCFsmEventTransItem s_fsmEventTransTable##_name[] = {_eventTransTable}; \
+    static SWCFsmEventEdge s_fsmEventMatrix##_name[ ( sizeof( s_fsmState##_fsmName ) / sizeof( SWCFsmStateItem ) ) * ( _eventCount ) ]; \
+    static SWCFsmEventTable s_fsmEventTable##_name = { \
+        .fsmContext             = DECLARE_SWC_FSM_CONTEXT_REF( _fsmName ), \
+        .fsmEventTransTable     = ( s_fsmEventTransTable##_name ), \
+        .fsmEventMatrix         = ( s_fsmEventMatrix##_name ), \
+        .fsmEventTransSize      = sizeof( s_fsmEventTransTable##_name ) / sizeof( SWCFsmEventTransItem ), \
+        .fsmEventCount          = ( _eventCount ) \
+    };
+
+#define DECLARE_SWC_FSM_EVENT_TABLE_REF( _name ) ( &( s_fsmEventTable##_name ) )
+
+#define DECLARE_SWC_FSM_EVENT_TRANSITION( _curState, _event, _nextState, _transCheck ) \
+    { \
+        .curState               = _curState, \
+        .event                  = _event, \
+        .nextState              = _nextState, \
+        .transCheck             = _transCheck \
+    }
+
+#define DECLARE_SWC_FSM_EVENT_TRANSITIONS(...)  __VA_ARGS__
+#endif
+
+#ifdef FSM_DFA
+// next slot per ( state, event ) of _fsmName, filled by swcFsmDfaBuild from a bound event table
+#define DECLARE_SWC_FSM_DFA( _name, _fsmName, _eventCount ) \
+    static fsm_index_t s_fsmDfaDelta##_name[ ( sizeof( s_fsmState##_fsmName ) / sizeof( SWCFsmStateItem ) ) * ( _eventCount ) ] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ); \
+    static SWCFsmDfa s_fsmDfa##_name = { \
+        .fsmDelta               = ( s_fsmDfaDelta##_name ), \
+        .fsmCapacity            = sizeof( s_fsmDfaDelta##_name ) / sizeof( fsm_index_t ), \
+        .fsmStateSize           = 0, \
+        .fsmEventCount          = 0 \
+    };
+
+#define DECLARE_SWC_FSM_DFA_REF( _name )        ( &( s_fsmDfa##_name ) )
+#endif
+
+#ifdef FSM_INSTANCE_POOL
+// instances share the tables and callbacks of context _fsmName, only runtime state is stored per instance
+#define DECLARE_SWC_FSM_INSTANCE_POOL( _name, _fsmName, _capacity ) \
+    static fsm_state_t s_fsmPoolCurState##_name[ _capacity ]; \
+    static fsm_state_t s_fsmPoolPreState##_name[ _capacity ]; \
+    static fsm_index_t s_fsmPoolCurSlot##_name[ _capacity ]; \
+    static void* s_fsmPoolUserData##_name[ _capacity ]; \
+    static SWCFsmInstancePool s_fsmPool##_name = { \
+        .fsmDefinition          = DECLARE_SWC_FSM_CONTEXT_REF( _fsmName ), \
+        .capacity               = ( _capacity ), \
+        .curState               = ( s_fsmPoolCurState##_name ), \
+        .preState               = ( s_fsmPoolPreState##_name ), \
+        .curSlot                = ( s_fsmPoolCurSlot##_name ), \
+        .userData               = ( s_fsmPoolUserData##_name ) \
+    };
+
+// 4 bytes per instance, the slot is resolved from curState on every call
+#define DECLARE_SWC_FSM_INSTANCE_POOL_COMPACT( _name, _fsmName, _capacity ) \
+    static fsm_state_t s_fsmPoolCurState##_name[ _capacity ]; \
+    static fsm_state_t s_fsmPoolPreState##_name[ _capacity ]; \
+    static SWCFsmInstancePool s_fsmPool##_name = { \
+        .fsmDefinition          = DECLARE_SWC_FSM_CONTEXT_REF( _fsmName ), \
+        .capacity               = ( _capacity ), \
+        .curState               = ( s_fsmPoolCurState##_name ), \
+        .preState               = ( s_fsmPoolPreState##_name ), \
+        .curSlot                = NULL, \
+        .userData               = NULL \
+    };
+
+#define DECLARE_SWC_FSM_INSTANCE_POOL_REF( _name ) ( &( s_fsmPool##_name ) )
+#endif
+
+#ifdef FSM_SHARD_POOL
+// every shard starts on a page of its own, the thread pinned to it writes the page first and the kernel places it on that thread's node
+#ifndef DEF_SWC_FSM_SHARD_PAGE
+#define DEF_SWC_FSM_SHARD_PAGE                  ( 4096U )
+#endif
+// cpus the affinity mask of swcFsmShardPin can name
+#ifndef DEF_SWC_FSM_SHARD_CPUS
+#define DEF_SWC_FSM_SHARD_CPUS                  ( 1024U )
+#endif
+#define DEF_SWC_FSM_SHARD_ROUND( _bytes, _align )   ( ( ( uint64_t )( _bytes ) + ( _align ) - 1U ) & ~( ( uint64_t )( _align ) - 1U ) )
+#define DEF_SWC_FSM_SHARD_LINES( _type, _count )    DEF_SWC_FSM_SHARD_ROUND( sizeof( _type ) * ( uint64_t )( _count ), DEF_SWC_FSM_CACHE_LINE )
+// curState, preState, curSlot, userData and the free list of one shard, each array on cache lines of its own
+#define DEF_SWC_FSM_SHARD_BYTES( _shardCapacity ) \
+    DEF_SWC_FSM_SHARD_ROUND( 2U * DEF_SWC_FSM_SHARD_LINES( fsm_state_t, _shardCapacity ) + 2U * DEF_SWC_FSM_SHARD_LINES( fsm_index_t, _shardCapacity ) \
+                             + DEF_SWC_FSM_SHARD_LINES( void*, _shardCapacity ) + DEF_SWC_FSM_SHARD_LINES( uint64_t, ( ( _shardCapacity ) + 63U ) / 64U ), \
+                             DEF_SWC_FSM_SHARD_PAGE )
+
+// _shardSize shards of _shardCapacity instances, all sharing the tables and callbacks of context _fsmName
+#define DECLARE_SWC_FSM_SHARD_POOL( _name, _fsmName, _shardSize, _shardCapacity ) \
+    static uint8_t s_fsmShardArena##_name[ ( _shardSize ) * DEF_SWC_FSM_SHARD_BYTES( _shardCapacity ) ] FSM_ALIGNED( DEF_SWC_FSM_SHARD_PAGE ); \
+    static SWCFsmShard s_fsmShards##_name[ _shardSize ]; \
+    static SWCFsmShardPool s_fsmShardPool##_name = { \
+        .fsmDefinition          = DECLARE_SWC_FSM_CONTEXT_REF( _fsmName ), \
+        .shards                 = ( s_fsmShards##_name ), \
+        .shardSize              = ( _shardSize ), \
+        .shardCapacity          = ( _shardCapacity ), \
+        .arena                  = ( s_fsmShardArena##_name ), \
+        .shardBytes             = DEF_SWC_FSM_SHARD_BYTES( _shardCapacity ) \
+    };
+
+#define DECLARE_SWC_FSM_SHARD_POOL_REF( _name ) ( &( s_fsmShardPool##_name ) )
+#endif
+
+#ifdef FSM_BUILDER
+// every section of an arena starts on its own cache line
+#define DEF_SWC_FSM_BUILDER_ALIGN( _bytes )     ( ( ( uint64_t )( _bytes ) + DEF_SWC_FSM_CACHE_LINE - 1U ) & ~( ( uint64_t )DEF_SWC_FSM_CACHE_LINE - 1U ) )
+#define DEF_SWC_FSM_BUILDER_SECTION( _type, _count )    DEF_SWC_FSM_BUILDER_ALIGN( sizeof( _type ) * ( uint64_t )( _count ) )
+
+#ifdef FSM_STATE_MAP
+#define DEF_SWC_FSM_BUILDER_STATE_MAP( _stateCapacity )     DEF_SWC_FSM_BUILDER_SECTION( fsm_index_t, DEF_SWC_FSM_STATE_MAP_SIZE( ( uint64_t )( _stateCapacity ) ) )
+#else
+#define DEF_SWC_FSM_BUILDER_STATE_MAP( _stateCapacity )     ( 0U )
+#endif
+#ifdef FSM_EVENT_QUEUE
+#define DEF_SWC_FSM_BUILDER_EVENT_QUEUE                     ( DEF_SWC_FSM_BUILDER_SECTION( SWCFsmEventQueue, 1U ) + DEF_SWC_FSM_BUILDER_SECTION( SWCFsmEventCell, DEF_SWC_FSM_EVENT_QUEUE_SIZE ) )
+#else
+#define DEF_SWC_FSM_BUILDER_EVENT_QUEUE                     ( 0U )
+#endif
+#ifdef FSM_TIMER_WHEEL
+#define DEF_SWC_FSM_BUILDER_TIMER                           DEF_SWC_FSM_BUILDER_SECTION( SWCFsmTimer, DEF_SWC_FSM_TIMER_KINDS )
+#else
+#define DEF_SWC_FSM_BUILDER_TIMER                           ( 0U )
+#endif
+#ifdef FSM_STATS
+#define DEF_SWC_FSM_BUILDER_STATS( _stateCapacity, _transCapacity ) \
+    ( DEF_SWC_FSM_BUILDER_SECTION( SWCFsmStateStats, _stateCapacity ) + DEF_SWC_FSM_BUILDER_SECTION( SWCFsmTransStats, _transCapacity ) )
+#else
+#define DEF_SWC_FSM_BUILDER_STATS( _stateCapacity, _transCapacity )     ( 0U )
+#endif
+#ifdef FSM_HIERARCHY
+#define DEF_SWC_FSM_BUILDER_HIERARCHY( _stateCapacity )     DEF_SWC_FSM_BUILDER_SECTION( SWCFsmStateChain, _stateCapacity )
+#else
+#define DEF_SWC_FSM_BUILDER_HIERARCHY( _stateCapacity )     ( 0U )
+#endif
+#ifdef FSM_DEFERRED
+#define DEF_SWC_FSM_BUILDER_DEFER                           DEF_SWC_FSM_BUILDER_SECTION( SWCFsmDeferQueue, 1U )
+#else
+#define DEF_SWC_FSM_BUILDER_DEFER                           ( 0U )
+#endif
+#ifdef FSM_ROUTE
+#define DEF_SWC_FSM_BUILDER_ROUTE( _stateCapacity )         DEF_SWC_FSM_BUILDER_SECTION( fsm_index_t, ( ( uint64_t )( _stateCapacity ) + 1U ) * ( uint64_t )( _stateCapacity ) )
+#else
+#define DEF_SWC_FSM_BUILDER_ROUTE( _stateCapacity )         ( 0U )
+#endif
+#ifdef FSM_ERROR_QUEUE
+#define DEF_SWC_FSM_BUILDER_ERROR                           DEF_SWC_FSM_BUILDER_SECTION( SWCFsmErrorGate, DEF_SWC_FSM_ERROR_CODES )
+#else
+#define DEF_SWC_FSM_BUILDER_ERROR                           ( 0U )
+#endif
+
+/**
+ * bytes of an arena for up to _stateCapacity states and _transCapacity transitions: the context,
+ * the tables, the index and the storage of the enabled features, plus one line to align the base.
+ */
+#define DEF_SWC_FSM_BUILDER_ARENA_SIZE( _stateCapacity, _transCapacity ) \
+    ( ( uint64_t )DEF_SWC_FSM_CACHE_LINE + \
+      DEF_SWC_FSM_BUILDER_SECTION( SWCFsmContext, 1U ) + \
+      DEF_SWC_FSM_BUILDER_SECTION( SWCFsmStateItem, _stateCapacity ) + \
+      DEF_SWC_FSM_BUILDER_SECTION( SWCFsmTransItem, _transCapacity ) + \
+      DEF_SWC_FSM_BUILDER_SECTION( fsm_index_t, ( uint64_t )( _stateCapacity ) + 1U ) + \
+      DEF_SWC_FSM_BUILDER_SECTION( SWCFsmTransEdge, _transCapacity ) + \
+      DEF_SWC_FSM_BUILDER_SECTION( fsm_bool_t, _stateCapacity ) + \
+      DEF_SWC_FSM_BUILDER_STATE_MAP( _stateCapacity ) + \
+      DEF_SWC_FSM_BUILDER_EVENT_QUEUE + \
+      DEF_SWC_FSM_BUILDER_TIMER + \
+      DEF_SWC_FSM_BUILDER_STATS( _stateCapacity, _transCapacity ) + \
+      DEF_SWC_FSM_BUILDER_HIERARCHY( _stateCapacity ) + \
+      DEF_SWC_FSM_BUILDER_DEFER + \
+      DEF_SWC_FSM_BUILDER_ROUTE( _stateCapacity ) + \
+      DEF_SWC_FSM_BUILDER_ERROR )
+
+// static arena for the no-malloc case, any other block of DEF_SWC_FSM_BUILDER_ARENA_SIZE bytes works as well
+#define DECLARE_SWC_FSM_BUILDER_ARENA( _name, _stateCapacity, _transCapacity ) \
+    static uint8_t s_fsmBuilderArena##_name[ DEF_SWC_FSM_BUILDER_ARENA_SIZE( _stateCapacity, _transCapacity ) ] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE );
+
+#define DECLARE_SWC_FSM_BUILDER_ARENA_REF( _name )  ( s_fsmBuilderArena##_name )
+#endif
+
+#ifdef FSM_SNAPSHOT
+#define DEF_SWC_FSM_SNAPSHOT_MAGIC              ( 0x50414E53U )     // "SNAP"
+#define DEF_SWC_FSM_SNAPSHOT_VERSION            ( 1U )              // file layout, bumped on incompatible changes
+#define DEF_SWC_FSM_SNAPSHOT_ALIGN              ( 64U )             // every section starts on its own cache line
+#define DEF_SWC_FSM_SNAPSHOT_TMP_SUFFIX         ".tmp"              // a save is written next to the file, then renamed over it
+
+// bytes for the path of the temporary file, the terminating zero included
+#ifndef DEF_SWC_FSM_SNAPSHOT_PATH_SIZE
+#define DEF_SWC_FSM_SNAPSHOT_PATH_SIZE          ( 256U )
+#endif
+
+// FNV-1a 64
+#define DEF_SWC_FSM_HASH_SEED                   ( 0xCBF29CE484222325ULL )
+#define DEF_SWC_FSM_HASH_PRIME                  ( 0x00000100000001B3ULL )
+
+// registers up to _capacity contexts and pools, in the order of the file
+#define DECLARE_SWC_FSM_SNAPSHOT( _name, _capacity ) \
+    static SWCFsmSnapshotEntry s_fsmSnapshotEntry##_name[ _capacity ]; \
+    static SWCFsmSnapshot s_fsmSnapshot##_name = { \
+        .capacity               = ( _capacity ), \
+        .count                  = 0, \
+        .entries                = ( s_fsmSnapshotEntry##_name ) \
+    };
+
+#define DECLARE_SWC_FSM_SNAPSHOT_REF( _name )   ( &( s_fsmSnapshot##_name ) )
+#endif
+
+#ifdef FSM_SCHEDULER
+// round period in ms when DECLARE_SWC_FSM_SCHEDULER is given 0
+#ifndef DEF_SWC_FSM_SCHEDULER_TICK
+#define DEF_SWC_FSM_SCHEDULER_TICK              ( 10U )
+#endif
+// every worker ring is rounded up to a power of 2, twice the contexts covers the worst case
+#define DEF_SWC_FSM_SCHEDULER_SLOTS( _workerSize, _capacity )   ( 2U * ( ( _capacity ) + ( _workerSize ) ) )
+
+// _workerSize threads running the routines of at most _capacity contexts, one round every _tick ms
+#define DECLARE_SWC_FSM_SCHEDULER( _name, _workerSize, _capacity, _tick ) \
+    static SWCFsmContext* s_fsmSchedulerContexts##_name[ _capacity ]; \
+    static SWCFsmContext* s_fsmSchedulerSlots##_name[ DEF_SWC_FSM_SCHEDULER_SLOTS( _workerSize, _capacity ) ]; \
+    static SWCFsmWorker s_fsmSchedulerWorkers##_name[ _workerSize ]; \
+    static SWCFsmScheduler s_fsmScheduler##_name = { \
+        .contexts               = ( s_fsmSchedulerContexts##_name ), \
+        .contextSize            = 0, \
+        .capacity               = ( _capacity ), \
+        .workers                = ( s_fsmSchedulerWorkers##_name ), \
+        .workerSize             = ( _workerSize ), \
+        .slots                  = ( s_fsmSchedulerSlots##_name ), \
+        .tick                   = ( _tick ) \
+    };
+
+#define DECLARE_SWC_FSM_SCHEDULER_REF( _name )      ( &( s_fsmScheduler##_name ) )
+#endif
+
 #define DECLARE_SWC_FSM_STATES(...)        __VA_ARGS__
 #define DECLARE_SWC_FSM_TRANSITIONS(...)   __VA_ARGS__
 
 typedef enum {
     FSM_OK = 0,                         // 成功
+    FSM_PENDING = 1,                    // 动作未完成, FSM_ASYNC 下由 swcFsmResume 继续
     FSM_ERR_NULL_CONTEXT = -1,          // 空上下文
     FSM_ERR_INVALID_STATE = -2,         // 无效状态
     FSM_ERR_NO_TRANSITION = -3,         // 无转换路径
@@ -113,13 +870,29 @@ typedef enum {
     FSM_ERR_TOO_MANY_STATES = -8,       // 状态数超限
     FSM_ERR_ENTRY_FAILED = -9,
     FSM_ERR_EXIT_FAILED = -10,          // 退出失败
-    FSM_ERR_UNKNOWN = -11               // 未知错误
+    FSM_ERR_UNKNOWN = -11,              // 未知错误
+    FSM_ERR_QUEUE_FULL = -12,           // 事件队列已满
+    FSM_ERR_EVENT_FAILED = -13,         // 事件处理失败
+    FSM_ERR_BUSY = -14,                 // 其他线程正在转换
+    FSM_ERR_SNAPSHOT = -15,             // 快照文件无效或与状态表不符
+    FSM_ERR_NO_MEMORY = -16,            // 内存区或容量不足
+    FSM_ERR_ID_IN_USE = -17             // 上下文 ID 已被其他上下文注册
 } fsm_error_t;
 
+/**
+ * the context argument of guards, fsmInit / fsmRoutine / fsmExit and the error handler is the owner
+ * of the state: an SWCFsmContext* for a plain context, but an SWCFsmInstanceRef* for an instance of
+ * an FSM_INSTANCE_POOL or FSM_SHARD_POOL. NOT an SWCFsmContext* there, the void* lets a context's
+ * callbacks be reused on a pool unchanged, where casting it to SWCFsmContext* reads the wrong
+ * memory. callbacks shared by both must not dereference it, or tell the two apart themselves.
+ */
 typedef fsm_error_t         ( *ptrSWCFunFSMAction )( void *context );
 typedef fsm_bool_t          ( *ptrSWCFunTransferCheck )( fsm_state_t from, fsm_state_t to, void *context );
 typedef fsm_error_t         ( *ptrSWCFunTransferAction )( void *state );
 typedef void                ( *ptrSWCFsmErrorHandler )( fsm_error_t error, fsm_state_t curState, fsm_state_t nextState, void *context );
+typedef fsm_error_t         ( *ptrSWCFunEventAction )( fsm_event_t event, void *payload, void *context );
+typedef fsm_error_t         ( *ptrSWCFunBatchAction )( void **contexts, fsm_index_t count );
+typedef void                ( *ptrSWCFsmFrameRelease )( void *frame );
 
 typedef struct
 {
@@ -128,6 +901,19 @@ typedef struct
     ptrSWCFunTransferAction         routine;
     ptrSWCFunTransferAction         exit;
     uint32_t                        routineInterval;
+#ifdef FSM_EVENT_QUEUE
+    ptrSWCFunEventAction            event;          // handles events dispatched while in this state
+#endif
+#ifdef FSM_ROUTINE_BATCH
+    ptrSWCFunBatchAction            routineBatch;   // replaces routine for all contexts of a swcFsmRoutineBatch group
+#endif
+#ifdef FSM_TIMER_WHEEL
+    uint32_t                        timeout;        // ms before moving to timeoutState, 0 for none
+    fsm_state_t                     timeoutState;
+#endif
+#ifdef FSM_HIERARCHY
+    fsm_state_t                     parent;         // enclosing superstate, DEF_SWC_FSM_STATE_INVALID at the top
+#endif
 } SWCFsmStateItem;
 
 typedef struct
@@ -137,277 +923,4924 @@ typedef struct
     ptrSWCFunTransferCheck          transCheck;
 } SWCFsmTransItem;
 
-typedef struct 
+#ifdef FSM_EVENT_QUEUE
+typedef struct
 {
-    fsm_state_t                     initState;
-    fsm_state_t                     curState;
-    fsm_state_t                     preState;
-    SWCFsmStateItem*                fsmStateList;
-    SWCFsmTransItem*                fsmTransTable;
-    ptrSWCFunTransferCheck          fsmCommonCheck;
-    uint16_t                        fsmStateSize;
-    uint16_t                        fsmTransitionSize;
-    uint32_t                        fsmRoutineInterval;
-    fsm_context_id_t                fsmContextID;
-    ptrSWCFunFSMAction              fsmInit;
-    ptrSWCFunFSMAction              fsmRoutine;
-    ptrSWCFunFSMAction              fsmExit;
-    ptrSWCFsmErrorHandler           fsmErrorHandler;
-} SWCFsmContext;
+    uint32_t                        sequence;
+    fsm_event_t                     event;
+    void*                           payload;
+} SWCFsmEventCell;
+
+/**
+ * bounded MPSC ring, any thread may post, only the dispatching thread consumes.
+ * producer and consumer positions sit on their own cache lines.
+ */
+typedef struct
+{
+    uint32_t                        enqueuePos;
+    uint8_t                         padding0[ DEF_SWC_FSM_CACHE_LINE - sizeof( uint32_t ) ];
+    uint32_t                        dequeuePos;
+    uint8_t                         padding1[ DEF_SWC_FSM_CACHE_LINE - sizeof( uint32_t ) ];
+    uint32_t                        mask;
+    SWCFsmEventCell*                cells;
+} SWCFsmEventQueue;
+#endif
+
+#ifdef FSM_EVENT_TABLE
+typedef struct
+{
+    fsm_state_t                     curState;
+    fsm_event_t                     event;
+    fsm_state_t                     nextState;
+    ptrSWCFunTransferCheck          transCheck;
+} SWCFsmEventTransItem;
+
+typedef struct
+{
+    fsm_index_t                     nextSlot;
+    fsm_index_t                     transIndex;     // row in fsmEventTransTable, DEF_SWC_FSM_INDEX_INVALID when unhandled
+#ifdef FSM_HIERARCHY
+    uint8_t                         lcaLevel;       // superstates kept by the transition, see swcFsmLcaLevel
+#endif
+} SWCFsmEventEdge;
+
+typedef struct SWCFsmEventTable SWCFsmEventTable;
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+typedef struct SWCFsmTimer SWCFsmTimer;
+typedef struct SWCFsmTimerWheel SWCFsmTimerWheel;
+#endif
+
+#ifdef FSM_TRACE
+// 32 bytes, two records per cache line
+typedef struct
+{
+    uint64_t                        timestamp;          // FSM_TRACE_CLOCK when the call started
+    uint32_t                        sequence;           // claim number + 1 once complete, 0 while written
+    uint32_t                        exitTime;           // duration of the exit action
+    uint32_t                        entryTime;          // duration of the entry action, or of the whole routine
+    fsm_context_id_t                contextID;
+    fsm_state_t                     fromState;
+    fsm_state_t                     toState;
+    uint8_t                         kind;               // DEF_SWC_FSM_TRACE_TRANS or DEF_SWC_FSM_TRACE_ROUTINE
+    uint8_t                         force;
+    int16_t                         result;             // fsm_error_t
+    uint16_t                        reserved;
+} SWCFsmTraceRecord;
+
+// writers claim records with one atomic add, the oldest records are overwritten
+typedef struct
+{
+    uint32_t                        head;
+    uint8_t                         padding[ DEF_SWC_FSM_CACHE_LINE - sizeof( uint32_t ) ];
+    uint32_t                        mask;
+    SWCFsmTraceRecord*              records;
+} SWCFsmTraceRing;
+#endif
+
+#ifdef FSM_RECORD
+/**
+ * 8 bytes per request on a recorded context. no timestamp or pointer is kept, so a stream written
+ * to a file replays against the same tables in any process.
+ */
+typedef struct
+{
+    fsm_context_id_t                contextID;
+    fsm_state_t                     state;              // requested state, the event with DEF_SWC_FSM_RECORD_EVENT
+    fsm_state_t                     nextState;          // curState after the request
+    uint8_t                         flags;              // DEF_SWC_FSM_RECORD_*
+    int8_t                          error;              // fsm_error_t of the request
+} SWCFsmRecord;
+
+// writers claim records with one atomic add, records[ 0, head ) are complete once the writers are done
+typedef struct
+{
+    uint32_t                        head;
+    uint32_t                        dropped;            // requests that found the recorder full
+    uint32_t                        capacity;
+    SWCFsmRecord*                   records;
+} SWCFsmRecorder;
+#endif
+
+#ifdef FSM_STATS
+typedef struct
+{
+    uint64_t                        count;
+    uint64_t                        total;              // ns
+    uint32_t                        histogram[ DEF_SWC_FSM_STATS_BUCKETS ];
+} SWCFsmLatency;
+
+// parallel to fsmStateList, indexed by slot
+typedef struct
+{
+    SWCFsmLatency                   action[ DEF_SWC_FSM_ACTION_COUNT ];    // entry, exit, routine
+} SWCFsmStateStats;
+
+// parallel to fsmTransTable, forced transitions are not counted
+typedef struct
+{
+    uint64_t                        attempts;
+    uint64_t                        rejected;           // FSM_ERR_CHECK_FAILED
+    uint64_t                        succeeded;
+    SWCFsmLatency                   check;              // fsmCommonCheck and transCheck together
+} SWCFsmTransStats;
+#endif
+
+// outgoing edge of the transition index, rows are grouped by the slot of curState
+typedef struct
+{
+    fsm_state_t                     nextState;
+#ifdef FSM_HIERARCHY
+    uint8_t                         lcaLevel;       // superstates kept by the transition, see swcFsmLcaLevel
+#endif
+    fsm_index_t                     nextSlot;       // slot of nextState in fsmStateList
+    fsm_index_t                     transIndex;     // row in fsmTransTable
+} SWCFsmTransEdge;
+
+#ifdef FSM_HIERARCHY
+// slots[ 0 ] is the state itself, slots[ depth ] its outermost superstate
+typedef struct
+{
+    fsm_index_t                     depth;
+    fsm_index_t                     slots[ DEF_SWC_FSM_HIERARCHY_DEPTH ];
+} SWCFsmStateChain;
+#endif
+
+#ifdef FSM_ASYNC
+// what an entry or exit action keeps between the calls of one pending transition, e.g. a coroutine frame
+typedef struct
+{
+    void*                           frame;              // NULL while the action keeps nothing
+    ptrSWCFsmFrameRelease           release;            // frees frame when the transition is dropped
+} SWCFsmActionFrame;
+
+/**
+ * the transition a context is in the middle of while one of its actions is pending. curState stays
+ * the source state until the last entry action has completed.
+ */
+typedef struct
+{
+    fsm_state_t                     state;              // target
+    uint8_t                         phase;              // DEF_SWC_FSM_PENDING_*
+    fsm_index_t                     nextSlot;
+    fsm_index_t                     lcaLevel;
+    fsm_index_t                     done;               // actions of the current path that have completed
+    SWCFsmActionFrame               frame;              // of the pending action, owned by the context
+} SWCFsmPending;
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+typedef struct SWCFsmErrorRecord SWCFsmErrorRecord;
+
+/**
+ * bounded MPSC ring of error records, as SWCFsmEventQueue: any thread posts, the draining thread
+ * consumes. a zero filled ring is ready without init.
+ */
+typedef struct
+{
+    uint32_t                        enqueuePos;
+    uint8_t                         padding0[ DEF_SWC_FSM_CACHE_LINE - sizeof( uint32_t ) ];
+    uint32_t                        dequeuePos;
+    uint8_t                         padding1[ DEF_SWC_FSM_CACHE_LINE - sizeof( uint32_t ) ];
+    uint32_t                        mask;
+    uint32_t                        interval;           // ms between two records of one context and code
+    uint32_t                        dropped;            // records that found the ring full, their occurrences go with the next record
+    SWCFsmErrorRecord*              records;
+} SWCFsmErrorQueue;
+
+/**
+ * per context and error code. count gathers the occurrences until a drained record takes them,
+ * queued is set while a record of the code waits in the ring, due holds back the next one.
+ */
+typedef struct
+{
+    uint32_t                        count;
+    uint32_t                        queued;
+    uint64_t                        due;                // FSM_ERROR_CLOCK ms
+} SWCFsmErrorGate;
+#endif
+
+#ifdef FSM_DEFERRED
+typedef struct
+{
+    fsm_state_t                     state;
+    fsm_bool_t                      bForce;
+} SWCFsmDeferCell;
+
+/**
+ * transitions requested by actions, owned by the thread driving the context. depth counts the
+ * running swcFsmTransTo, swcFsmRoutine, swcFsmHandleEvent and dispatched event calls, the
+ * outermost one applies the requests in order once its actions have returned.
+ */
+typedef struct
+{
+    uint32_t                        head;
+    uint32_t                        tail;
+    uint32_t                        depth;
+    SWCFsmDeferCell                 cells[ DEF_SWC_FSM_DEFER_SIZE ];
+} SWCFsmDeferQueue;
+#endif
+
+typedef struct 
+{
+    fsm_state_t                     initState;
+    fsm_state_t                     curState;
+    fsm_state_t                     preState;
+    fsm_index_t                     curSlot;            // slot of curState in fsmStateList
+    SWCFsmStateItem*                fsmStateList;
+    SWCFsmTransItem*                fsmTransTable;
+    fsm_index_t*                    fsmTransOffset;     // CSR row offsets, fsmStateSize + 1 entries, may be NULL
+    SWCFsmTransEdge*                fsmTransEdge;       // CSR edges, fsmTransitionSize entries, may be NULL
+    fsm_bool_t*                     fsmStateTarget;     // some row leads to the slot, fsmStateSize entries, may be NULL
+#ifdef FSM_STATE_MAP
+    fsm_index_t*                    fsmStateMap;        // state id to slot, direct table or open addressing hash
+    fsm_index_t                     fsmStateMapSize;
+    uint32_t                        fsmStateMapSeed;    // hash multiplier, hash mode only
+    fsm_state_t                     fsmStateMapBase;    // lowest state id, direct mode only
+    uint8_t                         fsmStateMapMode;
+#endif
+    ptrSWCFunTransferCheck          fsmCommonCheck;
+    fsm_index_t                     fsmStateSize;
+    fsm_index_t                     fsmTransitionSize;
+    fsm_bool_t                      fsmIndexReady;
+    uint32_t                        fsmRoutineInterval;
+    fsm_context_id_t                fsmContextID;
+    ptrSWCFunFSMAction              fsmInit;
+    ptrSWCFunFSMAction              fsmRoutine;
+    ptrSWCFunFSMAction              fsmExit;
+    ptrSWCFsmErrorHandler           fsmErrorHandler;
+#ifdef FSM_EVENT_QUEUE
+    SWCFsmEventQueue*               fsmEventQueue;
+#endif
+#ifdef FSM_EVENT_TABLE
+    SWCFsmEventTable*               fsmEventTable;      // set by swcFsmBindEventTable
+#endif
+#ifdef FSM_CONCURRENT
+    uint64_t                        fsmStateWord;       // committed ( curState, preState, sequence ), see DEF_SWC_FSM_WORD_PACK
+#endif
+#ifdef FSM_TIMER_WHEEL
+    SWCFsmTimer*                    fsmTimers;          // DEF_SWC_FSM_TIMER_KINDS entries
+    SWCFsmTimerWheel*               fsmTimerWheel;      // set by swcFsmWheelAdd
+#endif
+#ifdef FSM_TRACE
+    SWCFsmTraceRing*                fsmTrace;           // set by swcFsmTraceAttach, NULL when not traced
+    uint32_t                        fsmTraceExit;       // action durations of the transition being traced
+    uint32_t                        fsmTraceEntry;
+#endif
+#ifdef FSM_STATS
+    SWCFsmStateStats*               fsmStateStats;      // fsmStateSize entries, NULL when not kept
+    SWCFsmTransStats*               fsmTransStats;      // fsmTransitionSize entries
+#endif
+#ifdef FSM_HIERARCHY
+    SWCFsmStateChain*               fsmStateChain;      // fsmStateSize entries, built by swcFsmBuildIndex, NULL for flat states
+#endif
+#ifdef FSM_DEFERRED
+    SWCFsmDeferQueue*               fsmDeferQueue;      // NULL to take requests at once
+#endif
+#ifdef FSM_ASYNC
+    SWCFsmPending                   fsmPending;         // phase DEF_SWC_FSM_PENDING_NONE unless an action is pending
+#endif
+#ifdef FSM_ROUTE
+    fsm_index_t*                    fsmRouteNext;       // ( fsmStateSize + 1 ) * fsmStateSize entries, built by swcFsmBuildIndex, NULL without routes
+#endif
+#ifdef FSM_RECORD
+    SWCFsmRecorder*                 fsmRecorder;        // set by swcFsmRecordAttach, NULL when not recorded
+#endif
+#ifdef FSM_ERROR_QUEUE
+    SWCFsmErrorQueue*               fsmErrorQueue;      // set by swcFsmErrorQueueAttach, NULL to call fsmErrorHandler at once
+    SWCFsmErrorGate*                fsmErrorGates;      // DEF_SWC_FSM_ERROR_CODES entries
+#endif
+} SWCFsmContext;
+
+#ifdef FSM_TIMER_WHEEL
+struct SWCFsmTimer
+{
+    SWCFsmTimer*                    next;
+    SWCFsmTimer**                   pprev;              // NULL while not armed
+    uint64_t                        expire;             // ms on the wheel clock
+    SWCFsmContext*                  context;
+    uint32_t                        kind;
+    uint32_t                        slot;               // level * DEF_SWC_FSM_WHEEL_SLOTS + slot while armed
+};
+
+// driven by one thread, together with every transition of the contexts on it
+struct SWCFsmTimerWheel
+{
+    uint64_t                        now;                // ms advanced so far
+    uint64_t                        occupied[ DEF_SWC_FSM_WHEEL_LEVELS ];     // one bit per non empty slot
+    SWCFsmTimer*                    slots[ DEF_SWC_FSM_WHEEL_LEVELS * DEF_SWC_FSM_WHEEL_SLOTS ];
+    fsm_index_t                     armed;
+};
+#endif
+
+#ifdef FSM_EVENT_TABLE
+struct SWCFsmEventTable
+{
+    SWCFsmContext*                  fsmContext;
+    SWCFsmEventTransItem*           fsmEventTransTable;
+    SWCFsmEventEdge*                fsmEventMatrix;     // fsmStateSize * fsmEventCount cells, row major by slot
+    fsm_index_t                     fsmEventTransSize;
+    fsm_event_t                     fsmEventCount;
+};
+#endif
+
+#ifdef FSM_DFA
+/**
+ * an event table without guards or actions reduced to ( slot, event ) -> slot. instances are plain
+ * slots, so stepping one is a single load and many can share one gather.
+ */
+typedef struct
+{
+    fsm_index_t*                    fsmDelta;           // fsmStateSize * fsmEventCount next slots, DEF_SWC_FSM_INDEX_INVALID when undefined
+    fsm_index_t                     fsmCapacity;
+    fsm_index_t                     fsmStateSize;
+    fsm_index_t                     fsmEventCount;
+} SWCFsmDfa;
+#endif
+
+#ifdef FSM_INSTANCE_POOL
+// structure of arrays, one entry per instance, curSlot and userData may be NULL
+typedef struct
+{
+    SWCFsmContext*                  fsmDefinition;      // shared tables and callbacks, its own curState is unused
+    fsm_index_t                     capacity;
+    fsm_state_t*                    curState;
+    fsm_state_t*                    preState;
+    fsm_index_t*                    curSlot;
+    void**                          userData;
+} SWCFsmInstancePool;
+
+// handed to fsmCommonCheck/transCheck/fsmInit/fsmRoutine/fsmExit/fsmErrorHandler as context for pooled instances
+typedef struct
+{
+    SWCFsmInstancePool*             pool;
+    fsm_index_t                     instance;
+} SWCFsmInstanceRef;
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+// 24 bytes, 40 with FSM_INSTANCE_POOL, the error of the first occurrence and the number of occurrences it stands for
+struct SWCFsmErrorRecord
+{
+    uint32_t                        sequence;           // lap marker of the ring
+    uint32_t                        count;              // occurrences, filled in by swcFsmErrorDrain
+    SWCFsmContext*                  context;            // the definition for a pooled instance
+#ifdef FSM_INSTANCE_POOL
+    SWCFsmInstancePool*             pool;               // of the pooled instance, NULL for the context itself
+    fsm_index_t                     instance;           // in pool
+#endif
+    fsm_state_t                     curState;
+    fsm_state_t                     nextState;
+    int16_t                         error;              // fsm_error_t
+};
+#endif
+
+#ifdef FSM_SHARD_POOL
+/**
+ * instances owned by one thread. the hot arrays live in the shard's pages of the arena, the
+ * descriptor fills whole cache lines so the alloc / free of one owner never bounces another's.
+ */
+typedef struct
+{
+    SWCFsmInstancePool              pool FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE );
+    fsm_index_t*                    freeList;
+    uint64_t*                       freeBits;           // one bit per instance, set while it is on the free list
+    fsm_index_t                     freeCount;          // written by the owner only
+    int32_t                         cpu;                // -1 until pinned
+    int32_t                         node;               // NUMA node of cpu, -1 when unknown
+} SWCFsmShard;
+
+// the cold tables and callbacks of fsmDefinition are shared read only by every shard
+typedef struct
+{
+    SWCFsmContext*                  fsmDefinition;
+    SWCFsmShard*                    shards;
+    fsm_index_t                     shardSize;
+    fsm_index_t                     shardCapacity;      // instances per shard
+    uint8_t*                        arena;              // shardSize * shardBytes, page aligned
+    uint64_t                        shardBytes;         // DEF_SWC_FSM_SHARD_BYTES( shardCapacity )
+} SWCFsmShardPool;
+#endif
+
+#ifdef FSM_REGISTRY
+/**
+ * contexts by fsmContextID, a lookup is one load. readers never lock, a context is published with
+ * a release store and found with an acquire load. the occupied bits let swcFsmRegistryForEach
+ * skip free IDs a word at a time.
+ */
+typedef struct
+{
+    SWCFsmContext**                 contexts;           // DEF_SWC_FSM_REGISTRY_SIZE entries, NULL where free
+    uint64_t*                       occupied;           // one bit per registered ID
+    uint32_t                        count;              // registered contexts
+} SWCFsmRegistry;
+
+// called for every registered context by swcFsmRegistryForEach, DEF_FSM_FALSE stops the walk
+typedef fsm_bool_t          ( *ptrSWCFsmRegistryVisit )( SWCFsmContext* context, void* arg );
+#endif
+
+#ifdef FSM_RECORD
+// replayed state of one recorded context, states are indexed by fsmContextID
+typedef struct
+{
+    SWCFsmContext*                  context;            // tables replayed against, only read
+    fsm_state_t                     curState;
+    fsm_index_t                     curSlot;
+    uint32_t                        records;            // records replayed
+    uint32_t                        mismatches;         // records the tables did not reproduce
+} SWCFsmReplayState;
+#endif
+
+#ifdef FSM_BUILDER
+/**
+ * cursor over a caller arena holding one definition: the context on the first aligned line, then
+ * the state list, the transition table, the index and the feature storage, each on its own line.
+ * nothing points outside the arena, dropping the block after swcFsmExit drops the whole context.
+ */
+typedef struct
+{
+    uint8_t*                        arena;              // aligned base
+    uint64_t                        arenaSize;          // bytes from the aligned base on
+    uint64_t                        used;
+    SWCFsmContext*                  context;            // NULL until swcFsmBuilderInit succeeds
+    fsm_index_t                     stateCapacity;
+    fsm_index_t                     transCapacity;
+} SWCFsmBuilder;
+#endif
+
+#ifdef FSM_SNAPSHOT
+/**
+ * start of a snapshot file, followed by one section per registered entry. section offsets follow
+ * from the registered entries alone, so a restore that agrees on tableHash and size copies every
+ * section straight out of the mapping. magic is written last, a torn file never validates.
+ */
+typedef struct
+{
+    uint32_t                        magic;
+    uint32_t                        version;
+    uint64_t                        tableHash;          // tables, pool layouts and blob sizes of all entries
+    uint64_t                        size;               // bytes of the whole file
+    uint32_t                        count;              // entries
+    uint32_t                        reserved;
+} SWCFsmSnapshotHeader;
+
+// section of a context
+typedef struct
+{
+    fsm_state_t                     curState;
+    fsm_state_t                     preState;
+    fsm_index_t                     curSlot;
+} SWCFsmSnapshotState;
+
+// a context or a pool with an optional user blob saved and restored with it
+typedef struct
+{
+    SWCFsmContext*                  context;            // NULL for a pool
+#ifdef FSM_INSTANCE_POOL
+    SWCFsmInstancePool*             pool;
+#endif
+    void*                           blob;
+    uint64_t                        blobSize;
+} SWCFsmSnapshotEntry;
+
+typedef struct
+{
+    fsm_index_t                     capacity;
+    fsm_index_t                     count;
+    SWCFsmSnapshotEntry*            entries;
+} SWCFsmSnapshot;
+#endif
+
+#ifdef FSM_SCHEDULER
+typedef struct SWCFsmScheduler SWCFsmScheduler;
+
+/**
+ * Chase-Lev deque of one worker, the owner pushes and pops at bottom, idle workers steal at top.
+ * the ring never wraps within a round, a worker pushes at most its share of the contexts.
+ */
+typedef struct
+{
+    int64_t                         top;
+    uint8_t                         padding0[ DEF_SWC_FSM_CACHE_LINE - sizeof( int64_t ) ];
+    int64_t                         bottom;
+    uint8_t                         padding1[ DEF_SWC_FSM_CACHE_LINE - sizeof( int64_t ) ];
+    int64_t                         mask;
+    SWCFsmContext**                 tasks;
+    SWCFsmScheduler*                scheduler;
+    fsm_index_t                     id;
+    pthread_t                       thread;
+} SWCFsmWorker;
+
+struct SWCFsmScheduler
+{
+    SWCFsmContext**                 contexts;
+    fsm_index_t                     contextSize;
+    fsm_index_t                     capacity;
+    SWCFsmWorker*                   workers;
+    fsm_index_t                     workerSize;
+    SWCFsmContext**                 slots;              // deque storage, DEF_SWC_FSM_SCHEDULER_SLOTS entries
+    uint32_t                        tick;               // ms per round
+    uint64_t                        round;
+    fsm_index_t                     active;             // workers still inside the current round
+    fsm_bool_t                      running;
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  wake;               // round opened, round finished or stopping
+};
+#endif
 
 #ifdef FSM_STATE_FF
-#define swcFsmGetStateItem( state, context )        ( ( context && ( ( state ) != DEF_SWC_FSM_STATE_INVALID ) ) ? ( & ( context->fsmStateList[ state ] ) ) : NULL )
-#define swcFsmGetCurStateItem( context )            ( context ? swcFsmGetStateItem( context->curState, context ) : NULL )
+#define swcFsmGetStateSlot( state, context )        ( ( ( state ) != DEF_SWC_FSM_STATE_INVALID ) ? ( fsm_index_t )( state ) : DEF_SWC_FSM_INDEX_INVALID )
+#define swcFsmGetStateItem( state, context )        ( ( ( context ) && ( ( state ) != DEF_SWC_FSM_STATE_INVALID ) ) ? ( & ( ( context )->fsmStateList[ state ] ) ) : NULL )
+#define swcFsmGetCurStateItem( context )            ( ( context ) ? swcFsmGetStateItem( ( context )->curState, ( context ) ) : NULL )
 #else
+#ifdef FSM_STATE_MAP
+FSM_INLINE
+fsm_index_t swcFsmStateMapHash( fsm_state_t state, uint32_t seed, fsm_index_t size )
+{
+    // multiplicative hash scaled to [0, size) without a division
+    return ( fsm_index_t )( ( ( uint64_t )( ( uint32_t )state * seed ) * size ) >> 32 );
+}
+#endif
+
+FSM_FUNC
+fsm_index_t swcFsmGetStateSlot( fsm_state_t state, SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+#ifdef FSM_STATE_MAP
+    fsm_index_t probe = 0;
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+#endif
+
+    UNUSED( index );
+
+    if ( !context || state == DEF_SWC_FSM_STATE_INVALID )     return DEF_SWC_FSM_INDEX_INVALID;
+
+#ifdef FSM_STATE_MAP
+    if ( context->fsmStateMapMode == DEF_SWC_FSM_STATE_MAP_DIRECT ) {
+        index = ( fsm_index_t )state - ( fsm_index_t )( context->fsmStateMapBase );
+        return ( index < context->fsmStateMapSize ) ? context->fsmStateMap[ index ] : DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    if ( context->fsmStateMapMode == DEF_SWC_FSM_STATE_MAP_HASH ) {
+        index = swcFsmStateMapHash( state, context->fsmStateMapSeed, context->fsmStateMapSize );
+        for ( probe = 0; probe < context->fsmStateMapSize; ++probe ) {
+            slot = context->fsmStateMap[ index ];
+            if ( ( slot == DEF_SWC_FSM_INDEX_INVALID ) || ( context->fsmStateList[ slot ].state == state ) ) {
+                return slot;
+            }
+            if ( ++index == context->fsmStateMapSize )     index = 0;
+        }
+
+        return DEF_SWC_FSM_INDEX_INVALID;
+    }
+#endif
+
+    for ( index = 0; index < context->fsmStateSize; ++index ) {
+        if ( context->fsmStateList[ index ].state == state ) {
+            return index;
+        }
+    }
+
+    return DEF_SWC_FSM_INDEX_INVALID;
+}
+
+FSM_FUNC
+SWCFsmStateItem* swcFsmGetStateItem( fsm_state_t state, SWCFsmContext* context )
+{
+    fsm_index_t slot = swcFsmGetStateSlot( state, context );
+
+    if ( slot == DEF_SWC_FSM_INDEX_INVALID )     return NULL;
+
+    return &( context->fsmStateList[ slot ] );
+}
+
+FSM_GETTER
+SWCFsmStateItem* swcFsmGetCurStateItem( SWCFsmContext* context )
+{
+    if ( !context )     return NULL;
+
+    // curSlot is kept in step with curState by swcFsmInit/swcFsmTransTo
+    if ( context->curSlot < context->fsmStateSize ) {
+        return &( context->fsmStateList[ context->curSlot ] );
+    }
+
+    return swcFsmGetStateItem( context->curState, context );
+}
+#endif
+
+#ifdef FSM_REGISTRY
+// context registered under id, NULL when none, safe while other threads register and unregister
+FSM_INLINE
+SWCFsmContext* swcFsmRegistryFind( fsm_context_id_t id, SWCFsmRegistry* registry )
+{
+#if DEF_SWC_FSM_REGISTRY_SIZE < 65536U
+    if ( id >= DEF_SWC_FSM_REGISTRY_SIZE )      return NULL;
+#endif
+
+    return FSM_ATOMIC_LOAD( &( registry->contexts[ id ] ) );
+}
+#endif
+
+#if defined( FSM_SCHEDULER ) || defined( FSM_TRACE ) || defined( FSM_STATS ) || defined( FSM_ERROR_QUEUE )
+FSM_INLINE
+uint64_t swcFsmClockNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t )now.tv_sec * 1000000000ULL + ( uint64_t )now.tv_nsec;
+}
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+/**
+ * count one error of context and post a record for it, unless one of the same code is still queued
+ * or the last one went out less than interval ms ago. the occurrences held back go with the next
+ * record of the code. lock-free, no I/O and no handler call. owner is context, or the
+ * SWCFsmInstanceRef of a pooled instance, which shares the gates of its definition.
+ */
+FSM_INLINE
+void swcFsmErrorPost( fsm_error_t error, fsm_state_t curState, fsm_state_t nextState, void* owner, SWCFsmContext* context )
+{
+    SWCFsmErrorQueue* queue = context->fsmErrorQueue;
+    SWCFsmErrorGate* gate = &( context->fsmErrorGates[ DEF_SWC_FSM_ERROR_GATE( error ) ] );
+    SWCFsmErrorRecord* record = NULL;
+    uint32_t expected = 0;
+    uint32_t pos = 0;
+    int32_t diff = 0;
+    uint64_t now = 0;
+
+    FSM_ATOMIC_FETCH_ADD( &( gate->count ), 1U );
+    if ( FSM_ATOMIC_LOAD_RELAXED( &( gate->queued ) ) )     return;
+
+    now = FSM_ERROR_CLOCK();
+    if ( now < FSM_ATOMIC_LOAD_RELAXED( &( gate->due ) ) )  return;
+    if ( !FSM_ATOMIC_CAS( &( gate->queued ), &expected, 1U ) )  return;
+    FSM_ATOMIC_STORE_RELAXED( &( gate->due ), now + queue->interval );
+
+    pos = FSM_ATOMIC_LOAD_RELAXED( &( queue->enqueuePos ) );
+    for ( ;; ) {
+        record = &( queue->records[ pos & queue->mask ] );
+        diff = ( int32_t )( FSM_ATOMIC_LOAD( &( record->sequence ) ) - ( pos & ~( queue->mask ) ) );
+
+        if ( diff == 0 ) {
+            if ( FSM_ATOMIC_CAS( &( queue->enqueuePos ), &pos, pos + 1U ) )  break;
+        } else if ( diff < 0 ) {
+            // full, the gate opens again and the count waits for the next record
+            FSM_ATOMIC_FETCH_ADD( &( queue->dropped ), 1U );
+            FSM_ATOMIC_STORE( &( gate->queued ), 0U );
+            return;
+        } else {
+            pos = FSM_ATOMIC_LOAD_RELAXED( &( queue->enqueuePos ) );
+        }
+    }
+
+    record->context     = context;
+#ifdef FSM_INSTANCE_POOL
+    record->pool        = ( owner != ( void* )context ) ? ( ( SWCFsmInstanceRef* )owner )->pool : NULL;
+    record->instance    = ( owner != ( void* )context ) ? ( ( SWCFsmInstanceRef* )owner )->instance : DEF_SWC_FSM_INDEX_INVALID;
+#else
+    UNUSED( owner );
+#endif
+    record->curState    = curState;
+    record->nextState   = nextState;
+    record->error       = ( int16_t )error;
+    record->count       = 0;
+    FSM_ATOMIC_STORE( &( record->sequence ), ( pos & ~( queue->mask ) ) + 1U );
+}
+#endif
+
+#ifdef FSM_DEBUG
+    // define console output here
+    #include <stdio.h>
+    #define FSM_ERROR_PRINT(error, curState, nextState) \
+            fprintf( stderr, "[%s:%d]FSM Error %d: Current=%u, Next=%u\n", __FILE__, __LINE__, error, curState, nextState )
+#else
+    #define FSM_ERROR_PRINT(error, curState, nextState)
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+    // errors of a context with a queue attached, and of the instances pooled on it, are posted, fsmErrorHandler runs in swcFsmErrorDrain
+    #define FSM_ERROR_REPORT(context, owner, error, curState, nextState) \
+        do { \
+            /* read before owner is compared, the states may be read through context */ \
+            fsm_state_t fsmErrorCur = ( curState ); \
+            fsm_state_t fsmErrorNext = ( nextState ); \
+            if ( context && context->fsmErrorQueue ) { \
+                swcFsmErrorPost( error, fsmErrorCur, fsmErrorNext, owner, context ); \
+            } else { \
+                if ( context && context->fsmErrorHandler ) { \
+                    context->fsmErrorHandler(error, fsmErrorCur, fsmErrorNext, owner); \
+                } \
+                FSM_ERROR_PRINT( error, fsmErrorCur, fsmErrorNext ); \
+            } \
+        } while (0)
+#else
+    #define FSM_ERROR_REPORT(context, owner, error, curState, nextState) \
+        do { \
+            if ( context && context->fsmErrorHandler ) { \
+                context->fsmErrorHandler(error, curState, nextState, owner); \
+            } \
+            FSM_ERROR_PRINT( error, curState, nextState ); \
+        } while (0)
+#endif
+
+#define FSM_ERROR_HANDLER(context, error, curState, nextState)  FSM_ERROR_REPORT(context, context, error, curState, nextState)
+
+#ifdef FSM_IMPLEMENTATION
+#define FSM_NO_IMPL
+#endif
+
+#ifndef FSM_NO_IMPL
+FSM_GETTER
+fsm_state_t swcFsmGetCurState( SWCFsmContext* context )
+{
+    if ( !context )     return DEF_SWC_FSM_STATE_INVALID;
+
+#ifdef FSM_CONCURRENT
+    return DEF_SWC_FSM_WORD_CUR( FSM_ATOMIC_LOAD( &( context->fsmStateWord ) ) );
+#else
+    return context->curState;
+#endif
+}
+
+FSM_GETTER
+fsm_state_t swcFsmGetPreState( SWCFsmContext* context )
+{
+    if ( !context )     return DEF_SWC_FSM_STATE_INVALID;
+
+#ifdef FSM_CONCURRENT
+    return DEF_SWC_FSM_WORD_PRE( FSM_ATOMIC_LOAD( &( context->fsmStateWord ) ) );
+#else
+    return context->preState;
+#endif
+}
+
+#ifdef FSM_CONCURRENT
+/**
+ * lock-free read of the last committed state. sequence is odd while a transition is running, two
+ * reads with the same even sequence saw the same state, seqlock style.
+ * returns DEF_FSM_FALSE when a transition is in flight.
+ */
+FSM_GETTER
+fsm_bool_t swcFsmReadState( fsm_state_t* curState, fsm_state_t* preState, uint32_t* sequence, SWCFsmContext* context )
+{
+    uint64_t word = 0;
+
+    if ( !context )     return DEF_FSM_FALSE;
+
+    word = FSM_ATOMIC_LOAD( &( context->fsmStateWord ) );
+    if ( curState )     *curState = DEF_SWC_FSM_WORD_CUR( word );
+    if ( preState )     *preState = DEF_SWC_FSM_WORD_PRE( word );
+    if ( sequence )     *sequence = DEF_SWC_FSM_WORD_SEQ( word );
+
+    return ( DEF_SWC_FSM_WORD_SEQ( word ) & 1U ) ? DEF_FSM_FALSE : DEF_FSM_TRUE;
+}
+
+/**
+ * claim the context for one transition by moving the sequence to odd with a CAS. a caller that finds
+ * a transition in flight or loses the CAS gets FSM_ERR_BUSY and must not touch the state. losing is
+ * ordinary contention, not an error, so nothing is reported here.
+ */
+FSM_INLINE
+fsm_error_t swcFsmClaim( uint64_t* word, SWCFsmContext* context )
+{
+    *word = FSM_ATOMIC_LOAD( &( context->fsmStateWord ) );
+
+    if ( ( DEF_SWC_FSM_WORD_SEQ( *word ) & 1U ) || \
+        !FSM_ATOMIC_CAS( &( context->fsmStateWord ), word, *word + DEF_SWC_FSM_WORD_PACK( 0U, 0U, 1U ) ) ) {
+        return FSM_ERR_BUSY;
+    }
+
+    return FSM_OK;
+}
+
+// publish the state left by the owner, the sequence becomes even again
+FSM_INLINE
+void swcFsmRelease( uint64_t word, SWCFsmContext* context )
+{
+    FSM_ATOMIC_STORE( &( context->fsmStateWord ), DEF_SWC_FSM_WORD_PACK( context->curState, context->preState, DEF_SWC_FSM_WORD_SEQ( word ) + 2U ) );
+}
+#endif
+
+// seed the word from curState and preState, a context set up by hand starts with a zeroed one
+FSM_INLINE
+void swcFsmSeedWord( SWCFsmContext* context )
+{
+#ifdef FSM_CONCURRENT
+    FSM_ATOMIC_STORE( &( context->fsmStateWord ), DEF_SWC_FSM_WORD_PACK( context->curState, context->preState, DEF_SWC_FSM_WORD_SEQ( context->fsmStateWord ) & ~1U ) );
+#else
+    UNUSED( context );
+#endif
+}
+
+FSM_INLINE
+SWCFsmStateItem* swcFsmGetSlotItem( fsm_index_t slot, SWCFsmContext* context )
+{
+    if ( !context || ( slot >= context->fsmStateSize ) )    return NULL;
+
+    return &( context->fsmStateList[ slot ] );
+}
+
+#ifdef FSM_STATE_MAP
+/**
+ * build the state id to slot map: a direct table when the id range fits in fsmStateMapSize,
+ * otherwise an open addressing hash, trying a few multipliers for a collision free layout.
+ * the first slot of a duplicated id wins, same as the linear scan.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBuildStateMap( SWCFsmContext* context )
+{
+    static const uint32_t s_seeds[] = { 0x9E3779B1U, 0x85EBCA77U, 0xC2B2AE3DU, 0x27D4EB2FU, 0x165667B1U };
+    fsm_index_t index = 0;
+    fsm_index_t pos = 0;
+    fsm_index_t collision = 0;
+    uint32_t seedIndex = 0;
+    fsm_state_t minState = DEF_SWC_FSM_STATE_INVALID;
+    fsm_state_t maxState = 0;
+    fsm_state_t state = DEF_SWC_FSM_STATE_INVALID;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context->fsmStateMapMode = DEF_SWC_FSM_STATE_MAP_NONE;
+
+    if ( !( context->fsmStateMap ) || ( context->fsmStateMapSize < context->fsmStateSize ) || ( context->fsmStateSize == 0 ) )   return FSM_OK;
+
+    for ( index = 0; index < context->fsmStateSize; ++index ) {
+        state = context->fsmStateList[ index ].state;
+        if ( state < minState )     minState = state;
+        if ( state > maxState )     maxState = state;
+    }
+
+    for ( pos = 0; pos < context->fsmStateMapSize; ++pos ) {
+        context->fsmStateMap[ pos ] = DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    if ( ( fsm_index_t )( maxState - minState ) < context->fsmStateMapSize ) {
+        for ( index = 0; index < context->fsmStateSize; ++index ) {
+            pos = ( fsm_index_t )( context->fsmStateList[ index ].state - minState );
+            if ( context->fsmStateMap[ pos ] == DEF_SWC_FSM_INDEX_INVALID ) {
+                context->fsmStateMap[ pos ] = index;
+            }
+        }
+
+        context->fsmStateMapBase = minState;
+        context->fsmStateMapMode = DEF_SWC_FSM_STATE_MAP_DIRECT;
+        return FSM_OK;
+    }
+
+    for ( seedIndex = 0; seedIndex < sizeof( s_seeds ) / sizeof( s_seeds[ 0 ] ); ++seedIndex ) {
+        if ( seedIndex > 0 ) {
+            for ( pos = 0; pos < context->fsmStateMapSize; ++pos ) {
+                context->fsmStateMap[ pos ] = DEF_SWC_FSM_INDEX_INVALID;
+            }
+        }
+
+        collision = 0;
+        for ( index = 0; index < context->fsmStateSize; ++index ) {
+            state = context->fsmStateList[ index ].state;
+            pos = swcFsmStateMapHash( state, s_seeds[ seedIndex ], context->fsmStateMapSize );
+            while ( ( context->fsmStateMap[ pos ] != DEF_SWC_FSM_INDEX_INVALID ) && ( context->fsmStateList[ context->fsmStateMap[ pos ] ].state != state ) ) {
+                ++collision;
+                if ( ++pos == context->fsmStateMapSize )     pos = 0;
+            }
+            if ( context->fsmStateMap[ pos ] == DEF_SWC_FSM_INDEX_INVALID ) {
+                context->fsmStateMap[ pos ] = index;
+            }
+        }
+
+        // keep the last layout if none is perfect, lookup probes past collisions anyway
+        if ( collision == 0 )   break;
+    }
+
+    context->fsmStateMapSeed = s_seeds[ ( seedIndex < sizeof( s_seeds ) / sizeof( s_seeds[ 0 ] ) ) ? seedIndex : ( seedIndex - 1 ) ];
+    context->fsmStateMapMode = DEF_SWC_FSM_STATE_MAP_HASH;
+
+    return FSM_OK;
+}
+#endif
+
+/**
+ * whether some row leads to state, from the target flags of the index once it is ready.
+ * contexts without the flags and states missing from fsmStateList fall back to a table scan.
+ */
+FSM_INLINE
+fsm_bool_t swcFsmIsTarget( fsm_state_t state, fsm_index_t slot, SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+
+    if ( context->fsmIndexReady && context->fsmStateTarget && ( slot < context->fsmStateSize ) ) {
+        return context->fsmStateTarget[ slot ];
+    }
+
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        if ( context->fsmTransTable[ index ].nextState == state )   return DEF_FSM_TRUE;
+    }
+
+    return DEF_FSM_FALSE;
+}
+
+/**
+ * number of superstates shared by the states at two slots, counted from the top. a state is not its own
+ * superstate, so a transition always leaves its source and enters its target, and the exit and entry
+ * paths of an edge are the first depth + 1 - level slots of each chain.
+ */
+FSM_INLINE
+fsm_index_t swcFsmLcaLevel( fsm_index_t fromSlot, fsm_index_t toSlot, SWCFsmContext* context )
+{
+#ifdef FSM_HIERARCHY
+    SWCFsmStateChain* from = NULL;
+    SWCFsmStateChain* to = NULL;
+    fsm_index_t level = 0;
+
+    if ( !( context->fsmStateChain ) || ( fromSlot >= context->fsmStateSize ) || ( toSlot >= context->fsmStateSize ) )   return 0;
+
+    from = &( context->fsmStateChain[ fromSlot ] );
+    to = &( context->fsmStateChain[ toSlot ] );
+    while ( ( level < from->depth ) && ( level < to->depth ) && \
+        ( from->slots[ from->depth - level ] == to->slots[ to->depth - level ] ) ) {
+        ++level;
+    }
+
+    return level;
+#else
+    UNUSED( fromSlot );
+    UNUSED( toSlot );
+    UNUSED( context );
+
+    return 0;
+#endif
+}
+
+#ifdef FSM_HIERARCHY
+/**
+ * flatten the parent links into one chain of slots per state, transitions then walk plain arrays.
+ * a parent that is not listed, a loop or nesting deeper than DEF_SWC_FSM_HIERARCHY_DEPTH leaves
+ * every state at the top level.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBuildHierarchy( SWCFsmContext* context )
+{
+    fsm_index_t slot = 0;
+    fsm_index_t parent = 0;
+    SWCFsmStateChain* chain = NULL;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( !( context->fsmStateChain ) )  return FSM_OK;
+
+    for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+        chain = &( context->fsmStateChain[ slot ] );
+        chain->depth = 0;
+        chain->slots[ 0 ] = slot;
+
+        while ( context->fsmStateList[ chain->slots[ chain->depth ] ].parent != DEF_SWC_FSM_STATE_INVALID ) {
+            parent = swcFsmGetStateSlot( context->fsmStateList[ chain->slots[ chain->depth ] ].parent, context );
+            if ( ( parent >= context->fsmStateSize ) || ( chain->depth + 1 >= DEF_SWC_FSM_HIERARCHY_DEPTH ) ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, context->fsmStateList[ slot ].state, context->fsmStateList[ chain->slots[ chain->depth ] ].parent );
+                for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+                    context->fsmStateChain[ slot ].depth = 0;
+                    context->fsmStateChain[ slot ].slots[ 0 ] = slot;
+                }
+                return FSM_ERR_INVALID_STATE;
+            }
+            chain->slots[ ++( chain->depth ) ] = parent;
+        }
+    }
+
+    return FSM_OK;
+}
+#endif
+
+#ifdef FSM_ROUTE
+/**
+ * breadth first search from every slot over the index, rows inherited from superstates included.
+ * fsmRouteNext[ from * fsmStateSize + to ] is the slot after from on a shortest path to to, from
+ * itself when both are the same, DEF_SWC_FSM_INDEX_INVALID when to cannot be reached. guards are
+ * not evaluated, they run when the route is walked.
+ */
+FSM_FUNC
+void swcFsmBuildRoute( SWCFsmContext* context )
+{
+    fsm_index_t size = context->fsmStateSize;
+    fsm_index_t* row = NULL;
+    fsm_index_t* queue = NULL;
+    fsm_index_t* path = NULL;
+    fsm_index_t from = 0;
+    fsm_index_t slot = 0;
+    fsm_index_t head = 0;
+    fsm_index_t tail = 0;
+    fsm_index_t level = 0;
+    fsm_index_t levels = 1;
+    fsm_index_t index = 0;
+    fsm_index_t end = 0;
+    fsm_index_t next = 0;
+
+    if ( !( context->fsmRouteNext ) )   return;
+
+    // the row past the matrix holds the search queue, every slot is queued at most once
+    queue = &( context->fsmRouteNext[ size * size ] );
+    for ( index = 0; index < size * size; ++index ) {
+        context->fsmRouteNext[ index ] = DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    if ( context->fsmIndexReady == DEF_FSM_FALSE )  return;
+
+    for ( from = 0; from < size; ++from ) {
+        row = &( context->fsmRouteNext[ from * size ] );
+        row[ from ] = from;
+        head = 0;
+        tail = 0;
+        queue[ tail++ ] = from;
+
+        while ( head < tail ) {
+            slot = queue[ head++ ];
+            path = &slot;
+            levels = 1;
+#ifdef FSM_HIERARCHY
+            if ( context->fsmStateChain ) {
+                path = context->fsmStateChain[ slot ].slots;
+                levels = context->fsmStateChain[ slot ].depth + 1;
+            }
+#endif
+            for ( level = 0; level < levels; ++level ) {
+                end = context->fsmTransOffset[ path[ level ] + 1 ];
+                for ( index = context->fsmTransOffset[ path[ level ] ]; index < end; ++index ) {
+                    next = context->fsmTransEdge[ index ].nextSlot;
+                    if ( ( next < size ) && ( row[ next ] == DEF_SWC_FSM_INDEX_INVALID ) ) {
+                        // the first hop is the one slot was reached through
+                        row[ next ] = ( slot == from ) ? next : row[ slot ];
+                        queue[ tail++ ] = next;
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * build the CSR transition index: rows of fsmTransTable are grouped by the slot of curState,
+ * table order is kept inside a group so the first matching row still wins.
+ * contexts without index storage keep the full table scan.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBuildIndex( SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+    fsm_index_t slot = 0;
+    fsm_index_t pos = 0;
+    fsm_error_t ret = FSM_OK;
+    SWCFsmTransItem *transItem = NULL;
+
+    UNUSED( index );
+    UNUSED( slot );
+    UNUSED( pos );
+    UNUSED( transItem );
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context->fsmIndexReady = DEF_FSM_FALSE;
+    swcFsmSeedWord( context );
+
+#ifdef FSM_STATE_MAP
+    swcFsmBuildStateMap( context );
+#endif
+#ifdef FSM_HIERARCHY
+    ret = swcFsmBuildHierarchy( context );
+#endif
+
+    if ( !( context->fsmTransOffset ) || !( context->fsmTransEdge ) ) {
+#ifdef FSM_ROUTE
+        swcFsmBuildRoute( context );
+#endif
+        return ret;
+    }
+
+    for ( slot = 0; slot <= context->fsmStateSize; ++slot ) {
+        context->fsmTransOffset[ slot ] = 0;
+    }
+
+    // count outgoing edges per slot, rows leaving an unlisted state stay out of the index
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        slot = swcFsmGetStateSlot( context->fsmTransTable[ index ].curState, context );
+        if ( slot < context->fsmStateSize ) {
+            ++( context->fsmTransOffset[ slot + 1 ] );
+        }
+    }
+
+    for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+        context->fsmTransOffset[ slot + 1 ] += context->fsmTransOffset[ slot ];
+    }
+
+    // scatter rows, fsmTransOffset[ slot ] is the write cursor of its group
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        transItem = &( context->fsmTransTable[ index ] );
+        slot = swcFsmGetStateSlot( transItem->curState, context );
+        if ( slot < context->fsmStateSize ) {
+            pos = ( context->fsmTransOffset[ slot ] )++;
+            context->fsmTransEdge[ pos ].nextState  = transItem->nextState;
+            context->fsmTransEdge[ pos ].nextSlot   = swcFsmGetStateSlot( transItem->nextState, context );
+            context->fsmTransEdge[ pos ].transIndex = index;
+#ifdef FSM_HIERARCHY
+            context->fsmTransEdge[ pos ].lcaLevel   = ( uint8_t )swcFsmLcaLevel( slot, context->fsmTransEdge[ pos ].nextSlot, context );
+#endif
+        }
+    }
+
+    // cursors stop at the end of each group, shift them back to the group start
+    for ( slot = context->fsmStateSize; slot > 0; --slot ) {
+        context->fsmTransOffset[ slot ] = context->fsmTransOffset[ slot - 1 ];
+    }
+    context->fsmTransOffset[ 0 ] = 0;
+
+    // flags of the states some row leads to, the forced path of swcFsmTransCore accepts only those
+    if ( context->fsmStateTarget ) {
+        for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+            context->fsmStateTarget[ slot ] = DEF_FSM_FALSE;
+        }
+        for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+            slot = swcFsmGetStateSlot( context->fsmTransTable[ index ].nextState, context );
+            if ( slot < context->fsmStateSize )     context->fsmStateTarget[ slot ] = DEF_FSM_TRUE;
+        }
+    }
+
+    // nothing above is written again once the index is ready, other threads may read it from now on
+    context->fsmIndexReady = DEF_FSM_TRUE;
+
+#ifdef FSM_ROUTE
+    swcFsmBuildRoute( context );
+#endif
+
+    return ret;
+}
+
+// a ready index, built before or prebuilt by tools/fsmc, is left alone
+FSM_INLINE
+void swcFsmEnsureIndex( SWCFsmContext* context )
+{
+    if ( context->fsmIndexReady == DEF_FSM_FALSE ) {
+        swcFsmBuildIndex( context );
+    }
+}
+
+/**
+ * first row from curState to state, only the outgoing edges of curSlot are touched when the index is ready.
+ * with FSM_HIERARCHY the rows of the superstates of curSlot follow, innermost first.
+ */
+FSM_INLINE
+SWCFsmTransItem* swcFsmFindTransItem( fsm_state_t state, fsm_state_t curState, fsm_index_t curSlot, fsm_index_t* nextSlot, fsm_index_t* lcaLevel, SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+    fsm_index_t end = 0;
+    fsm_index_t level = 0;
+    fsm_index_t levels = 1;
+    fsm_index_t* path = &curSlot;
+    SWCFsmTransEdge *edge = NULL;
+
+    UNUSED( edge );
+
+    if ( context->fsmIndexReady && ( curSlot < context->fsmStateSize ) ) {
+#ifdef FSM_HIERARCHY
+        if ( context->fsmStateChain ) {
+            path = context->fsmStateChain[ curSlot ].slots;
+            levels = context->fsmStateChain[ curSlot ].depth + 1;
+        }
+#endif
+        for ( level = 0; level < levels; ++level ) {
+            end = context->fsmTransOffset[ path[ level ] + 1 ];
+            for ( index = context->fsmTransOffset[ path[ level ] ]; index < end; ++index ) {
+                edge = &( context->fsmTransEdge[ index ] );
+                if ( edge->nextState == state ) {
+                    *nextSlot = edge->nextSlot;
+                    *lcaLevel = DEF_SWC_FSM_EDGE_LCA( edge );
+                    return &( context->fsmTransTable[ edge->transIndex ] );
+                }
+            }
+        }
+
+        return NULL;
+    }
+
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        if ( ( context->fsmTransTable[ index ].curState == curState ) && ( context->fsmTransTable[ index ].nextState == state ) ) {
+            *nextSlot = swcFsmGetStateSlot( state, context );
+            *lcaLevel = 0;
+            return &( context->fsmTransTable[ index ] );
+        }
+    }
+
+    return NULL;
+}
+
+FSM_INLINE
+fsm_bool_t swcFsmTransAllowed( fsm_state_t from, fsm_state_t to, ptrSWCFunTransferCheck transCheck, void* owner, SWCFsmContext* context )
+{
+    return ( ( !( context->fsmCommonCheck ) || ( ( *( context->fsmCommonCheck ) ) ( from, to, owner ) ) == DEF_FSM_TRUE ) && \
+        ( !( transCheck ) || ( ( *( transCheck ) ) ( from, to, owner ) ) ) == DEF_FSM_TRUE ) ? DEF_FSM_TRUE : DEF_FSM_FALSE;
+}
+
+#ifdef FSM_TIMER_WHEEL
+FSM_INLINE
+void swcFsmTimerUnlink( SWCFsmTimer* timer, SWCFsmTimerWheel* wheel )
+{
+    if ( !( timer->pprev ) )    return;
+
+    *( timer->pprev ) = timer->next;
+    if ( timer->next )  timer->next->pprev = timer->pprev;
+    if ( !( wheel->slots[ timer->slot ] ) ) {
+        wheel->occupied[ timer->slot >> DEF_SWC_FSM_WHEEL_BITS ] &= ~( 1ULL << ( timer->slot & DEF_SWC_FSM_WHEEL_MASK ) );
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    --( wheel->armed );
+}
+
+FSM_INLINE
+void swcFsmTimerInsert( SWCFsmTimer* timer, SWCFsmTimerWheel* wheel )
+{
+    uint64_t expire = timer->expire;
+    uint64_t delta = 0;
+    uint32_t level = 0;
+
+    // due now only happens on a cascade, right before the level 0 slot of now runs
+    if ( expire < wheel->now )      expire = wheel->now;
+    delta = expire - wheel->now;
+    // parked in the farthest slot, placed again with the real expiry when it cascades
+    if ( delta >= DEF_SWC_FSM_WHEEL_RANGE ) {
+        delta = DEF_SWC_FSM_WHEEL_RANGE - 1U;
+        expire = wheel->now + delta;
+    }
+
+    while ( delta >= ( 1ULL << ( DEF_SWC_FSM_WHEEL_BITS * ( level + 1U ) ) ) )    ++level;
+
+    timer->slot = ( level << DEF_SWC_FSM_WHEEL_BITS ) + ( uint32_t )( ( expire >> ( DEF_SWC_FSM_WHEEL_BITS * level ) ) & DEF_SWC_FSM_WHEEL_MASK );
+    timer->next = wheel->slots[ timer->slot ];
+    if ( timer->next )  timer->next->pprev = &( timer->next );
+    timer->pprev = &( wheel->slots[ timer->slot ] );
+    wheel->slots[ timer->slot ] = timer;
+    wheel->occupied[ level ] |= 1ULL << ( timer->slot & DEF_SWC_FSM_WHEEL_MASK );
+    ++( wheel->armed );
+}
+
+// interval 0 leaves the timer disarmed
+FSM_INLINE
+void swcFsmTimerArm( SWCFsmTimer* timer, uint32_t interval, SWCFsmTimerWheel* wheel )
+{
+    swcFsmTimerUnlink( timer, wheel );
+    if ( interval == 0 )    return;
+
+    timer->expire = wheel->now + interval;
+    swcFsmTimerInsert( timer, wheel );
+}
+
+// restart the routine and timeout timers of the state just entered
+FSM_INLINE
+void swcFsmWheelArmState( SWCFsmStateItem* state, SWCFsmContext* context )
+{
+    SWCFsmTimerWheel* wheel = context->fsmTimerWheel;
+
+    swcFsmTimerArm( &( context->fsmTimers[ DEF_SWC_FSM_TIMER_STATE ] ), ( state && state->routine ) ? state->routineInterval : 0U, wheel );
+    swcFsmTimerArm( &( context->fsmTimers[ DEF_SWC_FSM_TIMER_TIMEOUT ] ), ( state && ( state->timeoutState != DEF_SWC_FSM_STATE_INVALID ) ) ? state->timeout : 0U, wheel );
+}
+
+FSM_FUNC
+void swcFsmWheelRemove( SWCFsmContext* context )
+{
+    uint32_t kind = 0;
+
+    if ( !context || !( context->fsmTimerWheel ) )  return;
+
+    for ( kind = 0; kind < DEF_SWC_FSM_TIMER_KINDS; ++kind ) {
+        swcFsmTimerUnlink( &( context->fsmTimers[ kind ] ), context->fsmTimerWheel );
+    }
+    context->fsmTimerWheel = NULL;
+}
+#endif
+
+#ifdef FSM_TRACE
+FSM_INLINE
+void swcFsmTraceWrite( uint8_t kind, fsm_state_t fromState, fsm_state_t toState, fsm_bool_t bForce, fsm_error_t result, uint64_t timestamp, uint32_t exitTime, uint32_t entryTime, SWCFsmContext* context )
+{
+    SWCFsmTraceRing* ring = context->fsmTrace;
+    uint32_t sequence = FSM_ATOMIC_FETCH_ADD( &( ring->head ), 1U ) + 1U;
+    SWCFsmTraceRecord* record = &( ring->records[ ( sequence - 1U ) & ring->mask ] );
+
+    // seqlock, readers drop records whose sequence moves while they copy
+    FSM_ATOMIC_STORE_RELAXED( &( record->sequence ), 0U );
+    FSM_ATOMIC_FENCE_RELEASE();
+    record->timestamp = timestamp;
+    record->exitTime = exitTime;
+    record->entryTime = entryTime;
+    record->contextID = context->fsmContextID;
+    record->fromState = fromState;
+    record->toState = toState;
+    record->kind = kind;
+    record->force = bForce;
+    record->result = ( int16_t )result;
+    record->reserved = 0;
+    FSM_ATOMIC_STORE( &( record->sequence ), sequence );
+}
+#endif
+
+#ifdef FSM_STATS
+FSM_INLINE
+void swcFsmStatsRecord( SWCFsmLatency* latency, uint64_t time )
+{
+    uint32_t bucket = time ? ( 64U - ( uint32_t )FSM_CLZ64( time ) ) : 0U;
+
+    if ( bucket >= DEF_SWC_FSM_STATS_BUCKETS )  bucket = DEF_SWC_FSM_STATS_BUCKETS - 1U;
+
+    FSM_STATS_ADD( &( latency->count ), 1U );
+    FSM_STATS_ADD( &( latency->total ), time );
+    FSM_STATS_ADD( &( latency->histogram[ bucket ] ), 1U );
+}
+#endif
+
+// entry, exit or routine of a state item of context, timed when stats are kept
+FSM_INLINE
+fsm_error_t swcFsmCallAction( ptrSWCFunTransferAction action, uint32_t kind, SWCFsmStateItem* state, SWCFsmContext* context )
+{
+#ifdef FSM_STATS
+    uint64_t timestamp = 0;
+    fsm_error_t ret = FSM_OK;
+
+    if ( context->fsmStateStats ) {
+        timestamp = FSM_STATS_CLOCK();
+        ret = ( *( action ) )( state );
+        swcFsmStatsRecord( &( context->fsmStateStats[ state - context->fsmStateList ].action[ kind ] ), FSM_STATS_CLOCK() - timestamp );
+        return ret;
+    }
+#endif
+
+    UNUSED( kind );
+    UNUSED( context );
+
+    return ( *( action ) )( state );
+}
+
+#ifdef FSM_ASYNC
+// the frame slot of the action the calling thread runs for a transition, and the state item it runs for
+static FSM_THREAD_LOCAL SWCFsmActionFrame* s_fsmActionFrame = NULL;
+static FSM_THREAD_LOCAL const SWCFsmStateItem* s_fsmActionItem = NULL;
+
+FSM_INLINE
+void swcFsmFrameDrop( SWCFsmActionFrame* frame )
+{
+    if ( frame->frame && frame->release )   ( *( frame->release ) )( frame->frame );
+
+    frame->frame    = NULL;
+    frame->release  = NULL;
+}
+
+/**
+ * entry or exit action of a transition, the action reaches the frame of its owner through
+ * swcFsmActionFrame. a context keeps the frame while the action is pending, a pooled instance has
+ * nowhere to keep it, so whatever the action left there is freed once it returns.
+ */
+FSM_INLINE
+fsm_error_t swcFsmCallPathAction( ptrSWCFunTransferAction action, uint32_t kind, SWCFsmStateItem* item, void* owner, SWCFsmContext* context )
+{
+    SWCFsmActionFrame local = { NULL, NULL };
+    SWCFsmActionFrame* frame = ( owner == context ) ? &( context->fsmPending.frame ) : &local;
+    SWCFsmActionFrame* outerFrame = s_fsmActionFrame;
+    const SWCFsmStateItem* outerItem = s_fsmActionItem;
+    fsm_error_t ret = FSM_OK;
+
+    // actions may run transitions of other contexts, those restore the slot of this one
+    s_fsmActionFrame = frame;
+    s_fsmActionItem = item;
+    ret = swcFsmCallAction( action, kind, item, context );
+    s_fsmActionFrame = outerFrame;
+    s_fsmActionItem = outerItem;
+
+    if ( ( frame == &local ) || ( ret != FSM_PENDING ) )    swcFsmFrameDrop( frame );
+
+    return ret;
+}
+#endif
+
+// guards of a row of fsmTransTable, counted per row when stats are kept
+FSM_INLINE
+fsm_bool_t swcFsmTransGuard( SWCFsmTransItem* item, fsm_state_t from, fsm_state_t to, void* owner, SWCFsmContext* context )
+{
+#ifdef FSM_STATS
+    SWCFsmTransStats* stats = NULL;
+    uint64_t timestamp = 0;
+    fsm_bool_t bAllowed = DEF_FSM_FALSE;
+
+    if ( context->fsmTransStats ) {
+        stats = &( context->fsmTransStats[ item - context->fsmTransTable ] );
+        timestamp = FSM_STATS_CLOCK();
+        bAllowed = swcFsmTransAllowed( from, to, item->transCheck, owner, context );
+        swcFsmStatsRecord( &( stats->check ), FSM_STATS_CLOCK() - timestamp );
+        FSM_STATS_ADD( &( stats->attempts ), 1U );
+        if ( bAllowed != DEF_FSM_TRUE )     FSM_STATS_ADD( &( stats->rejected ), 1U );
+        return bAllowed;
+    }
+#endif
+
+    return swcFsmTransAllowed( from, to, item->transCheck, owner, context );
+}
+
+/**
+ * exit actions of the state at slot and of its superstates below lcaLevel, innermost first, skipping
+ * the done ones that have completed before. with FSM_ASYNC an action of the context itself may return
+ * FSM_PENDING, the path stops there and fsmPending.done tells where to go on.
+ */
+FSM_INLINE
+fsm_error_t swcFsmExitPath( fsm_index_t slot, fsm_index_t lcaLevel, fsm_index_t done, fsm_state_t curState, fsm_state_t state, void* owner, SWCFsmContext* context )
+{
+    fsm_index_t level = 0;
+    fsm_index_t levels = 1;
+    fsm_index_t* path = &slot;
+    SWCFsmStateItem* item = NULL;
+    fsm_error_t ret = FSM_OK;
+
+    UNUSED( lcaLevel );
+
+    if ( slot >= context->fsmStateSize )    return FSM_OK;
+
+#ifdef FSM_HIERARCHY
+    if ( context->fsmStateChain ) {
+        path = context->fsmStateChain[ slot ].slots;
+        levels = context->fsmStateChain[ slot ].depth + 1 - lcaLevel;
+    }
+#endif
+
+    for ( level = done; level < levels; ++level ) {
+        item = &( context->fsmStateList[ path[ level ] ] );
+#ifdef FSM_ASYNC
+        ret = item->exit ? swcFsmCallPathAction( item->exit, DEF_SWC_FSM_ACTION_EXIT, item, owner, context ) : FSM_OK;
+#else
+        ret = item->exit ? swcFsmCallAction( item->exit, DEF_SWC_FSM_ACTION_EXIT, item, context ) : FSM_OK;
+#endif
+#ifdef FSM_ASYNC
+        // pooled instances have nowhere to keep the path, FSM_PENDING fails them
+        if ( ( ret == FSM_PENDING ) && ( owner == context ) ) {
+            context->fsmPending.done = level;
+            return FSM_PENDING;
+        }
+#endif
+        if ( ret != FSM_OK ) {
+            FSM_ERROR_REPORT( context, owner, FSM_ERR_EXIT_FAILED, curState, state );
+            return FSM_ERR_EXIT_FAILED;
+        }
+    }
+
+    return FSM_OK;
+}
+
+// entry actions of the superstates of the state at slot below lcaLevel, outermost first, then of the state, as swcFsmExitPath
+FSM_INLINE
+fsm_error_t swcFsmEntryPath( fsm_index_t slot, fsm_index_t lcaLevel, fsm_index_t done, fsm_state_t curState, fsm_state_t state, void* owner, SWCFsmContext* context )
+{
+    fsm_index_t level = 1;
+    fsm_index_t levels = 1;
+    fsm_index_t* path = &slot;
+    SWCFsmStateItem* item = NULL;
+    fsm_error_t ret = FSM_OK;
+
+    UNUSED( lcaLevel );
+    UNUSED( levels );
+
+    if ( slot >= context->fsmStateSize )    return FSM_OK;
+
+#ifdef FSM_HIERARCHY
+    if ( context->fsmStateChain ) {
+        path = context->fsmStateChain[ slot ].slots;
+        level = context->fsmStateChain[ slot ].depth + 1 - lcaLevel;
+    }
+#endif
+
+    levels = level;
+    level -= ( done < level ) ? done : level;
+
+    while ( level-- > 0 ) {
+        item = &( context->fsmStateList[ path[ level ] ] );
+#ifdef FSM_ASYNC
+        ret = item->entry ? swcFsmCallPathAction( item->entry, DEF_SWC_FSM_ACTION_ENTRY, item, owner, context ) : FSM_OK;
+#else
+        ret = item->entry ? swcFsmCallAction( item->entry, DEF_SWC_FSM_ACTION_ENTRY, item, context ) : FSM_OK;
+#endif
+#ifdef FSM_ASYNC
+        if ( ( ret == FSM_PENDING ) && ( owner == context ) ) {
+            context->fsmPending.done = levels - 1 - level;
+            return FSM_PENDING;
+        }
+#endif
+        if ( ret != FSM_OK ) {
+            FSM_ERROR_REPORT( context, owner, FSM_ERR_ENTRY_FAILED, curState, state );
+            return FSM_ERR_ENTRY_FAILED;
+        }
+    }
+
+    return FSM_OK;
+}
+
+FSM_INLINE
+void swcFsmTransCommit( fsm_state_t state, fsm_index_t nextSlot, fsm_state_t* curState, fsm_state_t* preState, fsm_index_t* curSlot, void* owner, SWCFsmContext* context )
+{
+    // update state
+    if ( *curState != state ) {
+        *preState = *curState;
+    }
+    *curState = state;
+    *curSlot = nextSlot;
+
+#ifdef FSM_TIMER_WHEEL
+    // pooled instances share context and have no timers
+    if ( ( owner == context ) && context->fsmTimerWheel )   swcFsmWheelArmState( swcFsmGetSlotItem( nextSlot, context ), context );
+#else
+    UNUSED( owner );
+    UNUSED( context );
+#endif
+}
+
+#ifdef FSM_ASYNC
+FSM_INLINE
+fsm_error_t swcFsmPendingSave( uint8_t phase, fsm_state_t state, fsm_index_t nextSlot, fsm_index_t lcaLevel, SWCFsmContext* context )
+{
+    context->fsmPending.state       = state;
+    context->fsmPending.phase       = phase;
+    context->fsmPending.nextSlot    = nextSlot;
+    context->fsmPending.lcaLevel    = lcaLevel;
+
+    return FSM_PENDING;
+}
+#endif
+
+/**
+ * run the exit path of the current state and the entry path of the next one, then commit the new state.
+ * lcaLevel comes precomputed with the edge, it only matters with FSM_HIERARCHY. FSM_PENDING leaves the
+ * rest of the transition to swcFsmResume.
+ */
+FSM_INLINE
+fsm_error_t swcFsmTransExecute( fsm_state_t state, fsm_index_t nextSlot, fsm_index_t lcaLevel, fsm_state_t* curState, fsm_state_t* preState, fsm_index_t* curSlot, void* owner, SWCFsmContext* context )
+{
+#ifdef FSM_TRACE
+    fsm_bool_t bTrace = ( ( owner == context ) && context->fsmTrace ) ? DEF_FSM_TRUE : DEF_FSM_FALSE;
+    uint64_t timestamp = bTrace ? FSM_TRACE_CLOCK() : 0U;
+    uint64_t now = 0;
+#endif
+    fsm_error_t ret = FSM_OK;
+
+    ret = swcFsmExitPath( *curSlot, lcaLevel, 0U, *curState, state, owner, context );
+#ifdef FSM_ASYNC
+    if ( ret == FSM_PENDING )   return swcFsmPendingSave( DEF_SWC_FSM_PENDING_EXIT, state, nextSlot, lcaLevel, context );
+#endif
+    if ( ret != FSM_OK )    return FSM_ERR_EXIT_FAILED;
+
+#ifdef FSM_TRACE
+    if ( bTrace ) {
+        now = FSM_TRACE_CLOCK();
+        context->fsmTraceExit = ( uint32_t )( now - timestamp );
+        timestamp = now;
+    }
+#endif
+
+    ret = swcFsmEntryPath( nextSlot, lcaLevel, 0U, *curState, state, owner, context );
+#ifdef FSM_ASYNC
+    if ( ret == FSM_PENDING )   return swcFsmPendingSave( DEF_SWC_FSM_PENDING_ENTRY, state, nextSlot, lcaLevel, context );
+#endif
+    if ( ret != FSM_OK )    return FSM_ERR_ENTRY_FAILED;
+
+#ifdef FSM_TRACE
+    if ( bTrace )   context->fsmTraceEntry = ( uint32_t )( FSM_TRACE_CLOCK() - timestamp );
+#endif
+
+    swcFsmTransCommit( state, nextSlot, curState, preState, curSlot, owner, context );
+
+    return FSM_OK;
+}
+
+/**
+ * transition engine shared by contexts and pooled instances: tables and callbacks come from
+ * context, the mutable state is passed by pointer and owner is handed to the callbacks.
+ */
+FSM_INLINE
+fsm_error_t swcFsmTransCore( fsm_state_t state, fsm_bool_t bForce, fsm_state_t* curState, fsm_state_t* preState, fsm_index_t* curSlot, void* owner, SWCFsmContext* context )
+{
+    fsm_index_t nextSlot = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t lcaLevel = 0;
+    fsm_bool_t bTransition = DEF_FSM_FALSE;
+    SWCFsmTransItem *curfsmTransItem = NULL;
+#ifdef FSM_STATS
+    fsm_error_t ret = FSM_OK;
+#endif
+
+    UNUSED( bForce );
+    UNUSED( bTransition );
+    UNUSED( curfsmTransItem );
+
+    if ( state == DEF_SWC_FSM_STATE_INVALID ) {
+        FSM_ERROR_REPORT(context, owner, FSM_ERR_INVALID_STATE, *curState, state);
+        return FSM_ERR_INVALID_STATE;
+    }
+
+    // the transition in flight completes first, see swcFsmResume
+    if ( ( owner == context ) && FSM_IN_TRANSITION( context ) ) {
+        FSM_ERROR_REPORT( context, owner, FSM_ERR_BUSY, *curState, state );
+        return FSM_ERR_BUSY;
+    }
+
+    if ( ( bForce == DEF_FSM_FALSE ) && ( *curState == state ) ) return FSM_OK;
+
+    if ( bForce == DEF_FSM_FALSE ) {
+        curfsmTransItem = swcFsmFindTransItem( state, *curState, *curSlot, &nextSlot, &lcaLevel, context );
+        if ( curfsmTransItem ) {
+            if ( swcFsmTransGuard( curfsmTransItem, *curState, state, owner, context ) == DEF_FSM_TRUE ) {
+                bTransition = DEF_FSM_TRUE;
+            } else {
+                FSM_ERROR_REPORT(context, owner, FSM_ERR_CHECK_FAILED, *curState, state);
+                return FSM_ERR_CHECK_FAILED;
+            }
+        }
+    } else {
+        // skip all check, make sure next state in trans table
+        nextSlot = swcFsmGetStateSlot( state, context );
+        bTransition = swcFsmIsTarget( state, nextSlot, context );
+        lcaLevel = swcFsmLcaLevel( *curSlot, nextSlot, context );
+    }
+
+    if ( bTransition == DEF_FSM_TRUE ) {
+#ifdef FSM_STATS
+        ret = swcFsmTransExecute( state, nextSlot, lcaLevel, curState, preState, curSlot, owner, context );
+        if ( ( ret == FSM_OK ) && curfsmTransItem && context->fsmTransStats ) {
+            FSM_STATS_ADD( &( context->fsmTransStats[ curfsmTransItem - context->fsmTransTable ].succeeded ), 1U );
+        }
+        return ret;
+#else
+        return swcFsmTransExecute( state, nextSlot, lcaLevel, curState, preState, curSlot, owner, context );
+#endif
+    } else {
+        FSM_ERROR_REPORT( context, owner, FSM_ERR_NO_TRANSITION, *curState, state );
+
+        return FSM_ERR_NO_TRANSITION;
+    }
+}
+
+#ifdef FSM_RECORD
+// append one record, the request is dropped and counted when the recorder is full
+FSM_INLINE
+void swcFsmRecordWrite( uint8_t flags, fsm_state_t state, fsm_error_t result, SWCFsmContext* context )
+{
+    SWCFsmRecorder* recorder = context->fsmRecorder;
+    SWCFsmRecord* record = NULL;
+    uint32_t pos = 0;
+
+    // head stops growing once full, so it cannot wrap around onto the first records
+    if ( FSM_ATOMIC_LOAD_RELAXED( &( recorder->head ) ) >= recorder->capacity ) {
+        FSM_ATOMIC_FETCH_ADD( &( recorder->dropped ), 1U );
+        return;
+    }
+
+    pos = FSM_ATOMIC_FETCH_ADD( &( recorder->head ), 1U );
+    if ( pos >= recorder->capacity ) {
+        FSM_ATOMIC_FETCH_ADD( &( recorder->dropped ), 1U );
+        return;
+    }
+
+    record = &( recorder->records[ pos ] );
+    record->contextID   = context->fsmContextID;
+    record->state       = state;
+    record->nextState   = context->curState;
+    record->flags       = flags | ( ( result == FSM_ERR_CHECK_FAILED ) ? DEF_SWC_FSM_RECORD_REJECTED : 0U );
+    record->error       = ( int8_t )result;
+}
+#endif
+
+// swcFsmTransCore on the state of the context itself, one trace record and one log record when attached
+FSM_INLINE
+fsm_error_t swcFsmTransSelf( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+{
+#ifdef FSM_TRACE
+    fsm_state_t fromState = context->curState;
+    uint64_t timestamp = 0;
+#endif
+#if defined( FSM_TRACE ) || defined( FSM_RECORD )
+    fsm_error_t ret = FSM_OK;
+#endif
+
+#ifdef FSM_TRACE
+    if ( context->fsmTrace ) {
+        timestamp = FSM_TRACE_CLOCK();
+        context->fsmTraceExit = 0;
+        context->fsmTraceEntry = 0;
+        ret = swcFsmTransCore( state, bForce, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+        swcFsmTraceWrite( DEF_SWC_FSM_TRACE_TRANS, fromState, context->curState, bForce, ret, timestamp, context->fsmTraceExit, context->fsmTraceEntry, context );
+#ifdef FSM_RECORD
+        if ( context->fsmRecorder )     swcFsmRecordWrite( bForce ? DEF_SWC_FSM_RECORD_FORCE : 0U, state, ret, context );
+#endif
+        return ret;
+    }
+#endif
+#ifdef FSM_RECORD
+    if ( context->fsmRecorder ) {
+        ret = swcFsmTransCore( state, bForce, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+        swcFsmRecordWrite( bForce ? DEF_SWC_FSM_RECORD_FORCE : 0U, state, ret, context );
+        return ret;
+    }
+#endif
+
+    return swcFsmTransCore( state, bForce, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+}
+
+// swcFsmTransTo without the null check and the deferred request scope
+FSM_INLINE
+fsm_error_t swcFsmTransApply( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+{
+#ifdef FSM_CONCURRENT
+    uint64_t word = 0;
+    fsm_error_t ret = FSM_OK;
+
+    if ( ( bForce == DEF_FSM_FALSE ) && ( swcFsmGetCurState( context ) == state ) ) {
+        ret = FSM_OK;
+    } else if ( swcFsmClaim( &word, context ) != FSM_OK ) {
+        ret = FSM_ERR_BUSY;
+    } else {
+        ret = swcFsmTransSelf( state, bForce, context );
+        swcFsmRelease( word, context );
+        return ret;
+    }
+
+#ifdef FSM_TRACE
+    // the state is not owned here, no action ran
+    if ( context->fsmTrace ) {
+        swcFsmTraceWrite( DEF_SWC_FSM_TRACE_TRANS, swcFsmGetCurState( context ), state, bForce, ret, FSM_TRACE_CLOCK(), 0U, 0U, context );
+    }
+#endif
+    return ret;
+#else
+    return swcFsmTransSelf( state, bForce, context );
+#endif
+}
+
+#ifdef FSM_ASYNC
+// call the pending action again and go on along the rest of the transition
+FSM_INLINE
+fsm_error_t swcFsmResumeCore( SWCFsmContext* context )
+{
+    SWCFsmPending* pending = &( context->fsmPending );
+    fsm_error_t ret = FSM_OK;
+
+    if ( pending->phase == DEF_SWC_FSM_PENDING_EXIT ) {
+        ret = swcFsmExitPath( context->curSlot, pending->lcaLevel, pending->done, context->curState, pending->state, context, context );
+        if ( ret == FSM_PENDING )   return FSM_PENDING;
+        if ( ret != FSM_OK ) {
+            pending->phase = DEF_SWC_FSM_PENDING_NONE;
+            return FSM_ERR_EXIT_FAILED;
+        }
+        pending->phase = DEF_SWC_FSM_PENDING_ENTRY;
+        pending->done = 0;
+    }
+
+    ret = swcFsmEntryPath( pending->nextSlot, pending->lcaLevel, pending->done, context->curState, pending->state, context, context );
+    if ( ret == FSM_PENDING )   return FSM_PENDING;
+
+    pending->phase = DEF_SWC_FSM_PENDING_NONE;
+    if ( ret != FSM_OK )    return FSM_ERR_ENTRY_FAILED;
+
+    swcFsmTransCommit( pending->state, pending->nextSlot, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+
+    return FSM_OK;
+}
+
+/**
+ * go on with the transition whose action returned FSM_PENDING: the action is called again, and when it
+ * completes the rest of the exit and entry path runs and the new state is committed. returns
+ * FSM_PENDING while an action is still pending, FSM_OK once the transition has completed or when none
+ * was in flight, or the failure of an action, which ends the transition in the source state.
+ * swcFsmRoutine calls it instead of the routines while a transition is in flight.
+ */
+FSM_FUNC
+fsm_error_t swcFsmResume( SWCFsmContext* context )
+{
+#ifdef FSM_CONCURRENT
+    uint64_t word = 0;
+#endif
+#ifdef FSM_TRACE
+    fsm_state_t fromState = DEF_SWC_FSM_STATE_INVALID;
+    uint64_t timestamp = 0;
+#endif
+#ifdef FSM_RECORD
+    fsm_state_t state = DEF_SWC_FSM_STATE_INVALID;
+#endif
+    fsm_error_t ret = FSM_OK;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+#ifdef FSM_CONCURRENT
+    if ( swcFsmClaim( &word, context ) != FSM_OK )  return FSM_ERR_BUSY;
+#endif
+
+    if ( FSM_IN_TRANSITION( context ) ) {
+#ifdef FSM_TRACE
+        fromState = context->curState;
+        timestamp = FSM_TRACE_CLOCK();
+#endif
+#ifdef FSM_RECORD
+        state = context->fsmPending.state;
+#endif
+        ret = swcFsmResumeCore( context );
+#ifdef FSM_TRACE
+        // one more record per call, the last one carries the result of the transition
+        if ( context->fsmTrace ) {
+            swcFsmTraceWrite( DEF_SWC_FSM_TRACE_TRANS, fromState, context->curState, DEF_FSM_FALSE, ret, timestamp, 0U, 0U, context );
+        }
+#endif
+#ifdef FSM_RECORD
+        if ( context->fsmRecorder )     swcFsmRecordWrite( DEF_SWC_FSM_RECORD_RESUME, state, ret, context );
+#endif
+    }
+
+#ifdef FSM_CONCURRENT
+    swcFsmRelease( word, context );
+#endif
+
+    return ret;
+}
+
+// target of the transition in flight, DEF_SWC_FSM_STATE_INVALID when none
+FSM_FUNC
+fsm_state_t swcFsmGetPendingState( SWCFsmContext* context )
+{
+    if ( !context || !FSM_IN_TRANSITION( context ) )    return DEF_SWC_FSM_STATE_INVALID;
+
+    return context->fsmPending.state;
+}
+
+/**
+ * the frame an entry or exit action keeps between its calls, for the owner it runs for: item is the
+ * state item the action got. NULL outside a transition of the C functions, e.g. under swc::fsm::Machine,
+ * the action must then finish within the call. the frame is freed with its release function when the
+ * transition is dropped, or at once for a pooled instance that cannot wait.
+ */
+FSM_FUNC
+SWCFsmActionFrame* swcFsmActionFrame( const SWCFsmStateItem* item )
+{
+    return ( item && ( item == s_fsmActionItem ) ) ? s_fsmActionFrame : NULL;
+}
+#endif
+
+#ifdef FSM_DEFERRED
+FSM_INLINE
+void swcFsmDeferEnter( SWCFsmContext* context )
+{
+    if ( context->fsmDeferQueue )   ++( context->fsmDeferQueue->depth );
+}
+
+// the outermost call applies the requests, those made by their own actions queue up behind them
+FSM_INLINE
+void swcFsmDeferLeave( SWCFsmContext* context )
+{
+    SWCFsmDeferQueue* queue = context->fsmDeferQueue;
+    SWCFsmDeferCell cell;
+
+    if ( !queue )   return;
+
+    if ( queue->depth > 1U ) {
+        --( queue->depth );
+        return;
+    }
+
+    // requests behind a pending action wait for the scope swcFsmRoutine opens to resume it
+    while ( ( queue->head != queue->tail ) && !FSM_IN_TRANSITION( context ) ) {
+        cell = queue->cells[ queue->head & ( DEF_SWC_FSM_DEFER_SIZE - 1U ) ];
+        ++( queue->head );
+        // errors are reported by the transition
+        swcFsmTransApply( cell.state, cell.bForce, context );
+    }
+
+    queue->depth = 0;
+}
+
+#define FSM_DEFER_ENTER( _context )             swcFsmDeferEnter( _context )
+#define FSM_DEFER_LEAVE( _context )             swcFsmDeferLeave( _context )
+#else
+#define FSM_DEFER_ENTER( _context )
+#define FSM_DEFER_LEAVE( _context )
+#endif
+
+FSM_FUNC
+fsm_error_t swcFsmTransTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+{
+#ifdef FSM_DEFERRED
+    fsm_error_t ret = FSM_OK;
+#endif
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+#ifdef FSM_DEFERRED
+    swcFsmDeferEnter( context );
+    ret = swcFsmTransApply( state, bForce, context );
+    swcFsmDeferLeave( context );
+
+    return ret;
+#else
+    return swcFsmTransApply( state, bForce, context );
+#endif
+}
+
+#ifdef FSM_DEFERRED
+/**
+ * queue a transition from an action, it is taken after the outermost running call on context has
+ * returned, so actions never run nested and the stack stays flat for chained transitions. without a
+ * running call the transition is taken at once. returns FSM_ERR_QUEUE_FULL when
+ * DEF_SWC_FSM_DEFER_SIZE requests are pending, the result of the transition itself goes to the
+ * error handler.
+ */
+FSM_FUNC
+fsm_error_t swcFsmRequestTransition( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+{
+    SWCFsmDeferQueue* queue = NULL;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    queue = context->fsmDeferQueue;
+
+    if ( !queue || ( queue->depth == 0U ) )   return swcFsmTransTo( state, bForce, context );
+
+    if ( queue->tail - queue->head >= DEF_SWC_FSM_DEFER_SIZE ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_QUEUE_FULL, context->curState, state );
+        return FSM_ERR_QUEUE_FULL;
+    }
+
+    queue->cells[ queue->tail & ( DEF_SWC_FSM_DEFER_SIZE - 1U ) ].state     = state;
+    queue->cells[ queue->tail & ( DEF_SWC_FSM_DEFER_SIZE - 1U ) ].bForce    = bForce;
+    ++( queue->tail );
+
+    return FSM_OK;
+}
+#endif
+
+#ifdef FSM_ROUTE
+/**
+ * state after from on a shortest path to state, one read of fsmRouteNext. from itself when both are
+ * the same, DEF_SWC_FSM_STATE_INVALID when state cannot be reached or either is not listed.
+ */
+FSM_FUNC
+fsm_state_t swcFsmRouteNext( fsm_state_t from, fsm_state_t state, SWCFsmContext* context )
+{
+    fsm_index_t fromSlot = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t toSlot = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t hop = DEF_SWC_FSM_INDEX_INVALID;
+
+    if ( !context || !( context->fsmRouteNext ) )     return DEF_SWC_FSM_STATE_INVALID;
+
+    fromSlot = swcFsmGetStateSlot( from, context );
+    toSlot = swcFsmGetStateSlot( state, context );
+    if ( ( fromSlot >= context->fsmStateSize ) || ( toSlot >= context->fsmStateSize ) )   return DEF_SWC_FSM_STATE_INVALID;
+
+    hop = context->fsmRouteNext[ fromSlot * context->fsmStateSize + toSlot ];
+
+    return ( hop < context->fsmStateSize ) ? context->fsmStateList[ hop ].state : DEF_SWC_FSM_STATE_INVALID;
+}
+
+/**
+ * walk a shortest path from the current state to state. each hop is a regular transition, so guards,
+ * exit and entry actions run at every step, and its next state is one read of fsmRouteNext. the walk
+ * stops at the first hop that fails and returns its error, the context stays in the state reached.
+ * an action that moves the state elsewhere reroutes from there. FSM_ERR_NO_TRANSITION when state
+ * cannot be reached.
+ */
+FSM_FUNC
+fsm_error_t swcFsmRouteTo( fsm_state_t state, SWCFsmContext* context )
+{
+    fsm_index_t size = 0;
+    fsm_index_t target = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t hop = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t count = 0;
+    fsm_error_t ret = FSM_ERR_NO_TRANSITION;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    size = context->fsmStateSize;
+    target = swcFsmGetStateSlot( state, context );
+    if ( target >= size ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, swcFsmGetCurState( context ), state );
+        return FSM_ERR_INVALID_STATE;
+    }
+
+    FSM_DEFER_ENTER( context );
+
+    // a shortest path has less than size hops, the bound ends walks that actions keep diverting
+    for ( count = 0; count <= size; ++count ) {
+#ifdef FSM_CONCURRENT
+        slot = swcFsmGetStateSlot( swcFsmGetCurState( context ), context );
+#else
+        slot = context->curSlot;
+#endif
+        if ( slot == target ) {
+            ret = FSM_OK;
+            break;
+        }
+
+        hop = ( context->fsmRouteNext && ( slot < size ) ) ? context->fsmRouteNext[ slot * size + target ] : DEF_SWC_FSM_INDEX_INVALID;
+        if ( hop >= size ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, swcFsmGetCurState( context ), state );
+            ret = FSM_ERR_NO_TRANSITION;
+            break;
+        }
+
+        ret = swcFsmTransApply( context->fsmStateList[ hop ].state, DEF_FSM_FALSE, context );
+        if ( ret != FSM_OK )    break;
+        ret = FSM_ERR_NO_TRANSITION;
+    }
+
+    if ( count > size ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, swcFsmGetCurState( context ), state );
+    }
+
+    FSM_DEFER_LEAVE( context );
+
+    return ret;
+}
+#endif
+
+#ifdef FSM_EVENT_TABLE
+/**
+ * attach an event table to its context and fill the [slot][event] matrix,
+ * the first row of a duplicated ( curState, event ) pair wins.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBindEventTable( SWCFsmEventTable* table )
+{
+    fsm_index_t index = 0;
+    fsm_index_t slot = 0;
+    fsm_index_t cell = 0;
+    SWCFsmContext* context = NULL;
+    SWCFsmEventTransItem* item = NULL;
+#ifdef FSM_HIERARCHY
+    fsm_index_t level = 0;
+    fsm_event_t event = 0;
+    SWCFsmStateChain* chain = NULL;
+#endif
+
+    if ( !table || !( table->fsmContext ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context = table->fsmContext;
+#ifdef FSM_HIERARCHY
+    swcFsmBuildHierarchy( context );
+#endif
+
+    for ( cell = 0; cell < context->fsmStateSize * table->fsmEventCount; ++cell ) {
+        table->fsmEventMatrix[ cell ].nextSlot      = DEF_SWC_FSM_INDEX_INVALID;
+        table->fsmEventMatrix[ cell ].transIndex    = DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    for ( index = 0; index < table->fsmEventTransSize; ++index ) {
+        item = &( table->fsmEventTransTable[ index ] );
+        slot = swcFsmGetStateSlot( item->curState, context );
+
+        if ( ( slot >= context->fsmStateSize ) || ( item->event >= table->fsmEventCount ) ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, item->curState, item->nextState );
+            return FSM_ERR_INVALID_STATE;
+        }
+
+        cell = slot * table->fsmEventCount + item->event;
+        if ( table->fsmEventMatrix[ cell ].transIndex == DEF_SWC_FSM_INDEX_INVALID ) {
+            table->fsmEventMatrix[ cell ].nextSlot      = swcFsmGetStateSlot( item->nextState, context );
+            table->fsmEventMatrix[ cell ].transIndex    = index;
+#ifdef FSM_HIERARCHY
+            table->fsmEventMatrix[ cell ].lcaLevel      = ( uint8_t )swcFsmLcaLevel( slot, table->fsmEventMatrix[ cell ].nextSlot, context );
+#endif
+        }
+    }
+
+#ifdef FSM_HIERARCHY
+    // an event a state does not handle itself takes the row of its nearest superstate that does
+    if ( context->fsmStateChain ) {
+        for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+            chain = &( context->fsmStateChain[ slot ] );
+            for ( event = 0; event < table->fsmEventCount; ++event ) {
+                cell = slot * table->fsmEventCount + event;
+                for ( level = 1; ( level <= chain->depth ) && ( table->fsmEventMatrix[ cell ].transIndex == DEF_SWC_FSM_INDEX_INVALID ); ++level ) {
+                    table->fsmEventMatrix[ cell ] = table->fsmEventMatrix[ chain->slots[ level ] * table->fsmEventCount + event ];
+                }
+            }
+        }
+    }
+#endif
+
+    context->fsmEventTable = table;
+
+    return FSM_OK;
+}
+
+// one indexed load: the transition of event in slot, NULL when the state does not react to it
+FSM_INLINE
+SWCFsmEventEdge* swcFsmFindEventEdge( fsm_event_t event, fsm_index_t curSlot, SWCFsmContext* context )
+{
+    SWCFsmEventTable* table = context->fsmEventTable;
+    SWCFsmEventEdge* edge = NULL;
+
+    if ( !table || ( event >= table->fsmEventCount ) || ( curSlot >= context->fsmStateSize ) )    return NULL;
+
+    edge = &( table->fsmEventMatrix[ curSlot * table->fsmEventCount + event ] );
+
+    return ( edge->transIndex != DEF_SWC_FSM_INDEX_INVALID ) ? edge : NULL;
+}
+
+FSM_INLINE
+fsm_error_t swcFsmEventCore( fsm_event_t event, fsm_state_t* curState, fsm_state_t* preState, fsm_index_t* curSlot, void* owner, SWCFsmContext* context )
+{
+    SWCFsmEventEdge* edge = swcFsmFindEventEdge( event, *curSlot, context );
+    SWCFsmEventTransItem* item = NULL;
+
+    if ( ( owner == context ) && FSM_IN_TRANSITION( context ) ) {
+        FSM_ERROR_REPORT( context, owner, FSM_ERR_BUSY, *curState, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_BUSY;
+    }
+
+    if ( !edge ) {
+        FSM_ERROR_REPORT( context, owner, FSM_ERR_NO_TRANSITION, *curState, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NO_TRANSITION;
+    }
+
+    item = &( context->fsmEventTable->fsmEventTransTable[ edge->transIndex ] );
+
+    if ( swcFsmTransAllowed( *curState, item->nextState, item->transCheck, owner, context ) != DEF_FSM_TRUE ) {
+        FSM_ERROR_REPORT( context, owner, FSM_ERR_CHECK_FAILED, *curState, item->nextState );
+        return FSM_ERR_CHECK_FAILED;
+    }
+
+    return swcFsmTransExecute( item->nextState, edge->nextSlot, DEF_SWC_FSM_EDGE_LCA( edge ), curState, preState, curSlot, owner, context );
+}
+
+// swcFsmEventCore on the state of the context itself, one trace record and one log record when attached
+FSM_INLINE
+fsm_error_t swcFsmEventSelf( fsm_event_t event, SWCFsmContext* context )
+{
+#ifdef FSM_TRACE
+    fsm_state_t fromState = context->curState;
+    uint64_t timestamp = 0;
+#endif
+#if defined( FSM_TRACE ) || defined( FSM_RECORD )
+    fsm_error_t ret = FSM_OK;
+#endif
+
+#ifdef FSM_TRACE
+    if ( context->fsmTrace ) {
+        timestamp = FSM_TRACE_CLOCK();
+        context->fsmTraceExit = 0;
+        context->fsmTraceEntry = 0;
+        ret = swcFsmEventCore( event, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+        swcFsmTraceWrite( DEF_SWC_FSM_TRACE_TRANS, fromState, context->curState, DEF_FSM_FALSE, ret, timestamp, context->fsmTraceExit, context->fsmTraceEntry, context );
+#ifdef FSM_RECORD
+        if ( context->fsmRecorder )     swcFsmRecordWrite( DEF_SWC_FSM_RECORD_EVENT, event, ret, context );
+#endif
+        return ret;
+    }
+#endif
+#ifdef FSM_RECORD
+    if ( context->fsmRecorder ) {
+        ret = swcFsmEventCore( event, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+        swcFsmRecordWrite( DEF_SWC_FSM_RECORD_EVENT, event, ret, context );
+        return ret;
+    }
+#endif
+
+    return swcFsmEventCore( event, &( context->curState ), &( context->preState ), &( context->curSlot ), context, context );
+}
+
+// take the transition bound to event in the current state, guards and entry/exit actions still run
+FSM_FUNC
+fsm_error_t swcFsmHandleEvent( fsm_event_t event, SWCFsmContext* context )
+{
+#ifdef FSM_CONCURRENT
+    uint64_t word = 0;
+#endif
+    fsm_error_t ret = FSM_OK;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    FSM_DEFER_ENTER( context );
+#ifdef FSM_CONCURRENT
+    if ( swcFsmClaim( &word, context ) != FSM_OK ) {
+        ret = FSM_ERR_BUSY;
+#ifdef FSM_TRACE
+        // the state is not owned here, no action ran
+        if ( context->fsmTrace ) {
+            swcFsmTraceWrite( DEF_SWC_FSM_TRACE_TRANS, swcFsmGetCurState( context ), swcFsmGetCurState( context ), DEF_FSM_FALSE, ret, FSM_TRACE_CLOCK(), 0U, 0U, context );
+        }
+#endif
+    } else {
+        ret = swcFsmEventSelf( event, context );
+        swcFsmRelease( word, context );
+    }
+#else
+    ret = swcFsmEventSelf( event, context );
+#endif
+    FSM_DEFER_LEAVE( context );
+
+    return ret;
+}
+#endif
+
+#ifdef FSM_DFA
+/**
+ * reduce table to its next slots. only machines that nothing but the state depends on qualify: no
+ * common check, no guard on any row and no entry or exit action on any state, otherwise
+ * FSM_ERR_INIT_FAILED. the table is bound first when it is not yet.
+ */
+FSM_FUNC
+fsm_error_t swcFsmDfaBuild( SWCFsmEventTable* table, SWCFsmDfa* dfa )
+{
+    fsm_index_t index = 0;
+    fsm_index_t cells = 0;
+    fsm_error_t ret = FSM_OK;
+    SWCFsmContext* context = NULL;
+
+    if ( !table || !( table->fsmContext ) || !dfa ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context = table->fsmContext;
+    cells = context->fsmStateSize * table->fsmEventCount;
+
+    if ( ( cells > dfa->fsmCapacity ) || ( context->fsmCommonCheck ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    for ( index = 0; index < table->fsmEventTransSize; ++index ) {
+        if ( table->fsmEventTransTable[ index ].transCheck ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, table->fsmEventTransTable[ index ].curState, table->fsmEventTransTable[ index ].nextState );
+            return FSM_ERR_INIT_FAILED;
+        }
+    }
+
+    for ( index = 0; index < context->fsmStateSize; ++index ) {
+        if ( context->fsmStateList[ index ].entry || context->fsmStateList[ index ].exit ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, context->fsmStateList[ index ].state, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_INIT_FAILED;
+        }
+    }
+
+    if ( context->fsmEventTable != table ) {
+        ret = swcFsmBindEventTable( table );
+        if ( ret != FSM_OK )    return ret;
+    }
+
+    // superstate rows are already folded into the matrix
+    for ( index = 0; index < cells; ++index ) {
+        dfa->fsmDelta[ index ] = ( table->fsmEventMatrix[ index ].transIndex != DEF_SWC_FSM_INDEX_INVALID ) ? \
+            table->fsmEventMatrix[ index ].nextSlot : DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    dfa->fsmStateSize = context->fsmStateSize;
+    dfa->fsmEventCount = table->fsmEventCount;
+
+    return FSM_OK;
+}
+
+FSM_INLINE
+fsm_index_t swcFsmDfaStepScalar( fsm_index_t* slots, const fsm_event_t* events, fsm_index_t begin, fsm_index_t count, uint64_t* undefined, const SWCFsmDfa* dfa )
+{
+    fsm_index_t index = 0;
+    fsm_index_t next = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t missed = 0;
+
+    for ( index = begin; index < count; ++index ) {
+        next = ( ( slots[ index ] < dfa->fsmStateSize ) && ( events[ index ] < dfa->fsmEventCount ) ) ? \
+            dfa->fsmDelta[ slots[ index ] * dfa->fsmEventCount + events[ index ] ] : DEF_SWC_FSM_INDEX_INVALID;
+
+        if ( next == DEF_SWC_FSM_INDEX_INVALID ) {
+            if ( undefined )    undefined[ index >> 6 ] |= ( uint64_t )1U << ( index & 63U );
+            ++missed;
+        } else {
+            slots[ index ] = next;
+        }
+    }
+
+    return missed;
+}
+
+#if defined( __AVX2__ ) && !defined( FSM_DFA_SCALAR )
+/**
+ * 8 instances per iteration: bounds checked in vector registers, one masked gather of the next slots,
+ * lanes that are undefined keep their slot and leave their bit in the mask. the tail goes scalar.
+ */
+FSM_INLINE
+fsm_index_t swcFsmDfaStepAvx2( fsm_index_t* slots, const fsm_event_t* events, fsm_index_t count, uint64_t* undefined, const SWCFsmDfa* dfa )
+{
+    fsm_index_t index = 0;
+    fsm_index_t missed = 0;
+    uint32_t bits = 0;
+    const __m256i lastSlot = _mm256_set1_epi32( ( int )( dfa->fsmStateSize - 1U ) );
+    const __m256i lastEvent = _mm256_set1_epi32( ( int )( dfa->fsmEventCount - 1U ) );
+    const __m256i eventCount = _mm256_set1_epi32( ( int )dfa->fsmEventCount );
+    const __m256i none = _mm256_set1_epi32( -1 );
+    __m256i slot, event, valid, next, miss;
+
+    for ( index = 0; index + 8U <= count; index += 8U ) {
+        slot = _mm256_loadu_si256( ( const __m256i* )&( slots[ index ] ) );
+        event = _mm256_cvtepu16_epi32( _mm_loadu_si128( ( const __m128i* )&( events[ index ] ) ) );
+
+        // unsigned x <= last as min( x, last ) == x
+        valid = _mm256_and_si256( _mm256_cmpeq_epi32( _mm256_min_epu32( slot, lastSlot ), slot ), \
+                                  _mm256_cmpeq_epi32( _mm256_min_epu32( event, lastEvent ), event ) );
+        next = _mm256_mask_i32gather_epi32( none, ( const int* )( dfa->fsmDelta ), \
+                                            _mm256_add_epi32( _mm256_mullo_epi32( slot, eventCount ), event ), valid, 4 );
+
+        miss = _mm256_cmpeq_epi32( next, none );
+        _mm256_storeu_si256( ( __m256i* )&( slots[ index ] ), _mm256_blendv_epi8( next, slot, miss ) );
+
+        bits = ( uint32_t )_mm256_movemask_ps( _mm256_castsi256_ps( miss ) );
+        if ( bits ) {
+            if ( undefined )    undefined[ index >> 6 ] |= ( uint64_t )bits << ( index & 63U );
+            for ( ; bits; bits &= bits - 1U ) {
+                ++missed;
+            }
+        }
+    }
+
+    return missed + swcFsmDfaStepScalar( slots, events, index, count, undefined, dfa );
+}
+#endif
+
+/**
+ * advance every instance by one event: slots[ i ] takes events[ i ]. an instance whose transition is
+ * undefined, or whose slot or event is out of range, keeps its slot and sets bit i of undefined,
+ * ( count + 63 ) / 64 words that are cleared first, may be NULL. returns how many were undefined.
+ * no guard, action, stats or trace runs, instances are slots as swcFsmGetStateSlot gives them.
+ */
+FSM_FUNC
+fsm_index_t swcFsmDfaStep( fsm_index_t* slots, const fsm_event_t* events, fsm_index_t count, uint64_t* undefined, const SWCFsmDfa* dfa )
+{
+    fsm_index_t index = 0;
+
+    if ( undefined ) {
+        for ( index = 0; index < ( count + 63U ) / 64U; ++index ) {
+            undefined[ index ] = 0;
+        }
+    }
+
+    // an empty or unbuilt table defines nothing
+    if ( !dfa || ( dfa->fsmStateSize == 0U ) || ( dfa->fsmEventCount == 0U ) ) {
+        for ( index = 0; undefined && ( index < count ); ++index ) {
+            undefined[ index >> 6 ] |= ( uint64_t )1U << ( index & 63U );
+        }
+        return count;
+    }
+
+#if defined( __AVX2__ ) && !defined( FSM_DFA_SCALAR )
+    return swcFsmDfaStepAvx2( slots, events, count, undefined, dfa );
+#else
+    return swcFsmDfaStepScalar( slots, events, 0, count, undefined, dfa );
+#endif
+}
+#endif
+
+FSM_FUNC
+fsm_error_t swcFsmInit( SWCFsmContext* context )
+{
+#ifdef FSM_ASYNC
+    fsm_error_t ret = FSM_OK;
+#endif
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( ( context->fsmInit ) && ( ( *( context->fsmInit ) )( context ) != FSM_OK ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, context->initState );
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    if ( context->fsmIndexReady == DEF_FSM_FALSE ) {
+        swcFsmBuildIndex( context );
+#ifdef FSM_ROUTE
+    } else {
+        // a prebuilt index comes without routes
+        swcFsmBuildRoute( context );
+#endif
+    }
+    swcFsmSeedWord( context );
+    context->curSlot = swcFsmGetStateSlot( context->curState, context );
+
+    // transfer to init state
+#ifdef FSM_ASYNC
+    swcFsmFrameDrop( &( context->fsmPending.frame ) );
+    context->fsmPending.phase = DEF_SWC_FSM_PENDING_NONE;
+    // the init state is entered by swcFsmRoutine when its entry action is pending
+    ret = swcFsmTransTo( context->initState, DEF_FSM_TRUE, context );
+    if ( ret == FSM_PENDING )   return FSM_PENDING;
+    if ( ret != FSM_OK ) {
+#else
+    if ( swcFsmTransTo( context->initState, DEF_FSM_TRUE, context ) != FSM_OK ) {
+#endif
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, DEF_SWC_FSM_STATE_INVALID, context->initState );
+        return FSM_ERR_NO_TRANSITION;
+    }
+
+    return FSM_OK;
+}
+
+FSM_FUNC
+void swcFsmRoutine( SWCFsmContext* context )
+{
+    SWCFsmStateItem* state = NULL;
+    fsm_error_t ret = FSM_OK;
+#ifdef FSM_TRACE
+    fsm_state_t fromState = DEF_SWC_FSM_STATE_INVALID;
+    uint64_t timestamp = 0;
+#endif
+
+    UNUSED( state );
+    UNUSED( ret );
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return;
+    }
+
+    FSM_DEFER_ENTER( context );
+
+#ifdef FSM_ASYNC
+    // a transition in flight owns the context, its pending action runs instead of the routines
+    if ( FSM_IN_TRANSITION( context ) ) {
+        swcFsmResume( context );
+        FSM_DEFER_LEAVE( context );
+        return;
+    }
+#endif
+
+#ifdef FSM_TRACE
+    if ( context->fsmTrace ) {
+        fromState = swcFsmGetCurState( context );
+        timestamp = FSM_TRACE_CLOCK();
+    }
+#endif
+
+    if ( context->fsmRoutine ) {
+        if ( ( *( context->fsmRoutine ) )( context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER(context, FSM_ERR_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+            ret = FSM_ERR_ROUTINE_FAILED;
+        }
+    }
+
+    state = swcFsmGetCurStateItem( context );
+
+    if ( state && state->routine ) {
+        if ( swcFsmCallAction( state->routine, DEF_SWC_FSM_ACTION_ROUTINE, state, context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER(context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+            ret = FSM_ERR_STATE_ROUTINE_FAILED;
+        }
+    }
+
+#ifdef FSM_TRACE
+    if ( context->fsmTrace ) {
+        swcFsmTraceWrite( DEF_SWC_FSM_TRACE_ROUTINE, fromState, swcFsmGetCurState( context ), DEF_FSM_FALSE, ret, timestamp, 0U, ( uint32_t )( FSM_TRACE_CLOCK() - timestamp ), context );
+    }
+#endif
+
+    FSM_DEFER_LEAVE( context );
+}
+
+#ifdef FSM_ROUTINE_BATCH
+typedef struct
+{
+    ptrSWCFunTransferAction         routine;
+    ptrSWCFunBatchAction            routineBatch;
+    fsm_index_t                     start;
+    fsm_index_t                     next;
+} SWCFsmBatchBucket;
+
+// bucket of the current state of context, DEF_SWC_FSM_BATCH_BUCKETS when it has no routine or all buckets are taken
+FSM_INLINE
+uint32_t swcFsmBatchBucketOf( SWCFsmContext* context, SWCFsmBatchBucket* buckets, uint32_t* bucketSize )
+{
+    uint32_t bucket = 0;
+    SWCFsmStateItem* state = swcFsmGetCurStateItem( context );
+
+    // contexts in the middle of a transition resume one by one with the leftovers
+    if ( FSM_IN_TRANSITION( context ) )     return DEF_SWC_FSM_BATCH_BUCKETS;
+    if ( !state || ( !( state->routine ) && !( state->routineBatch ) ) )    return DEF_SWC_FSM_BATCH_BUCKETS;
+
+    for ( bucket = 0; bucket < *bucketSize; ++bucket ) {
+        if ( ( buckets[ bucket ].routine == state->routine ) && ( buckets[ bucket ].routineBatch == state->routineBatch ) ) {
+            return bucket;
+        }
+    }
+
+    if ( *bucketSize == DEF_SWC_FSM_BATCH_BUCKETS )     return DEF_SWC_FSM_BATCH_BUCKETS;
+
+    buckets[ bucket ].routine       = state->routine;
+    buckets[ bucket ].routineBatch  = state->routineBatch;
+    buckets[ bucket ].start         = 0;
+    buckets[ bucket ].next          = 0;
+    ++( *bucketSize );
+
+    return bucket;
+}
+
+FSM_INLINE
+void swcFsmBatchRunState( SWCFsmContext* context )
+{
+    SWCFsmStateItem* state = swcFsmGetCurStateItem( context );
+
+    FSM_DEFER_ENTER( context );
+#ifdef FSM_ASYNC
+    if ( FSM_IN_TRANSITION( context ) ) {
+        swcFsmResume( context );
+        FSM_DEFER_LEAVE( context );
+        return;
+    }
+#endif
+    if ( state && state->routine ) {
+        if ( swcFsmCallAction( state->routine, DEF_SWC_FSM_ACTION_ROUTINE, state, context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER(context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+        }
+    }
+    FSM_DEFER_LEAVE( context );
+}
+
+/**
+ * swcFsmRoutine over an array of contexts: fsmRoutine of every context runs first, then contexts are
+ * grouped in place by the routine of their current state and each group runs back to back, through
+ * routineBatch in one call when the state has one. the order of contexts is changed on return.
+ * states beyond DEF_SWC_FSM_BATCH_BUCKETS distinct routines run one by one at the end.
+ */
+FSM_FUNC
+void swcFsmRoutineBatch( SWCFsmContext** contexts, fsm_index_t count )
+{
+    SWCFsmBatchBucket buckets[ DEF_SWC_FSM_BATCH_BUCKETS ];
+    uint32_t bucketSize = 0;
+    uint32_t bucket = 0;
+    uint32_t target = 0;
+    fsm_index_t index = 0;
+    fsm_index_t end = 0;
+    fsm_index_t tail = 0;
+    fsm_index_t overflow = 0;
+    SWCFsmContext* context = NULL;
+
+    if ( !contexts ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return;
+    }
+
+    // fsm level routines may change the state, bucket afterwards
+    for ( index = 0; index < count; ++index ) {
+        context = contexts[ index ];
+        if ( context && context->fsmRoutine && !FSM_IN_TRANSITION( context ) ) {
+            FSM_DEFER_ENTER( context );
+            if ( ( *( context->fsmRoutine ) )( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER(context, FSM_ERR_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+            }
+            FSM_DEFER_LEAVE( context );
+        }
+    }
+
+    // count, buckets[ bucket ].next holds the size until the prefix sum
+    for ( index = 0; index < count; ++index ) {
+        if ( !contexts[ index ] )   continue;
+        bucket = swcFsmBatchBucketOf( contexts[ index ], buckets, &bucketSize );
+        if ( bucket < DEF_SWC_FSM_BATCH_BUCKETS ) {
+            ++( buckets[ bucket ].next );
+        }
+    }
+
+    for ( bucket = 0; bucket < bucketSize; ++bucket ) {
+        buckets[ bucket ].start = end;
+        end += buckets[ bucket ].next;
+        buckets[ bucket ].next = buckets[ bucket ].start;
+    }
+    tail = end;
+    overflow = end;
+
+    // in place permutation, every swap drops one context into its final bucket
+    for ( bucket = 0; bucket < bucketSize; ++bucket ) {
+        end = ( bucket + 1 < bucketSize ) ? buckets[ bucket + 1 ].start : tail;
+        while ( buckets[ bucket ].next < end ) {
+            index = buckets[ bucket ].next;
+            target = contexts[ index ] ? swcFsmBatchBucketOf( contexts[ index ], buckets, &bucketSize ) : DEF_SWC_FSM_BATCH_BUCKETS;
+
+            if ( target == bucket ) {
+                ++( buckets[ bucket ].next );
+            } else if ( target < DEF_SWC_FSM_BATCH_BUCKETS ) {
+                context = contexts[ index ];
+                contexts[ index ] = contexts[ buckets[ target ].next ];
+                contexts[ ( buckets[ target ].next )++ ] = context;
+            } else {
+                context = contexts[ index ];
+                contexts[ index ] = contexts[ overflow ];
+                contexts[ overflow++ ] = context;
+            }
+        }
+    }
+
+    for ( bucket = 0; bucket < bucketSize; ++bucket ) {
+        end = buckets[ bucket ].next;
+        if ( buckets[ bucket ].routineBatch ) {
+#ifdef FSM_DEFERRED
+            for ( index = buckets[ bucket ].start; index < end; ++index ) {
+                swcFsmDeferEnter( contexts[ index ] );
+            }
+#endif
+            if ( ( *( buckets[ bucket ].routineBatch ) )( ( void** )&( contexts[ buckets[ bucket ].start ] ), end - buckets[ bucket ].start ) != FSM_OK ) {
+                context = contexts[ buckets[ bucket ].start ];
+                FSM_ERROR_HANDLER(context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+            }
+#ifdef FSM_DEFERRED
+            for ( index = buckets[ bucket ].start; index < end; ++index ) {
+                swcFsmDeferLeave( contexts[ index ] );
+            }
+#endif
+        } else {
+            for ( index = buckets[ bucket ].start; index < end; ++index ) {
+                swcFsmBatchRunState( contexts[ index ] );
+            }
+        }
+    }
+
+    for ( index = tail; index < count; ++index ) {
+        if ( contexts[ index ] )    swcFsmBatchRunState( contexts[ index ] );
+    }
+}
+#endif
+
+FSM_FUNC
+void swcFsmExit( SWCFsmContext* context )
+{
+    SWCFsmStateItem* state = NULL;
+
+    UNUSED( state );
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return;
+    }
+
+    state = swcFsmGetCurStateItem( context );
+
+#ifdef FSM_DEFERRED
+    // requests made from here on are taken at once
+    if ( context->fsmDeferQueue ) {
+        context->fsmDeferQueue->head = context->fsmDeferQueue->tail;
+    }
+#endif
+
+#ifdef FSM_HIERARCHY
+    // leave the superstates too
+    if ( state )    swcFsmExitPath( ( fsm_index_t )( state - context->fsmStateList ), 0, 0U, context->curState, DEF_SWC_FSM_STATE_INVALID, context, context );
+#else
+    if ( state && state->exit ) {
+        if ( ( *( state->exit ) )( state ) != FSM_OK ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+#endif
+
+    if ( context->fsmExit ) {
+        if ( ( *( context->fsmExit ) )( context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+
+#ifdef FSM_ASYNC
+    // a transition in flight is dropped, its pending action is not called again and its frame is freed
+    swcFsmFrameDrop( &( context->fsmPending.frame ) );
+    context->fsmPending.phase = DEF_SWC_FSM_PENDING_NONE;
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+    swcFsmWheelRemove( context );
+#endif
+}
+
+FSM_FUNC
+fsm_error_t swcFsmGoBack( fsm_bool_t bForce, SWCFsmContext* context )
+{
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    return swcFsmTransTo( swcFsmGetPreState( context ), bForce, context );
+}
+
+#ifdef FSM_STATS
+FSM_INLINE
+void swcFsmStatsTake( uint64_t* dst, uint64_t* src, fsm_bool_t bReset )
+{
+    *dst = FSM_ATOMIC_LOAD_RELAXED( src );
+    if ( bReset )   FSM_ATOMIC_STORE_RELAXED( src, 0U );
+}
+
+FSM_INLINE
+void swcFsmStatsTakeLatency( SWCFsmLatency* dst, SWCFsmLatency* src, fsm_bool_t bReset )
+{
+    uint32_t bucket = 0;
+
+    swcFsmStatsTake( &( dst->count ), &( src->count ), bReset );
+    swcFsmStatsTake( &( dst->total ), &( src->total ), bReset );
+    for ( bucket = 0; bucket < DEF_SWC_FSM_STATS_BUCKETS; ++bucket ) {
+        dst->histogram[ bucket ] = FSM_ATOMIC_LOAD_RELAXED( &( src->histogram[ bucket ] ) );
+        if ( bReset )   FSM_ATOMIC_STORE_RELAXED( &( src->histogram[ bucket ] ), 0U );
+    }
+}
+
+/**
+ * copy the counters of context into states ( fsmStateSize entries ) and trans ( fsmTransitionSize entries ),
+ * either may be NULL, bReset clears what was copied. counts updated during the copy may be split
+ * between this snapshot and the next one, or lost with bReset.
+ */
+FSM_FUNC
+fsm_error_t swcFsmStatsSnapshot( SWCFsmStateStats* states, SWCFsmTransStats* trans, fsm_bool_t bReset, SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+    uint32_t kind = 0;
+
+    if ( !context || !( context->fsmStateStats ) || !( context->fsmTransStats ) ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    for ( index = 0; states && ( index < context->fsmStateSize ); ++index ) {
+        for ( kind = 0; kind < DEF_SWC_FSM_ACTION_COUNT; ++kind ) {
+            swcFsmStatsTakeLatency( &( states[ index ].action[ kind ] ), &( context->fsmStateStats[ index ].action[ kind ] ), bReset );
+        }
+    }
+
+    for ( index = 0; trans && ( index < context->fsmTransitionSize ); ++index ) {
+        swcFsmStatsTake( &( trans[ index ].attempts ), &( context->fsmTransStats[ index ].attempts ), bReset );
+        swcFsmStatsTake( &( trans[ index ].rejected ), &( context->fsmTransStats[ index ].rejected ), bReset );
+        swcFsmStatsTake( &( trans[ index ].succeeded ), &( context->fsmTransStats[ index ].succeeded ), bReset );
+        swcFsmStatsTakeLatency( &( trans[ index ].check ), &( context->fsmTransStats[ index ].check ), bReset );
+    }
+
+    return FSM_OK;
+}
+
+FSM_FUNC
+void swcFsmStatsReset( SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+    uint32_t kind = 0;
+    uint64_t count = 0;
+    SWCFsmLatency latency;
+
+    if ( !context || !( context->fsmStateStats ) || !( context->fsmTransStats ) )  return;
+
+    for ( index = 0; index < context->fsmStateSize; ++index ) {
+        for ( kind = 0; kind < DEF_SWC_FSM_ACTION_COUNT; ++kind ) {
+            swcFsmStatsTakeLatency( &latency, &( context->fsmStateStats[ index ].action[ kind ] ), DEF_FSM_TRUE );
+        }
+    }
+
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        swcFsmStatsTake( &count, &( context->fsmTransStats[ index ].attempts ), DEF_FSM_TRUE );
+        swcFsmStatsTake( &count, &( context->fsmTransStats[ index ].rejected ), DEF_FSM_TRUE );
+        swcFsmStatsTake( &count, &( context->fsmTransStats[ index ].succeeded ), DEF_FSM_TRUE );
+        swcFsmStatsTakeLatency( &latency, &( context->fsmTransStats[ index ].check ), DEF_FSM_TRUE );
+    }
+}
+
+/**
+ * upper bound in ns of the bucket holding the given permille of the samples, 0 without samples.
+ */
+FSM_FUNC
+uint64_t swcFsmStatsPercentile( const SWCFsmLatency* latency, uint32_t permille )
+{
+    uint64_t count = 0;
+    uint64_t rank = 0;
+    uint32_t bucket = 0;
+
+    if ( !latency || !( latency->count ) )  return 0;
+
+    rank = ( latency->count * permille + 999U ) / 1000U;
+    if ( rank == 0 )    rank = 1;
+
+    for ( bucket = 0; bucket < DEF_SWC_FSM_STATS_BUCKETS; ++bucket ) {
+        count += latency->histogram[ bucket ];
+        if ( count >= rank )    break;
+    }
+    if ( bucket >= DEF_SWC_FSM_STATS_BUCKETS )  bucket = DEF_SWC_FSM_STATS_BUCKETS - 1U;
+
+    return ( bucket == 0 ) ? 0U : ( 1ULL << bucket );
+}
+#endif
+
+#ifdef FSM_TRACE
+/**
+ * ring NULL stops tracing the context. swcFsmTransTo and swcFsmRoutine of a traced context
+ * append one record each, transitions and routines of pooled instances are not traced.
+ */
+FSM_FUNC
+fsm_error_t swcFsmTraceAttach( SWCFsmContext* context, SWCFsmTraceRing* ring )
+{
+    if ( !context ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context->fsmTraceExit = 0;
+    context->fsmTraceEntry = 0;
+    context->fsmTrace = ring;
+
+    return FSM_OK;
+}
+
+/**
+ * copy up to size of the newest complete records, oldest first. safe while writers run,
+ * records overwritten during the copy are skipped. returns the number of records copied.
+ */
+FSM_FUNC
+fsm_index_t swcFsmTraceDump( SWCFsmTraceRing* ring, SWCFsmTraceRecord* records, fsm_index_t size )
+{
+    SWCFsmTraceRecord* record = NULL;
+    uint32_t head = 0;
+    uint32_t sequence = 0;
+    uint32_t count = 0;
+    fsm_index_t copied = 0;
+
+    if ( !ring || !records )    return 0;
+
+    head = FSM_ATOMIC_LOAD( &( ring->head ) );
+    count = ( head > ring->mask + 1U ) ? ring->mask + 1U : head;
+    if ( count > size )     count = size;
+
+    for ( sequence = head - count + 1U; sequence != head + 1U; ++sequence ) {
+        record = &( ring->records[ ( sequence - 1U ) & ring->mask ] );
+        if ( FSM_ATOMIC_LOAD( &( record->sequence ) ) != sequence )     continue;
+
+        records[ copied ] = *record;
+        FSM_ATOMIC_FENCE_ACQUIRE();
+        if ( FSM_ATOMIC_LOAD_RELAXED( &( record->sequence ) ) != sequence )     continue;
+        records[ copied ].sequence = sequence;
+        ++copied;
+    }
+
+    return copied;
+}
+
+/**
+ * one line of text for a record, snprintf semantics.
+ */
+FSM_FUNC
+int swcFsmTraceDecode( const SWCFsmTraceRecord* record, char* buffer, size_t size )
+{
+    if ( !record || !buffer )   return -1;
+
+    if ( record->kind == DEF_SWC_FSM_TRACE_ROUTINE ) {
+        return snprintf( buffer, size, "#%u t=%llu ctx=%u routine %u -> %u result=%d time=%u",
+            record->sequence, ( unsigned long long )( record->timestamp ), record->contextID,
+            record->fromState, record->toState, record->result, record->entryTime );
+    }
+
+    return snprintf( buffer, size, "#%u t=%llu ctx=%u trans %u -> %u%s result=%d exit=%u entry=%u",
+        record->sequence, ( unsigned long long )( record->timestamp ), record->contextID,
+        record->fromState, record->toState, record->force ? " force" : "", record->result,
+        record->exitTime, record->entryTime );
+}
+#endif
+
+#ifdef FSM_RECORD
+/**
+ * recorder NULL stops recording the context. a start record carries the state recording starts from,
+ * then every swcFsmTransTo, swcFsmHandleEvent, swcFsmRouteTo hop, applied deferred request and
+ * swcFsmResume of the context appends one record with its outcome. transitions of pooled instances are not recorded.
+ */
+FSM_FUNC
+fsm_error_t swcFsmRecordAttach( SWCFsmContext* context, SWCFsmRecorder* recorder )
+{
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context->fsmRecorder = recorder;
+    if ( recorder )     swcFsmRecordWrite( DEF_SWC_FSM_RECORD_START, DEF_SWC_FSM_STATE_INVALID, FSM_OK, context );
+
+    return FSM_OK;
+}
+
+// records appended so far, valid for replay once the recorded contexts are idle
+FSM_FUNC
+uint32_t swcFsmRecordCount( SWCFsmRecorder* recorder )
+{
+    uint32_t head = 0;
+
+    if ( !recorder )    return 0;
+
+    head = FSM_ATOMIC_LOAD( &( recorder->head ) );
+
+    return ( head > recorder->capacity ) ? recorder->capacity : head;
+}
+
+// replay states the records of context go to, the replay starts from the start record of the stream
+FSM_FUNC
+fsm_error_t swcFsmReplayBind( SWCFsmContext* context, SWCFsmReplayState* replay )
+{
+    if ( !context || !replay ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    swcFsmEnsureIndex( context );
+
+    replay->context     = context;
+    replay->curState    = DEF_SWC_FSM_STATE_INVALID;
+    replay->curSlot     = DEF_SWC_FSM_INDEX_INVALID;
+    replay->records     = 0;
+    replay->mismatches  = 0;
+
+    return FSM_OK;
+}
+
+/**
+ * swcFsmTransCore over the tables with every callback stubbed from the record: the guards by
+ * DEF_SWC_FSM_RECORD_REJECTED and the actions by the recorded error. an event record looks up the
+ * event matrix of the bound table instead. returns the error the request gives on these tables.
+ */
+FSM_INLINE
+fsm_error_t swcFsmReplayStep( const SWCFsmRecord* record, SWCFsmReplayState* replay )
+{
+    SWCFsmContext* context = replay->context;
+    fsm_error_t recorded = ( fsm_error_t )record->error;
+    fsm_state_t nextState = record->state;
+    fsm_index_t nextSlot = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t lcaLevel = 0;
+    fsm_bool_t bTransition = DEF_FSM_FALSE;
+#ifdef FSM_EVENT_TABLE
+    SWCFsmEventEdge* edge = NULL;
+#endif
+
+    if ( record->flags & DEF_SWC_FSM_RECORD_START ) {
+        replay->curState    = record->nextState;
+        replay->curSlot     = swcFsmGetStateSlot( record->nextState, context );
+        return recorded;
+    }
+
+    if ( record->flags & DEF_SWC_FSM_RECORD_RESUME ) {
+        // the row was taken by the request that pended
+        nextSlot = swcFsmGetStateSlot( record->state, context );
+        bTransition = DEF_FSM_TRUE;
+    } else if ( record->flags & DEF_SWC_FSM_RECORD_EVENT ) {
+        if ( recorded == FSM_ERR_BUSY )     return FSM_ERR_BUSY;
+#ifdef FSM_EVENT_TABLE
+        edge = swcFsmFindEventEdge( ( fsm_event_t )record->state, replay->curSlot, context );
+        if ( edge ) {
+            if ( record->flags & DEF_SWC_FSM_RECORD_REJECTED )  return FSM_ERR_CHECK_FAILED;
+            nextState = context->fsmEventTable->fsmEventTransTable[ edge->transIndex ].nextState;
+            nextSlot = edge->nextSlot;
+            bTransition = DEF_FSM_TRUE;
+        }
+#endif
+    } else if ( record->state == DEF_SWC_FSM_STATE_INVALID ) {
+        return FSM_ERR_INVALID_STATE;
+    } else if ( recorded == FSM_ERR_BUSY ) {
+        // a transition of the context was in flight, the tables were not consulted
+        return FSM_ERR_BUSY;
+    } else if ( record->flags & DEF_SWC_FSM_RECORD_FORCE ) {
+        nextSlot = swcFsmGetStateSlot( record->state, context );
+        bTransition = swcFsmIsTarget( record->state, nextSlot, context );
+    } else if ( replay->curState == record->state ) {
+        return FSM_OK;
+    } else if ( swcFsmFindTransItem( record->state, replay->curState, replay->curSlot, &nextSlot, &lcaLevel, context ) ) {
+        if ( record->flags & DEF_SWC_FSM_RECORD_REJECTED )  return FSM_ERR_CHECK_FAILED;
+        bTransition = DEF_FSM_TRUE;
+    }
+
+    if ( bTransition == DEF_FSM_FALSE )     return FSM_ERR_NO_TRANSITION;
+
+    // the actions ran in the recording, they commit the state only when the request succeeded
+    if ( recorded == FSM_OK ) {
+        replay->curState    = nextState;
+        replay->curSlot     = nextSlot;
+    }
+
+    return recorded;
+}
+
+/**
+ * feed count records back through the tables of the bound replay states, indexed by contextID, and
+ * check that every request gives the recorded error and leaves the recorded state. records of
+ * contexts without a bound state are skipped, as are those of other shards: a shard takes the
+ * contexts with contextID % shardCount == shard, so shardCount threads replay one stream in
+ * parallel without sharing a replay state. a mismatch is counted and the replay goes on from the
+ * recorded state. returns the mismatches of the shard.
+ */
+FSM_FUNC
+uint32_t swcFsmReplay( const SWCFsmRecord* records, uint32_t count, uint32_t shard, uint32_t shardCount, SWCFsmReplayState* states, fsm_index_t size )
+{
+    const SWCFsmRecord* record = NULL;
+    SWCFsmReplayState* replay = NULL;
+    uint32_t index = 0;
+    uint32_t mismatches = 0;
+
+    if ( !records || !states )  return 0;
+    if ( shardCount == 0 )      shardCount = 1;
+
+    for ( index = 0; index < count; ++index ) {
+        record = &( records[ index ] );
+        if ( ( record->contextID >= size ) || ( ( record->contextID % shardCount ) != shard ) )   continue;
+
+        replay = &( states[ record->contextID ] );
+        if ( !( replay->context ) )     continue;
+
+        ++( replay->records );
+        if ( ( swcFsmReplayStep( record, replay ) != ( fsm_error_t )record->error ) || ( replay->curState != record->nextState ) ) {
+            ++( replay->mismatches );
+            ++mismatches;
+            replay->curState    = record->nextState;
+            replay->curSlot     = swcFsmGetStateSlot( record->nextState, replay->context );
+        }
+    }
+
+    return mismatches;
+}
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+/**
+ * schedules fsmRoutine every fsmRoutineInterval ms, the current state routine every routineInterval ms
+ * and the timeout of the current state, restarted by every transition. a zero interval is not scheduled.
+ * swcFsmRoutine is not needed for contexts on a wheel.
+ */
+FSM_FUNC
+fsm_error_t swcFsmWheelAdd( SWCFsmContext* context, SWCFsmTimerWheel* wheel )
+{
+    uint32_t kind = 0;
+
+    if ( !context || !wheel || !( context->fsmTimers ) ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( context->fsmTimerWheel ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_BUSY, context->curState, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_BUSY;
+    }
+
+    for ( kind = 0; kind < DEF_SWC_FSM_TIMER_KINDS; ++kind ) {
+        context->fsmTimers[ kind ].next = NULL;
+        context->fsmTimers[ kind ].pprev = NULL;
+        context->fsmTimers[ kind ].context = context;
+        context->fsmTimers[ kind ].kind = kind;
+    }
+
+    context->fsmTimerWheel = wheel;
+    swcFsmTimerArm( &( context->fsmTimers[ DEF_SWC_FSM_TIMER_ROUTINE ] ), context->fsmRoutine ? context->fsmRoutineInterval : 0U, wheel );
+    swcFsmWheelArmState( swcFsmGetCurStateItem( context ), context );
+
+    return FSM_OK;
+}
+
+FSM_INLINE
+void swcFsmTimerExpire( SWCFsmTimer* timer, SWCFsmTimerWheel* wheel )
+{
+    SWCFsmContext* context = timer->context;
+    SWCFsmStateItem* state = swcFsmGetCurStateItem( context );
+    fsm_state_t curState = context->curState;
+
+#ifdef FSM_ASYNC
+    // routine timers of a context in the middle of a transition resume it, the timeout of the state it leaves is dropped
+    if ( FSM_IN_TRANSITION( context ) ) {
+        if ( timer->kind == DEF_SWC_FSM_TIMER_TIMEOUT )     return;
+
+        FSM_DEFER_ENTER( context );
+        swcFsmResume( context );
+        FSM_DEFER_LEAVE( context );
+
+        // a failed action ends the transition in the state it left, whose timers are gone by now
+        if ( !FSM_IN_TRANSITION( context ) && ( context->curState == curState ) && ( context->fsmTimerWheel == wheel ) ) {
+            swcFsmWheelArmState( state, context );
+        }
+
+        // a completed transition has armed the state timers of the new state
+        if ( !( timer->pprev ) && ( context->fsmTimerWheel == wheel ) ) {
+            if ( timer->kind == DEF_SWC_FSM_TIMER_ROUTINE ) {
+                swcFsmTimerArm( timer, context->fsmRoutineInterval, wheel );
+            } else if ( FSM_IN_TRANSITION( context ) && state ) {
+                swcFsmTimerArm( timer, state->routineInterval, wheel );
+            }
+        }
+        return;
+    }
+#endif
+
+    if ( timer->kind == DEF_SWC_FSM_TIMER_ROUTINE ) {
+        FSM_DEFER_ENTER( context );
+        if ( ( *( context->fsmRoutine ) )( context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER(context, FSM_ERR_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+        }
+        FSM_DEFER_LEAVE( context );
+        // the routine may have removed the context
+        if ( !( timer->pprev ) && ( context->fsmTimerWheel == wheel ) ) {
+            swcFsmTimerArm( timer, context->fsmRoutineInterval, wheel );
+        }
+    } else if ( timer->kind == DEF_SWC_FSM_TIMER_STATE ) {
+        FSM_DEFER_ENTER( context );
+        if ( state && state->routine ) {
+            if ( swcFsmCallAction( state->routine, DEF_SWC_FSM_ACTION_ROUTINE, state, context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER(context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
+            }
+        }
+        FSM_DEFER_LEAVE( context );
+        // a transition from the routine has already armed the next state
+        if ( !( timer->pprev ) && ( context->fsmTimerWheel == wheel ) && ( context->curState == curState ) && state ) {
+            swcFsmTimerArm( timer, state->routineInterval, wheel );
+        }
+    } else if ( state ) {
+        // errors are reported by swcFsmTransTo, the context stays in its state without a new timeout
+        swcFsmTransTo( state->timeoutState, DEF_FSM_FALSE, context );
+    }
+}
+
+/**
+ * move the wheel clock forward by elapsed ms and run every timer due on the way, in expiry order.
+ * empty stretches are skipped through the slot bitmaps, idle contexts cost nothing.
+ * returns the number of timers run.
+ */
+FSM_FUNC
+uint32_t swcFsmWheelAdvance( SWCFsmTimerWheel* wheel, uint32_t elapsed )
+{
+    SWCFsmTimer* pending = NULL;
+    SWCFsmTimer* timer = NULL;
+    uint64_t target = 0;
+    uint64_t next = 0;
+    uint64_t bits = 0;
+    uint32_t index = 0;
+    uint32_t level = 0;
+    uint32_t fired = 0;
+
+    if ( !wheel )   return 0;
+
+    target = wheel->now + elapsed;
+    while ( wheel->armed && ( wheel->now < target ) ) {
+        index = ( uint32_t )( wheel->now & DEF_SWC_FSM_WHEEL_MASK );
+        // next busy slot of this lap, or the lap end where the upper levels cascade
+        bits = ( index == DEF_SWC_FSM_WHEEL_MASK ) ? 0U : ( wheel->occupied[ 0 ] & ( ~0ULL << ( index + 1U ) ) );
+        next = wheel->now - index + ( bits ? ( uint64_t )FSM_CTZ64( bits ) : DEF_SWC_FSM_WHEEL_SLOTS );
+        if ( next > target )    break;
+        wheel->now = next;
+
+        if ( ( next & DEF_SWC_FSM_WHEEL_MASK ) == 0U ) {
+            // highest level finishing its lap goes first so its timers can fall through the ones below
+            for ( level = 1; ( level + 1U < DEF_SWC_FSM_WHEEL_LEVELS ) && ( ( ( next >> ( DEF_SWC_FSM_WHEEL_BITS * level ) ) & DEF_SWC_FSM_WHEEL_MASK ) == 0U ); ++level );
+            for ( ; level > 0U; --level ) {
+                index = ( level << DEF_SWC_FSM_WHEEL_BITS ) + ( uint32_t )( ( next >> ( DEF_SWC_FSM_WHEEL_BITS * level ) ) & DEF_SWC_FSM_WHEEL_MASK );
+                while ( ( timer = wheel->slots[ index ] ) != NULL ) {
+                    swcFsmTimerUnlink( timer, wheel );
+                    swcFsmTimerInsert( timer, wheel );
+                }
+            }
+        }
+
+        // detach the slot, callbacks may disarm timers still waiting in it
+        index = ( uint32_t )( next & DEF_SWC_FSM_WHEEL_MASK );
+        pending = wheel->slots[ index ];
+        if ( !pending )     continue;
+        wheel->slots[ index ] = NULL;
+        wheel->occupied[ 0 ] &= ~( 1ULL << index );
+        pending->pprev = &pending;
+
+        while ( ( timer = pending ) != NULL ) {
+            swcFsmTimerUnlink( timer, wheel );
+            if ( timer->expire > wheel->now ) {
+                swcFsmTimerInsert( timer, wheel );
+                continue;
+            }
+            swcFsmTimerExpire( timer, wheel );
+            ++fired;
+        }
+    }
+    wheel->now = target;
+
+    return fired;
+}
+
+/**
+ * ms until swcFsmWheelAdvance may run something, DEF_SWC_FSM_WHEEL_IDLE when nothing is armed.
+ * exact within the current 64 ms lap, otherwise the lap end, where timers of the upper levels move down.
+ */
+FSM_FUNC
+uint32_t swcFsmWheelNextDue( SWCFsmTimerWheel* wheel )
+{
+    uint32_t index = 0;
+    uint64_t bits = 0;
+
+    if ( !wheel || !( wheel->armed ) )  return DEF_SWC_FSM_WHEEL_IDLE;
+
+    index = ( uint32_t )( wheel->now & DEF_SWC_FSM_WHEEL_MASK );
+    bits = ( index == DEF_SWC_FSM_WHEEL_MASK ) ? 0U : ( wheel->occupied[ 0 ] & ( ~0ULL << ( index + 1U ) ) );
+
+    return ( bits ? ( uint32_t )FSM_CTZ64( bits ) : DEF_SWC_FSM_WHEEL_SLOTS ) - index;
+}
+#endif
+
+#ifdef FSM_EVENT_QUEUE
+/**
+ * cell i of the ring serves positions i, i + size, i + 2 * size ...; its sequence is stored relative
+ * to the lap base ( pos & ~mask ), so a zero filled ring is ready without init:
+ * base means free, base + 1 means filled, base + size means free for the next lap.
+ */
+FSM_FUNC
+fsm_error_t swcFsmPostEvent( SWCFsmContext* context, fsm_event_t event, void* payload )
+{
+    SWCFsmEventQueue* queue = NULL;
+    SWCFsmEventCell* cell = NULL;
+    uint32_t pos = 0;
+    uint32_t sequence = 0;
+    int32_t diff = 0;
+
+    if ( !context || !( context->fsmEventQueue ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    queue = context->fsmEventQueue;
+    pos = FSM_ATOMIC_LOAD_RELAXED( &( queue->enqueuePos ) );
+
+    for ( ;; ) {
+        cell = &( queue->cells[ pos & queue->mask ] );
+        sequence = FSM_ATOMIC_LOAD( &( cell->sequence ) );
+        diff = ( int32_t )( sequence - ( pos & ~( queue->mask ) ) );
+
+        if ( diff == 0 ) {
+            // claim pos, pos is reloaded when another producer won
+            if ( FSM_ATOMIC_CAS( &( queue->enqueuePos ), &pos, pos + 1U ) )  break;
+        } else if ( diff < 0 ) {
+            // cell still holds the event of the previous lap
+            FSM_ERROR_HANDLER( context, FSM_ERR_QUEUE_FULL, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_QUEUE_FULL;
+        } else {
+            pos = FSM_ATOMIC_LOAD_RELAXED( &( queue->enqueuePos ) );
+        }
+    }
+
+    cell->event     = event;
+    cell->payload   = payload;
+    FSM_ATOMIC_STORE( &( cell->sequence ), ( pos & ~( queue->mask ) ) + 1U );
+
+    return FSM_OK;
+}
+
+FSM_INLINE
+fsm_bool_t swcFsmTakeEvent( SWCFsmEventQueue* queue, fsm_event_t* event, void** payload )
+{
+    uint32_t pos = queue->dequeuePos;
+    SWCFsmEventCell* cell = &( queue->cells[ pos & queue->mask ] );
+
+    if ( FSM_ATOMIC_LOAD( &( cell->sequence ) ) != ( pos & ~( queue->mask ) ) + 1U )   return DEF_FSM_FALSE;
+
+    *event      = cell->event;
+    *payload    = cell->payload;
+    FSM_ATOMIC_STORE( &( cell->sequence ), ( pos & ~( queue->mask ) ) + queue->mask + 1U );
+    queue->dequeuePos = pos + 1U;
+
+    return DEF_FSM_TRUE;
+}
+
+/**
+ * run-to-completion dispatch, call from one thread per context: every event takes the transition
+ * bound to it by the event table, if any, or is handed to the event action of the current state,
+ * and is fully handled, transitions included, before the next
+ * one is taken. at most one ring size of events is handled per call so busy producers can not
+ * starve the caller. returns the number of events handled.
+ */
+FSM_FUNC
+uint32_t swcFsmDispatch( SWCFsmContext* context )
+{
+    uint32_t count = 0;
+    fsm_event_t event = DEF_SWC_FSM_EVENT_INVALID;
+    void* payload = NULL;
+    SWCFsmStateItem* state = NULL;
+
+    if ( !context || !( context->fsmEventQueue ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return 0;
+    }
+
+    // events stay queued while a transition is in flight
+    while ( ( count <= context->fsmEventQueue->mask ) && !FSM_IN_TRANSITION( context ) && \
+        swcFsmTakeEvent( context->fsmEventQueue, &event, &payload ) ) {
+        ++count;
+
+#ifdef FSM_EVENT_TABLE
+        if ( swcFsmFindEventEdge( event, context->curSlot, context ) ) {
+            swcFsmHandleEvent( event, context );
+            continue;
+        }
+#endif
+
+        state = swcFsmGetCurStateItem( context );
+
+        // transitions requested by the event action complete before the next event
+        FSM_DEFER_ENTER( context );
+        if ( state && state->event ) {
+            if ( ( *( state->event ) )( event, payload, context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_EVENT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            }
+        }
+        FSM_DEFER_LEAVE( context );
+    }
+
+    return count;
+}
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+/**
+ * errors of context go to queue from now on, NULL calls fsmErrorHandler at once again. errors of pooled
+ * instances of context share its queue and gates, the drain rebuilds their owner from pool and instance.
+ */
+FSM_FUNC
+fsm_error_t swcFsmErrorQueueAttach( SWCFsmContext* context, SWCFsmErrorQueue* queue )
+{
+    if ( !context || ( queue && !( context->fsmErrorGates ) ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context->fsmErrorQueue = queue;
+
+    return FSM_OK;
+}
+
+/**
+ * take up to size records off queue and hand each to the fsmErrorHandler of its context, once per
+ * record, with the SWCFsmInstanceRef of a pooled instance as the last argument as in the failing
+ * call. count tells how many occurrences a record stands for. records, when not NULL, receives a
+ * copy of each. one thread drains a queue at a time, a background thread or a periodic call.
+ * returns the number of records taken.
+ */
+FSM_FUNC
+uint32_t swcFsmErrorDrain( SWCFsmErrorRecord* records, uint32_t size, SWCFsmErrorQueue* queue )
+{
+    SWCFsmErrorRecord* record = NULL;
+    SWCFsmErrorGate* gate = NULL;
+    SWCFsmContext* context = NULL;
+    void* owner = NULL;
+#ifdef FSM_INSTANCE_POOL
+    SWCFsmInstanceRef ref;
+#endif
+    uint32_t pos = 0;
+    uint32_t taken = 0;
+
+    if ( !queue )   return 0;
+
+    for ( taken = 0; taken < size; ++taken ) {
+        pos = queue->dequeuePos;
+        record = &( queue->records[ pos & queue->mask ] );
+        if ( FSM_ATOMIC_LOAD( &( record->sequence ) ) != ( pos & ~( queue->mask ) ) + 1U )    break;
+
+        context = record->context;
+        gate = &( context->fsmErrorGates[ DEF_SWC_FSM_ERROR_GATE( record->error ) ] );
+        // occurrences after the exchange see the gate still queued and wait for the next record
+        record->count = FSM_ATOMIC_EXCHANGE( &( gate->count ), 0U );
+        FSM_ATOMIC_STORE( &( gate->queued ), 0U );
+
+        if ( records )  records[ taken ] = *record;
+        owner = context;
+#ifdef FSM_INSTANCE_POOL
+        // the handler gets the same owner as it would have in the failing call
+        if ( record->pool ) {
+            ref.pool        = record->pool;
+            ref.instance    = record->instance;
+            owner           = &ref;
+        }
+#endif
+        if ( context->fsmErrorHandler ) {
+            context->fsmErrorHandler( ( fsm_error_t )record->error, record->curState, record->nextState, owner );
+        }
+        FSM_ERROR_PRINT( ( fsm_error_t )record->error, record->curState, record->nextState );
+
+        FSM_ATOMIC_STORE( &( record->sequence ), ( pos & ~( queue->mask ) ) + queue->mask + 1U );
+        queue->dequeuePos = pos + 1U;
+    }
+
+    return taken;
+}
+#endif
+
+#ifdef FSM_REGISTRY
+/**
+ * publish context under its fsmContextID. registering it again is a no-op, an ID held by another
+ * context gives FSM_ERR_ID_IN_USE and an ID beyond DEF_SWC_FSM_REGISTRY_SIZE FSM_ERR_NO_MEMORY.
+ * add and remove of one ID are expected from one thread at a time, lookups may run anywhere.
+ */
+FSM_FUNC
+fsm_error_t swcFsmRegistryAdd( SWCFsmContext* context, SWCFsmRegistry* registry )
+{
+    SWCFsmContext* expected = NULL;
+    uint32_t id = 0;
+
+    if ( !context || !registry ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    id = context->fsmContextID;
+    if ( id >= DEF_SWC_FSM_REGISTRY_SIZE ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_MEMORY, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NO_MEMORY;
+    }
+
+    if ( !FSM_ATOMIC_CAS_STRONG( &( registry->contexts[ id ] ), &expected, context ) ) {
+        if ( expected == context )  return FSM_OK;
+        FSM_ERROR_HANDLER( context, FSM_ERR_ID_IN_USE, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_ID_IN_USE;
+    }
+
+    FSM_ATOMIC_FETCH_OR( &( registry->occupied[ id >> 6 ] ), 1ULL << ( id & 63U ) );
+    FSM_ATOMIC_FETCH_ADD( &( registry->count ), 1U );
+
+    return FSM_OK;
+}
+
+// take context out of the registry, a context that is not registered is left alone
+FSM_FUNC
+fsm_error_t swcFsmRegistryRemove( SWCFsmContext* context, SWCFsmRegistry* registry )
+{
+    SWCFsmContext* expected = context;
+    uint32_t id = 0;
+
+    if ( !context || !registry ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    id = context->fsmContextID;
+    if ( id >= DEF_SWC_FSM_REGISTRY_SIZE )  return FSM_OK;
+
+    if ( !FSM_ATOMIC_CAS_STRONG( &( registry->contexts[ id ] ), &expected, NULL ) ) {
+        if ( expected == NULL )     return FSM_OK;
+        FSM_ERROR_HANDLER( context, FSM_ERR_ID_IN_USE, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_ID_IN_USE;
+    }
+
+    FSM_ATOMIC_FETCH_AND( &( registry->occupied[ id >> 6 ] ), ~( 1ULL << ( id & 63U ) ) );
+    FSM_ATOMIC_FETCH_ADD( &( registry->count ), ( uint32_t )-1 );
+
+    return FSM_OK;
+}
+
+/**
+ * visit the registered contexts in ID order until visit returns DEF_FSM_FALSE. contexts added or
+ * removed during the walk may or may not be seen. returns the number of contexts visited.
+ */
+FSM_FUNC
+uint32_t swcFsmRegistryForEach( ptrSWCFsmRegistryVisit visit, void* arg, SWCFsmRegistry* registry )
+{
+    SWCFsmContext* context = NULL;
+    uint64_t bits = 0;
+    uint32_t word = 0;
+    uint32_t visited = 0;
+
+    if ( !visit || !registry )  return 0;
+
+    for ( word = 0; word < DEF_SWC_FSM_REGISTRY_SIZE / 64U; ++word ) {
+        bits = FSM_ATOMIC_LOAD( &( registry->occupied[ word ] ) );
+        while ( bits ) {
+            context = FSM_ATOMIC_LOAD( &( registry->contexts[ ( word << 6 ) + ( uint32_t )FSM_CTZ64( bits ) ] ) );
+            bits &= bits - 1U;
+            if ( !context )     continue;
+
+            ++visited;
+            if ( ( *visit )( context, arg ) == DEF_FSM_FALSE )   return visited;
+        }
+    }
+
+    return visited;
+}
+
+#ifdef FSM_EVENT_QUEUE
+// swcFsmPostEvent to the context registered under id, FSM_ERR_NULL_CONTEXT when there is none
+FSM_FUNC
+fsm_error_t swcFsmRegistryPostEvent( fsm_context_id_t id, fsm_event_t event, void* payload, SWCFsmRegistry* registry )
+{
+    SWCFsmContext* context = ( registry ) ? swcFsmRegistryFind( id, registry ) : NULL;
+
+    if ( !context )     return FSM_ERR_NULL_CONTEXT;
+
+    return swcFsmPostEvent( context, event, payload );
+}
+#endif
+#endif
+
+#ifdef FSM_BUILDER
+// next zero filled section of the arena, the layout is fixed by DEF_SWC_FSM_BUILDER_ARENA_SIZE
+FSM_INLINE
+void* swcFsmBuilderTake( uint64_t bytes, SWCFsmBuilder* builder )
+{
+    uint8_t* section = builder->arena + builder->used;
+    uint64_t index = 0;
+
+    bytes = DEF_SWC_FSM_BUILDER_ALIGN( bytes );
+    for ( index = 0; index < bytes; ++index ) {
+        section[ index ] = 0;
+    }
+    builder->used += bytes;
+
+    return section;
+}
+
+/**
+ * lay out a context for up to stateCapacity states and transCapacity transitions in arena, which must
+ * hold DEF_SWC_FSM_BUILDER_ARENA_SIZE( stateCapacity, transCapacity ) bytes. the arena is not
+ * allocated or freed here, it may be static, come from a fixed block pool or from the heap.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBuilderInit( void* arena, uint64_t arenaSize, fsm_index_t stateCapacity, fsm_index_t transCapacity, SWCFsmBuilder* builder )
+{
+    uintptr_t base = 0;
+    SWCFsmContext* context = NULL;
+
+    if ( !builder || !arena ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    builder->context = NULL;
+
+    if ( ( stateCapacity == 0 ) || ( stateCapacity >= DEF_SWC_FSM_STATE_INVALID ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_TOO_MANY_STATES, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_TOO_MANY_STATES;
+    }
+
+    if ( arenaSize < DEF_SWC_FSM_BUILDER_ARENA_SIZE( stateCapacity, transCapacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_MEMORY, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NO_MEMORY;
+    }
+
+    base = ( ( uintptr_t )arena + DEF_SWC_FSM_CACHE_LINE - 1U ) & ~( ( uintptr_t )DEF_SWC_FSM_CACHE_LINE - 1U );
+    builder->arena          = ( uint8_t* )base;
+    builder->arenaSize      = arenaSize - ( uint64_t )( base - ( uintptr_t )arena );
+    builder->used           = 0;
+    builder->stateCapacity  = stateCapacity;
+    builder->transCapacity  = transCapacity;
+
+    context = ( SWCFsmContext* )swcFsmBuilderTake( sizeof( SWCFsmContext ), builder );
+    context->initState      = DEF_SWC_FSM_STATE_INVALID;
+    context->curState       = DEF_SWC_FSM_STATE_INVALID;
+    context->preState       = DEF_SWC_FSM_STATE_INVALID;
+    context->curSlot        = DEF_SWC_FSM_INDEX_INVALID;
+    context->fsmStateList   = ( SWCFsmStateItem* )swcFsmBuilderTake( sizeof( SWCFsmStateItem ) * ( uint64_t )stateCapacity, builder );
+    context->fsmTransTable  = ( SWCFsmTransItem* )swcFsmBuilderTake( sizeof( SWCFsmTransItem ) * ( uint64_t )transCapacity, builder );
+    context->fsmTransOffset = ( fsm_index_t* )swcFsmBuilderTake( sizeof( fsm_index_t ) * ( ( uint64_t )stateCapacity + 1U ), builder );
+    context->fsmTransEdge   = ( SWCFsmTransEdge* )swcFsmBuilderTake( sizeof( SWCFsmTransEdge ) * ( uint64_t )transCapacity, builder );
+    context->fsmStateTarget = ( fsm_bool_t* )swcFsmBuilderTake( sizeof( fsm_bool_t ) * ( uint64_t )stateCapacity, builder );
+    context->fsmIndexReady  = DEF_FSM_FALSE;
+#ifdef FSM_STATE_MAP
+    context->fsmStateMapSize    = ( fsm_index_t )DEF_SWC_FSM_STATE_MAP_SIZE( stateCapacity );
+    context->fsmStateMap        = ( fsm_index_t* )swcFsmBuilderTake( sizeof( fsm_index_t ) * ( uint64_t )context->fsmStateMapSize, builder );
+#endif
+#ifdef FSM_EVENT_QUEUE
+    context->fsmEventQueue          = ( SWCFsmEventQueue* )swcFsmBuilderTake( sizeof( SWCFsmEventQueue ), builder );
+    context->fsmEventQueue->mask    = DEF_SWC_FSM_EVENT_QUEUE_SIZE - 1U;
+    context->fsmEventQueue->cells   = ( SWCFsmEventCell* )swcFsmBuilderTake( sizeof( SWCFsmEventCell ) * DEF_SWC_FSM_EVENT_QUEUE_SIZE, builder );
+#endif
+#ifdef FSM_CONCURRENT
+    context->fsmStateWord   = DEF_SWC_FSM_WORD_PACK( DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID, 0U );
+#endif
+#ifdef FSM_TIMER_WHEEL
+    context->fsmTimers      = ( SWCFsmTimer* )swcFsmBuilderTake( sizeof( SWCFsmTimer ) * DEF_SWC_FSM_TIMER_KINDS, builder );
+#endif
+#ifdef FSM_STATS
+    context->fsmStateStats  = ( SWCFsmStateStats* )swcFsmBuilderTake( sizeof( SWCFsmStateStats ) * ( uint64_t )stateCapacity, builder );
+    context->fsmTransStats  = ( SWCFsmTransStats* )swcFsmBuilderTake( sizeof( SWCFsmTransStats ) * ( uint64_t )transCapacity, builder );
+#endif
+#ifdef FSM_HIERARCHY
+    context->fsmStateChain  = ( SWCFsmStateChain* )swcFsmBuilderTake( sizeof( SWCFsmStateChain ) * ( uint64_t )stateCapacity, builder );
+#endif
+#ifdef FSM_DEFERRED
+    context->fsmDeferQueue  = ( SWCFsmDeferQueue* )swcFsmBuilderTake( sizeof( SWCFsmDeferQueue ), builder );
+#endif
+#ifdef FSM_ROUTE
+    context->fsmRouteNext   = ( fsm_index_t* )swcFsmBuilderTake( sizeof( fsm_index_t ) * ( ( uint64_t )stateCapacity + 1U ) * ( uint64_t )stateCapacity, builder );
+#endif
+#ifdef FSM_ERROR_QUEUE
+    context->fsmErrorGates  = ( SWCFsmErrorGate* )swcFsmBuilderTake( sizeof( SWCFsmErrorGate ) * DEF_SWC_FSM_ERROR_CODES, builder );
+#endif
+
+    builder->context = context;
+
+    return FSM_OK;
+}
+
+// copy a state into the arena, ids must be unique
+FSM_FUNC
+fsm_error_t swcFsmBuilderAddState( const SWCFsmStateItem* state, SWCFsmBuilder* builder )
+{
+    fsm_index_t slot = 0;
+    SWCFsmContext* context = ( builder ) ? builder->context : NULL;
+
+    if ( !context || !state ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( ( state->state == DEF_SWC_FSM_STATE_INVALID ) || context->fsmIndexReady ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, DEF_SWC_FSM_STATE_INVALID, state->state );
+        return FSM_ERR_INVALID_STATE;
+    }
+
+    for ( slot = 0; slot < context->fsmStateSize; ++slot ) {
+        if ( context->fsmStateList[ slot ].state == state->state ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, DEF_SWC_FSM_STATE_INVALID, state->state );
+            return FSM_ERR_INVALID_STATE;
+        }
+    }
+
+    if ( context->fsmStateSize >= builder->stateCapacity ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_TOO_MANY_STATES, DEF_SWC_FSM_STATE_INVALID, state->state );
+        return FSM_ERR_TOO_MANY_STATES;
+    }
+
+    context->fsmStateList[ ( context->fsmStateSize )++ ] = *state;
+
+    return FSM_OK;
+}
+
+// copy a transition row into the arena, rows keep the order they are added in
+FSM_FUNC
+fsm_error_t swcFsmBuilderAddTransition( const SWCFsmTransItem* trans, SWCFsmBuilder* builder )
+{
+    SWCFsmContext* context = ( builder ) ? builder->context : NULL;
+
+    if ( !context || !trans ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( context->fsmIndexReady ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, trans->curState, trans->nextState );
+        return FSM_ERR_INVALID_STATE;
+    }
+
+    if ( context->fsmTransitionSize >= builder->transCapacity ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_MEMORY, trans->curState, trans->nextState );
+        return FSM_ERR_NO_MEMORY;
+    }
+
+    context->fsmTransTable[ ( context->fsmTransitionSize )++ ] = *trans;
+
+    return FSM_OK;
+}
+
+/**
+ * set the callbacks, as DECLARE_SWC_FSM_CONTEXT takes them, and build the index in the arena.
+ * builder->context is then ready for swcFsmInit, the builder itself is no longer needed.
+ */
+FSM_FUNC
+fsm_error_t swcFsmBuilderFinish( fsm_context_id_t fsmID, ptrSWCFunTransferCheck fsmCommonCheck, ptrSWCFsmErrorHandler fsmErrorHandler, fsm_state_t fsmInitState,
+                                 uint32_t fsmRoutineInterval, ptrSWCFunFSMAction fsmInit, ptrSWCFunFSMAction fsmRoutine, ptrSWCFunFSMAction fsmExit, SWCFsmBuilder* builder )
+{
+    SWCFsmContext* context = ( builder ) ? builder->context : NULL;
+
+    if ( !context ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    if ( context->fsmStateSize == 0 ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, fsmInitState );
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    context->initState          = fsmInitState;
+    context->fsmCommonCheck     = fsmCommonCheck;
+    context->fsmErrorHandler    = fsmErrorHandler;
+    context->fsmRoutineInterval = fsmRoutineInterval;
+    context->fsmContextID       = fsmID;
+    context->fsmInit            = fsmInit;
+    context->fsmRoutine         = fsmRoutine;
+    context->fsmExit            = fsmExit;
+
+    return swcFsmBuildIndex( context );
+}
+#endif
+
+#ifdef FSM_INSTANCE_POOL
+FSM_INLINE
+void swcFsmInstanceLoad( fsm_index_t instance, SWCFsmInstancePool* pool, SWCFsmInstanceRef* ref, fsm_index_t* slot )
+{
+    ref->pool       = pool;
+    ref->instance   = instance;
+    *slot = ( pool->curSlot ) ? pool->curSlot[ instance ] : swcFsmGetStateSlot( pool->curState[ instance ], pool->fsmDefinition );
+}
+
+/**
+ * prepare the shared definition once and reset every instance to DEF_SWC_FSM_STATE_INVALID,
+ * fsmInit of the definition is called per instance by swcFsmInstanceInit.
+ */
+FSM_FUNC
+fsm_error_t swcFsmPoolInit( SWCFsmInstancePool* pool )
+{
+    fsm_index_t instance = 0;
+    SWCFsmContext* context = NULL;
+
+    UNUSED( instance );
+
+    if ( !pool || !( pool->fsmDefinition ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    swcFsmEnsureIndex( pool->fsmDefinition );
+
+    for ( instance = 0; instance < pool->capacity; ++instance ) {
+        pool->curState[ instance ] = DEF_SWC_FSM_STATE_INVALID;
+        pool->preState[ instance ] = DEF_SWC_FSM_STATE_INVALID;
+        if ( pool->curSlot )    pool->curSlot[ instance ] = DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    return FSM_OK;
+}
+
+FSM_FUNC
+fsm_error_t swcFsmInstanceTransTo( fsm_state_t state, fsm_bool_t bForce, fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    fsm_error_t ret = FSM_OK;
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+    SWCFsmInstanceRef ref;
+    SWCFsmContext* context = NULL;
+
+    if ( !pool || !( pool->fsmDefinition ) || ( instance >= pool->capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    swcFsmInstanceLoad( instance, pool, &ref, &slot );
+    ret = swcFsmTransCore( state, bForce, &( pool->curState[ instance ] ), &( pool->preState[ instance ] ), &slot, &ref, pool->fsmDefinition );
+    if ( pool->curSlot )    pool->curSlot[ instance ] = slot;
+
+    return ret;
+}
+
+FSM_FUNC
+fsm_error_t swcFsmInstanceInit( fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    SWCFsmInstanceRef ref;
+    SWCFsmContext* context = NULL;
+
+    if ( !pool || !( pool->fsmDefinition ) || ( instance >= pool->capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context         = pool->fsmDefinition;
+    ref.pool        = pool;
+    ref.instance    = instance;
+
+    if ( ( context->fsmInit ) && ( ( *( context->fsmInit ) )( &ref ) != FSM_OK ) ) {
+        FSM_ERROR_REPORT( context, &ref, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, context->initState );
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    // transfer to init state
+    if ( swcFsmInstanceTransTo( context->initState, DEF_FSM_TRUE, instance, pool ) != FSM_OK ) {
+        FSM_ERROR_REPORT( context, &ref, FSM_ERR_NO_TRANSITION, DEF_SWC_FSM_STATE_INVALID, context->initState );
+        return FSM_ERR_NO_TRANSITION;
+    }
+
+    return FSM_OK;
+}
+
+FSM_FUNC
+void swcFsmInstanceRoutine( fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+    SWCFsmInstanceRef ref;
+    SWCFsmContext* context = NULL;
+    SWCFsmStateItem* state = NULL;
+
+    if ( !pool || !( pool->fsmDefinition ) || ( instance >= pool->capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return;
+    }
+
+    context = pool->fsmDefinition;
+
+    if ( context->fsmRoutine ) {
+        ref.pool        = pool;
+        ref.instance    = instance;
+        if ( ( *( context->fsmRoutine ) )( &ref ) != FSM_OK ) {
+            FSM_ERROR_REPORT( context, &ref, FSM_ERR_ROUTINE_FAILED, pool->curState[ instance ], DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+
+    swcFsmInstanceLoad( instance, pool, &ref, &slot );
+    state = swcFsmGetSlotItem( slot, context );
+
+    if ( state && state->routine ) {
+        if ( swcFsmCallAction( state->routine, DEF_SWC_FSM_ACTION_ROUTINE, state, context ) != FSM_OK ) {
+            FSM_ERROR_REPORT( context, &ref, FSM_ERR_STATE_ROUTINE_FAILED, pool->curState[ instance ], DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+}
+
+FSM_FUNC
+void swcFsmInstanceExit( fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+    SWCFsmInstanceRef ref;
+    SWCFsmContext* context = NULL;
+    SWCFsmStateItem* state = NULL;
+
+    if ( !pool || !( pool->fsmDefinition ) || ( instance >= pool->capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return;
+    }
+
+    context = pool->fsmDefinition;
+    swcFsmInstanceLoad( instance, pool, &ref, &slot );
+    state = swcFsmGetSlotItem( slot, context );
+
+#ifdef FSM_HIERARCHY
+    UNUSED( state );
+    swcFsmExitPath( slot, 0, 0U, pool->curState[ instance ], DEF_SWC_FSM_STATE_INVALID, &ref, context );
+#else
+    if ( state && state->exit ) {
+        if ( ( *( state->exit ) )( state ) != FSM_OK ) {
+            FSM_ERROR_REPORT( context, &ref, FSM_ERR_EXIT_FAILED, pool->curState[ instance ], DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+#endif
+
+    if ( context->fsmExit ) {
+        if ( ( *( context->fsmExit ) )( &ref ) != FSM_OK ) {
+            FSM_ERROR_REPORT( context, &ref, FSM_ERR_EXIT_FAILED, pool->curState[ instance ], DEF_SWC_FSM_STATE_INVALID );
+        }
+    }
+}
+
+#ifdef FSM_EVENT_TABLE
+FSM_FUNC
+fsm_error_t swcFsmInstanceHandleEvent( fsm_event_t event, fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    fsm_error_t ret = FSM_OK;
+    fsm_index_t slot = DEF_SWC_FSM_INDEX_INVALID;
+    SWCFsmInstanceRef ref;
+    SWCFsmContext* context = NULL;
+
+    if ( !pool || !( pool->fsmDefinition ) || ( instance >= pool->capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    swcFsmInstanceLoad( instance, pool, &ref, &slot );
+    ret = swcFsmEventCore( event, &( pool->curState[ instance ] ), &( pool->preState[ instance ] ), &slot, &ref, pool->fsmDefinition );
+    if ( pool->curSlot )    pool->curSlot[ instance ] = slot;
+
+    return ret;
+}
+#endif
+
+FSM_GETTER
+fsm_state_t swcFsmInstanceGetCurState( fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    if ( !pool || ( instance >= pool->capacity ) )     return DEF_SWC_FSM_STATE_INVALID;
+
+    return pool->curState[ instance ];
+}
+
+FSM_GETTER
+fsm_state_t swcFsmInstanceGetPreState( fsm_index_t instance, SWCFsmInstancePool* pool )
+{
+    if ( !pool || ( instance >= pool->capacity ) )     return DEF_SWC_FSM_STATE_INVALID;
+
+    return pool->preState[ instance ];
+}
+
+// user data of the instance behind the context argument handed to callbacks
+FSM_GETTER
+void* swcFsmInstanceGetUserData( void* owner )
+{
+    SWCFsmInstanceRef* ref = ( SWCFsmInstanceRef* )owner;
+
+    if ( !ref || !( ref->pool ) || !( ref->pool->userData ) )  return NULL;
+
+    return ref->pool->userData[ ref->instance ];
+}
+#endif
+
+#ifdef FSM_SHARD_POOL
+/**
+ * wire every shard to its pages of the arena without writing them, the hot arrays are first
+ * written by swcFsmShardPin on the thread that owns the shard.
+ */
+FSM_FUNC
+fsm_error_t swcFsmShardPoolInit( SWCFsmShardPool* shardPool )
+{
+    SWCFsmShard* shard = NULL;
+    SWCFsmContext* context = NULL;
+    uint8_t* base = NULL;
+    uint64_t line = 0;
+    fsm_index_t index = 0;
+
+    if ( !shardPool || !( shardPool->fsmDefinition ) || !( shardPool->shards ) || !( shardPool->arena ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context = shardPool->fsmDefinition;
+
+    if ( ( ( uintptr_t )( shardPool->arena ) & ( DEF_SWC_FSM_SHARD_PAGE - 1U ) ) != 0
+        || ( shardPool->shardBytes < DEF_SWC_FSM_SHARD_BYTES( shardPool->shardCapacity ) )
+        || ( ( shardPool->shardBytes & ( DEF_SWC_FSM_SHARD_PAGE - 1U ) ) != 0 ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NO_MEMORY, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NO_MEMORY;
+    }
+
+    swcFsmEnsureIndex( context );
+
+    for ( index = 0; index < shardPool->shardSize; ++index ) {
+        shard = &( shardPool->shards[ index ] );
+        base = shardPool->arena + ( uint64_t )index * shardPool->shardBytes;
+
+        shard->pool.fsmDefinition   = context;
+        shard->pool.capacity        = shardPool->shardCapacity;
+        line = DEF_SWC_FSM_SHARD_LINES( fsm_state_t, shardPool->shardCapacity );
+        shard->pool.curState        = ( fsm_state_t* )base;
+        shard->pool.preState        = ( fsm_state_t* )( base + line );
+        base += 2U * line;
+        line = DEF_SWC_FSM_SHARD_LINES( fsm_index_t, shardPool->shardCapacity );
+        shard->pool.curSlot         = ( fsm_index_t* )base;
+        shard->freeList             = ( fsm_index_t* )( base + line );
+        base += 2U * line;
+        shard->pool.userData        = ( void** )base;
+        base += DEF_SWC_FSM_SHARD_LINES( void*, shardPool->shardCapacity );
+        shard->freeBits             = ( uint64_t* )base;
+        shard->freeCount            = 0;
+        shard->cpu                  = -1;
+        shard->node                 = -1;
+    }
+
+    return FSM_OK;
+}
+
+/**
+ * call on the thread that owns shard. binds the thread to cpu ( -1 keeps its affinity ), then
+ * resets every instance and fills the free list, the first writes to the shard's pages place
+ * them on the NUMA node of that cpu.
+ */
+FSM_FUNC
+fsm_error_t swcFsmShardPin( fsm_index_t shard, int32_t cpu, SWCFsmShardPool* shardPool )
+{
+    SWCFsmShard* item = NULL;
+    SWCFsmContext* context = ( shardPool ) ? shardPool->fsmDefinition : NULL;
+    fsm_index_t instance = 0;
+#ifdef __linux__
+    unsigned long mask[ DEF_SWC_FSM_SHARD_CPUS / ( 8U * sizeof( unsigned long ) ) ];
+    unsigned int curCpu = 0;
+    unsigned int curNode = 0;
+#endif
+
+    if ( !context || !( shardPool->shards ) || ( shard >= shardPool->shardSize ) || !( shardPool->shards[ shard ].pool.curState ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    item = &( shardPool->shards[ shard ] );
+
+#ifdef __linux__
+    if ( cpu >= ( int32_t )DEF_SWC_FSM_SHARD_CPUS ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    if ( cpu >= 0 ) {
+        for ( instance = 0; instance < sizeof( mask ) / sizeof( mask[ 0 ] ); ++instance )   mask[ instance ] = 0;
+        mask[ ( uint32_t )cpu / ( 8U * sizeof( unsigned long ) ) ] = 1UL << ( ( uint32_t )cpu % ( 8U * sizeof( unsigned long ) ) );
+        // the calling thread has migrated to cpu when the call returns
+        if ( syscall( SYS_sched_setaffinity, 0, sizeof( mask ), mask ) != 0 ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_INIT_FAILED;
+        }
+    }
+
+    if ( syscall( SYS_getcpu, &curCpu, &curNode, NULL ) == 0 ) {
+        item->cpu  = ( int32_t )curCpu;
+        item->node = ( int32_t )curNode;
+    }
+#else
+    // no affinity call here, the shard is still written first by the calling thread
+    item->cpu  = cpu;
+    item->node = -1;
+#endif
+
+    swcFsmPoolInit( &( item->pool ) );
+
+    for ( instance = 0; instance < item->pool.capacity; ++instance ) {
+        item->pool.userData[ instance ] = NULL;
+        // instance 0 is handed out first
+        item->freeList[ instance ] = item->pool.capacity - 1U - instance;
+    }
+    for ( instance = 0; instance < ( item->pool.capacity + 63U ) / 64U; ++instance ) {
+        item->freeBits[ instance ] = ~0ULL;
+    }
+    FSM_ATOMIC_STORE_RELAXED( &( item->freeCount ), item->pool.capacity );
+
+    return FSM_OK;
+}
+
+// the pool of shard, for swcFsmInstance* on the owner thread
+FSM_FUNC
+SWCFsmInstancePool* swcFsmShardGet( fsm_index_t shard, SWCFsmShardPool* shardPool )
+{
+    if ( !shardPool || !( shardPool->shards ) || ( shard >= shardPool->shardSize ) )   return NULL;
+
+    return &( shardPool->shards[ shard ].pool );
+}
+
+// owner thread only, DEF_SWC_FSM_INDEX_INVALID when the shard is full. the instance still needs swcFsmInstanceInit
+FSM_FUNC
+fsm_index_t swcFsmShardAlloc( fsm_index_t shard, SWCFsmShardPool* shardPool )
+{
+    SWCFsmShard* item = NULL;
+    fsm_index_t count = 0;
+    fsm_index_t instance = 0;
+
+    if ( !shardPool || !( shardPool->shards ) || ( shard >= shardPool->shardSize ) )   return DEF_SWC_FSM_INDEX_INVALID;
+
+    item = &( shardPool->shards[ shard ] );
+    count = item->freeCount;
+    if ( count == 0 )   return DEF_SWC_FSM_INDEX_INVALID;
+
+    instance = item->freeList[ count - 1U ];
+    item->freeBits[ instance / 64U ] &= ~( 1ULL << ( instance % 64U ) );
+    FSM_ATOMIC_STORE_RELAXED( &( item->freeCount ), count - 1U );
+
+    return instance;
+}
+
+/**
+ * owner thread only, run swcFsmInstanceExit first when the instance has exit actions. an instance
+ * that is already free gives FSM_ERR_INVALID_STATE and stays on the free list once.
+ */
+FSM_FUNC
+fsm_error_t swcFsmShardFree( fsm_index_t instance, fsm_index_t shard, SWCFsmShardPool* shardPool )
+{
+    SWCFsmShard* item = NULL;
+    SWCFsmContext* context = ( shardPool ) ? shardPool->fsmDefinition : NULL;
+
+    if ( !context || !( shardPool->shards ) || ( shard >= shardPool->shardSize ) || ( instance >= shardPool->shards[ shard ].pool.capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    item = &( shardPool->shards[ shard ] );
+
+    if ( ( item->freeBits[ instance / 64U ] & ( 1ULL << ( instance % 64U ) ) ) || ( item->freeCount >= item->pool.capacity ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_INVALID_STATE;
+    }
+
+    item->pool.curState[ instance ] = DEF_SWC_FSM_STATE_INVALID;
+    item->pool.preState[ instance ] = DEF_SWC_FSM_STATE_INVALID;
+    item->pool.curSlot[ instance ]  = DEF_SWC_FSM_INDEX_INVALID;
+    item->pool.userData[ instance ] = NULL;
+    item->freeList[ item->freeCount ] = instance;
+    item->freeBits[ instance / 64U ] |= 1ULL << ( instance % 64U );
+    FSM_ATOMIC_STORE_RELAXED( &( item->freeCount ), item->freeCount + 1U );
+
+    return FSM_OK;
+}
+
+/**
+ * the shard on node with the most free instances, any node for -1, DEF_SWC_FSM_INDEX_INVALID when
+ * none has room. counts of other shards are read without a lock, the pick is a hint for handing
+ * new work to an owner thread, the owner still allocates.
+ */
+FSM_FUNC
+fsm_index_t swcFsmShardPick( int32_t node, SWCFsmShardPool* shardPool )
+{
+    fsm_index_t index = 0;
+    fsm_index_t best = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t bestCount = 0;
+    fsm_index_t count = 0;
+
+    if ( !shardPool || !( shardPool->shards ) )     return DEF_SWC_FSM_INDEX_INVALID;
+
+    for ( index = 0; index < shardPool->shardSize; ++index ) {
+        if ( ( node >= 0 ) && ( shardPool->shards[ index ].node != node ) )    continue;
+
+        count = FSM_ATOMIC_LOAD_RELAXED( &( shardPool->shards[ index ].freeCount ) );
+        if ( count > bestCount ) {
+            best = index;
+            bestCount = count;
+        }
+    }
+
+    return best;
+}
+#endif
+
+#ifdef FSM_SNAPSHOT
+FSM_INLINE
+uint64_t swcFsmHashBytes( uint64_t hash, const void* data, uint64_t size )
+{
+    const uint8_t* bytes = ( const uint8_t* )data;
+    uint64_t index = 0;
+
+    for ( index = 0; index < size; ++index ) {
+        hash = ( hash ^ bytes[ index ] ) * DEF_SWC_FSM_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+FSM_INLINE
+uint64_t swcFsmHashWord( uint64_t hash, uint64_t value )
+{
+    return swcFsmHashBytes( hash, &value, sizeof( value ) );
+}
+
+/**
+ * hash of everything a snapshot depends on: state ids ( and parents ), transition rows and the
+ * context ID of a definition. callbacks and guards are left out, they may change between builds.
+ */
+FSM_FUNC
+uint64_t swcFsmTableHash( uint64_t hash, SWCFsmContext* context )
+{
+    fsm_index_t index = 0;
+
+    hash = swcFsmHashWord( hash, context->fsmContextID );
+    hash = swcFsmHashWord( hash, context->fsmStateSize );
+    hash = swcFsmHashWord( hash, context->fsmTransitionSize );
+
+    for ( index = 0; index < context->fsmStateSize; ++index ) {
+        hash = swcFsmHashWord( hash, context->fsmStateList[ index ].state );
+#ifdef FSM_HIERARCHY
+        hash = swcFsmHashWord( hash, context->fsmStateList[ index ].parent );
+#endif
+    }
+
+    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
+        hash = swcFsmHashWord( hash, context->fsmTransTable[ index ].curState );
+        hash = swcFsmHashWord( hash, context->fsmTransTable[ index ].nextState );
+    }
+
+    return hash;
+}
+
+FSM_INLINE
+uint64_t swcFsmSnapshotAlign( uint64_t offset )
+{
+    return ( offset + DEF_SWC_FSM_SNAPSHOT_ALIGN - 1U ) & ~( ( uint64_t )DEF_SWC_FSM_SNAPSHOT_ALIGN - 1U );
+}
+
+// bytes of the state section of entry, the blob follows on the next cache line
+FSM_INLINE
+uint64_t swcFsmSnapshotStateSize( SWCFsmSnapshotEntry* entry )
+{
+#ifdef FSM_INSTANCE_POOL
+    if ( entry->pool ) {
+        return ( uint64_t )entry->pool->capacity * ( 2U * sizeof( fsm_state_t ) + ( entry->pool->curSlot ? sizeof( fsm_index_t ) : 0U ) );
+    }
+#endif
+    UNUSED( entry );
+    return sizeof( SWCFsmSnapshotState );
+}
+
+// file size and table hash of the registered entries
+FSM_INLINE
+uint64_t swcFsmSnapshotLayout( SWCFsmSnapshot* snapshot, uint64_t* tableHash )
+{
+    SWCFsmSnapshotEntry* entry = NULL;
+    uint64_t offset = swcFsmSnapshotAlign( sizeof( SWCFsmSnapshotHeader ) );
+    uint64_t hash = DEF_SWC_FSM_HASH_SEED;
+    fsm_index_t index = 0;
+
+    for ( index = 0; index < snapshot->count; ++index ) {
+        entry = &( snapshot->entries[ index ] );
+#ifdef FSM_INSTANCE_POOL
+        if ( entry->pool ) {
+            hash = swcFsmTableHash( hash, entry->pool->fsmDefinition );
+            hash = swcFsmHashWord( hash, entry->pool->capacity );
+            hash = swcFsmHashWord( hash, entry->pool->curSlot ? 1U : 0U );
+        } else
+#endif
+        {
+            hash = swcFsmTableHash( hash, entry->context );
+        }
+        hash = swcFsmHashWord( hash, entry->blobSize );
+
+        offset = swcFsmSnapshotAlign( offset + swcFsmSnapshotStateSize( entry ) );
+        offset = swcFsmSnapshotAlign( offset + entry->blobSize );
+    }
+
+    *tableHash = hash;
+
+    return offset;
+}
+
+// the context snapshot errors are reported to, the first registered one
+FSM_INLINE
+SWCFsmContext* swcFsmSnapshotOwner( SWCFsmSnapshot* snapshot )
+{
+    if ( snapshot->count == 0 )     return NULL;
+#ifdef FSM_INSTANCE_POOL
+    if ( snapshot->entries[ 0 ].pool )  return snapshot->entries[ 0 ].pool->fsmDefinition;
+#endif
+
+    return snapshot->entries[ 0 ].context;
+}
+
+// drop the temporary file of a failed save, the file at path is left as it was
+FSM_INLINE
+fsm_error_t swcFsmSnapshotAbort( int fd, const char* tmpPath, SWCFsmContext* context )
+{
+    if ( fd >= 0 )  close( fd );
+    unlink( tmpPath );
+
+    FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+    return FSM_ERR_SNAPSHOT;
+}
+
+/**
+ * register context with blobSize bytes at blob, NULL and 0 for none. entries are written and read
+ * in the order of registration, restoring needs the same entries with the same tables.
+ */
 FSM_FUNC
-SWCFsmStateItem* swcFsmGetStateItem( fsm_state_t state, SWCFsmContext* context )
+fsm_error_t swcFsmSnapshotAdd( SWCFsmContext* context, void* blob, uint64_t blobSize, SWCFsmSnapshot* snapshot )
 {
-    uint8_t index = 0;
+    SWCFsmSnapshotEntry* entry = NULL;
 
-    UNUSED( index );
+    if ( !context || !snapshot || ( !blob && blobSize ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
 
-    if ( !context || state == DEF_SWC_FSM_STATE_INVALID )     return NULL;
+    if ( snapshot->count >= snapshot->capacity ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_QUEUE_FULL, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_QUEUE_FULL;
+    }
 
-    for ( index = 0; index < context->fsmStateSize; ++index ) {
-        if ( context->fsmStateList[ index ].state == state ) {
-            return &( context->fsmStateList[index] );
-        }
+    entry = &( snapshot->entries[ ( snapshot->count )++ ] );
+    entry->context  = context;
+#ifdef FSM_INSTANCE_POOL
+    entry->pool     = NULL;
+#endif
+    entry->blob     = blob;
+    entry->blobSize = blobSize;
+
+    return FSM_OK;
+}
+
+#ifdef FSM_INSTANCE_POOL
+// register every instance of pool, the blob typically holds the per instance user data
+FSM_FUNC
+fsm_error_t swcFsmSnapshotAddPool( SWCFsmInstancePool* pool, void* blob, uint64_t blobSize, SWCFsmSnapshot* snapshot )
+{
+    SWCFsmSnapshotEntry* entry = NULL;
+    SWCFsmContext* context = ( pool ) ? pool->fsmDefinition : NULL;
+
+    if ( !context || !snapshot || ( !blob && blobSize ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
     }
 
-    return NULL;
+    if ( snapshot->count >= snapshot->capacity ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_QUEUE_FULL, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_QUEUE_FULL;
+    }
+
+    entry = &( snapshot->entries[ ( snapshot->count )++ ] );
+    entry->context  = NULL;
+    entry->pool     = pool;
+    entry->blob     = blob;
+    entry->blobSize = blobSize;
+
+    return FSM_OK;
 }
+#endif
 
+/**
+ * write the state of every registered entry and its blob to path DEF_SWC_FSM_SNAPSHOT_TMP_SUFFIX through
+ * a shared mapping, sync it and rename it over path, so a crash during the save leaves the previous
+ * snapshot. call it while no registered context is running a transition. errors are reported to the
+ * context of the first entry.
+ */
 FSM_FUNC
-SWCFsmStateItem* swcFsmGetCurStateItem( SWCFsmContext* context )
+fsm_error_t swcFsmSnapshotSave( SWCFsmSnapshot* snapshot, const char* path )
 {
-    if ( !context )     return NULL;
+    SWCFsmSnapshotEntry* entry = NULL;
+    SWCFsmSnapshotHeader* header = NULL;
+    SWCFsmSnapshotState* state = NULL;
+    SWCFsmContext* context = NULL;
+    uint8_t* map = NULL;
+    char tmpPath[ DEF_SWC_FSM_SNAPSHOT_PATH_SIZE ];
+    size_t pathLength = 0;
+    uint64_t tableHash = 0;
+    uint64_t size = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    fsm_index_t index = 0;
+    int fd = -1;
 
-    return swcFsmGetStateItem( context->curState, context );
+    UNUSED( length );
+
+    if ( !snapshot || !path ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context = swcFsmSnapshotOwner( snapshot );
+
+    pathLength = strlen( path );
+    if ( pathLength + sizeof( DEF_SWC_FSM_SNAPSHOT_TMP_SUFFIX ) > sizeof( tmpPath ) ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+    memcpy( tmpPath, path, pathLength );
+    memcpy( tmpPath + pathLength, DEF_SWC_FSM_SNAPSHOT_TMP_SUFFIX, sizeof( DEF_SWC_FSM_SNAPSHOT_TMP_SUFFIX ) );
+
+    size = swcFsmSnapshotLayout( snapshot, &tableHash );
+
+    fd = open( tmpPath, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+
+    if ( ftruncate( fd, ( off_t )size ) != 0 )  return swcFsmSnapshotAbort( fd, tmpPath, context );
+
+    map = ( uint8_t* )mmap( NULL, ( size_t )size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( map == ( uint8_t* )MAP_FAILED )    return swcFsmSnapshotAbort( fd, tmpPath, context );
+
+    offset = swcFsmSnapshotAlign( sizeof( SWCFsmSnapshotHeader ) );
+    for ( index = 0; index < snapshot->count; ++index ) {
+        entry = &( snapshot->entries[ index ] );
+#ifdef FSM_INSTANCE_POOL
+        if ( entry->pool ) {
+            length = ( uint64_t )entry->pool->capacity * sizeof( fsm_state_t );
+            memcpy( map + offset, entry->pool->curState, ( size_t )length );
+            memcpy( map + offset + length, entry->pool->preState, ( size_t )length );
+            if ( entry->pool->curSlot ) {
+                memcpy( map + offset + 2U * length, entry->pool->curSlot, ( size_t )( entry->pool->capacity * sizeof( fsm_index_t ) ) );
+            }
+        } else
+#endif
+        {
+            state = ( SWCFsmSnapshotState* )( map + offset );
+            state->curState = swcFsmGetCurState( entry->context );
+            state->preState = swcFsmGetPreState( entry->context );
+            state->curSlot  = entry->context->curSlot;
+        }
+        offset = swcFsmSnapshotAlign( offset + swcFsmSnapshotStateSize( entry ) );
+
+        if ( entry->blobSize )  memcpy( map + offset, entry->blob, ( size_t )entry->blobSize );
+        offset = swcFsmSnapshotAlign( offset + entry->blobSize );
+    }
+
+    header = ( SWCFsmSnapshotHeader* )map;
+    header->magic       = DEF_SWC_FSM_SNAPSHOT_MAGIC;
+    header->version     = DEF_SWC_FSM_SNAPSHOT_VERSION;
+    header->tableHash   = tableHash;
+    header->size        = size;
+    header->count       = snapshot->count;
+    header->reserved    = 0;
+
+    if ( msync( map, ( size_t )size, MS_SYNC ) != 0 ) {
+        munmap( map, ( size_t )size );
+        return swcFsmSnapshotAbort( fd, tmpPath, context );
+    }
+    munmap( map, ( size_t )size );
+
+    // the size and the blocks of the file are durable before it replaces the previous snapshot
+    if ( fsync( fd ) != 0 )     return swcFsmSnapshotAbort( fd, tmpPath, context );
+    close( fd );
+
+    if ( rename( tmpPath, path ) != 0 )     return swcFsmSnapshotAbort( -1, tmpPath, context );
+
+    return FSM_OK;
 }
+
+/**
+ * map path and copy every section back into the registered entries in place of swcFsmInit and
+ * swcFsmInstanceInit. no action runs, timers are armed again by swcFsmWheelAdd. returns
+ * FSM_ERR_SNAPSHOT to the context of the first entry and leaves every entry untouched when the file
+ * is missing, torn, or was written for other tables, pool sizes or blob sizes.
+ */
+FSM_FUNC
+fsm_error_t swcFsmSnapshotRestore( SWCFsmSnapshot* snapshot, const char* path )
+{
+    SWCFsmSnapshotEntry* entry = NULL;
+    SWCFsmSnapshotHeader* header = NULL;
+    SWCFsmSnapshotState* state = NULL;
+    SWCFsmContext* context = NULL;
+    uint8_t* map = NULL;
+    struct stat info;
+    uint64_t tableHash = 0;
+    uint64_t size = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    fsm_index_t index = 0;
+    int fd = -1;
+
+    UNUSED( length );
+
+    if ( !snapshot || !path ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_NULL_CONTEXT;
+    }
+
+    context = swcFsmSnapshotOwner( snapshot );
+    size = swcFsmSnapshotLayout( snapshot, &tableHash );
+
+    fd = open( path, O_RDONLY );
+    if ( fd < 0 ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+
+    if ( ( fstat( fd, &info ) != 0 ) || ( ( uint64_t )info.st_size != size ) ) {
+        close( fd );
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+
+    map = ( uint8_t* )mmap( NULL, ( size_t )size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( map == ( uint8_t* )MAP_FAILED ) {
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+
+    header = ( SWCFsmSnapshotHeader* )map;
+    if ( ( header->magic != DEF_SWC_FSM_SNAPSHOT_MAGIC ) || ( header->version != DEF_SWC_FSM_SNAPSHOT_VERSION ) ||
+         ( header->tableHash != tableHash ) || ( header->size != size ) || ( header->count != snapshot->count ) ) {
+        munmap( map, ( size_t )size );
+        FSM_ERROR_HANDLER( context, FSM_ERR_SNAPSHOT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+        return FSM_ERR_SNAPSHOT;
+    }
+
+    offset = swcFsmSnapshotAlign( sizeof( SWCFsmSnapshotHeader ) );
+    for ( index = 0; index < snapshot->count; ++index ) {
+        entry = &( snapshot->entries[ index ] );
+#ifdef FSM_INSTANCE_POOL
+        if ( entry->pool ) {
+            context = entry->pool->fsmDefinition;
+            swcFsmEnsureIndex( context );
+
+            length = ( uint64_t )entry->pool->capacity * sizeof( fsm_state_t );
+            memcpy( entry->pool->curState, map + offset, ( size_t )length );
+            memcpy( entry->pool->preState, map + offset + length, ( size_t )length );
+            if ( entry->pool->curSlot ) {
+                memcpy( entry->pool->curSlot, map + offset + 2U * length, ( size_t )( entry->pool->capacity * sizeof( fsm_index_t ) ) );
+            }
+        } else
 #endif
+        {
+            context = entry->context;
+            swcFsmEnsureIndex( context );
 
-#ifdef FSM_DEBUG
-    // define console output here
-    #include <stdio.h>
-    #define FSM_ERROR_HANDLER(context, error, curState, nextState) \
-        do { \
-            if ( context && context->fsmErrorHandler ) { \
-                context->fsmErrorHandler(error, curState, nextState, context); \
-            } \
-            fprintf( stderr, "[%s:%d]FSM Error %d: Current=%u, Next=%u\n", __FILE__, __LINE__, error, curState, nextState ); \
-        } while (0)
-#else
-    #define FSM_ERROR_HANDLER(context, error, curState, nextState) \
-        do { \
-            if ( context && context->fsmErrorHandler ) { \
-                context->fsmErrorHandler(error, curState, nextState, context); \
-            } \
-        } while (0)
+            state = ( SWCFsmSnapshotState* )( map + offset );
+            context->curState   = state->curState;
+            context->preState   = state->preState;
+            context->curSlot    = state->curSlot;
+#ifdef FSM_CONCURRENT
+            FSM_ATOMIC_STORE( &( context->fsmStateWord ), DEF_SWC_FSM_WORD_PACK( state->curState, state->preState, DEF_SWC_FSM_WORD_SEQ( context->fsmStateWord ) + 2U ) );
 #endif
+        }
+        offset = swcFsmSnapshotAlign( offset + swcFsmSnapshotStateSize( entry ) );
 
-#ifdef FSM_IMPLEMENTATION
-#define FSM_NO_IMPL
+        if ( entry->blobSize )  memcpy( entry->blob, map + offset, ( size_t )entry->blobSize );
+        offset = swcFsmSnapshotAlign( offset + entry->blobSize );
+    }
+
+    munmap( map, ( size_t )size );
+
+    return FSM_OK;
+}
 #endif
 
-#ifndef FSM_NO_IMPL
+#ifdef FSM_SCHEDULER
 FSM_INLINE
-fsm_state_t swcFsmGetCurState( SWCFsmContext* context )
+void swcFsmWorkerPush( SWCFsmWorker* worker, SWCFsmContext* context )
 {
-    if ( !context )     return DEF_SWC_FSM_STATE_INVALID;
+    int64_t bottom = FSM_ATOMIC_LOAD_RELAXED( &( worker->bottom ) );
 
-    return context->curState;
+    FSM_ATOMIC_STORE_RELAXED( &( worker->tasks[ bottom & worker->mask ] ), context );
+    FSM_ATOMIC_STORE( &( worker->bottom ), bottom + 1 );
 }
 
 FSM_INLINE
-fsm_state_t swcFsmGetPreState( SWCFsmContext* context )
+SWCFsmContext* swcFsmWorkerPop( SWCFsmWorker* worker )
 {
-    if ( !context )     return DEF_SWC_FSM_STATE_INVALID;
+    int64_t bottom = FSM_ATOMIC_LOAD_RELAXED( &( worker->bottom ) ) - 1;
+    int64_t top = 0;
+    SWCFsmContext* context = NULL;
 
-    return context->preState;
+    FSM_ATOMIC_STORE_RELAXED( &( worker->bottom ), bottom );
+    FSM_ATOMIC_FENCE();
+    top = FSM_ATOMIC_LOAD_RELAXED( &( worker->top ) );
+
+    if ( top <= bottom ) {
+        context = FSM_ATOMIC_LOAD_RELAXED( &( worker->tasks[ bottom & worker->mask ] ) );
+        if ( top != bottom )    return context;
+
+        // last entry, race the thieves for it
+        if ( !FSM_ATOMIC_CAS_STRONG( &( worker->top ), &top, top + 1 ) )   context = NULL;
+    }
+
+    FSM_ATOMIC_STORE_RELAXED( &( worker->bottom ), bottom + 1 );
+    return context;
 }
 
-FSM_FUNC
-fsm_error_t swcFsmTransTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+// NULL with *retry set when another worker won the entry, the deque may still hold work
+FSM_INLINE
+SWCFsmContext* swcFsmWorkerSteal( SWCFsmWorker* worker, fsm_bool_t* retry )
 {
-    uint8_t index = 0;
-    int32_t ret = -1;   // not match
-    fsm_bool_t bTransition = DEF_FSM_FALSE;
-    SWCFsmTransItem *curfsmTransItem = NULL;
-    SWCFsmStateItem *curStateItem = NULL;
-    SWCFsmStateItem *nextStateItem = NULL;
+    int64_t top = FSM_ATOMIC_LOAD( &( worker->top ) );
+    int64_t bottom = 0;
+    SWCFsmContext* context = NULL;
 
-    UNUSED( bForce );
-    UNUSED( index );
-    UNUSED( ret );
-    UNUSED( bTransition );
-    UNUSED( curfsmTransItem );
-    UNUSED( curStateItem );
-    UNUSED( nextStateItem );
+    FSM_ATOMIC_FENCE();
+    bottom = FSM_ATOMIC_LOAD( &( worker->bottom ) );
+    if ( top >= bottom )    return NULL;
 
-    if ( !context ) {
-        FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state);
-        return FSM_ERR_NULL_CONTEXT;
-    }
-    
-    if ( state == DEF_SWC_FSM_STATE_INVALID ) {
-        FSM_ERROR_HANDLER(context, FSM_ERR_INVALID_STATE, context->curState, state);
-        return FSM_ERR_INVALID_STATE;
+    context = FSM_ATOMIC_LOAD_RELAXED( &( worker->tasks[ top & worker->mask ] ) );
+    if ( !FSM_ATOMIC_CAS_STRONG( &( worker->top ), &top, top + 1 ) ) {
+        *retry = DEF_FSM_TRUE;
+        return NULL;
     }
 
-    if ( ( bForce == DEF_FSM_FALSE ) && ( context->curState == state ) ) return FSM_OK;
+    return context;
+}
 
-    for ( index = 0; index < context->fsmTransitionSize; ++index ) {
-        if ( context->fsmTransTable[index].nextState == state ) {   // make sure next state in trans table
-            if ( bForce == DEF_FSM_FALSE ) {
-                curfsmTransItem = &( context->fsmTransTable[index] );
-                if ( context->fsmTransTable[index].curState == context->curState ) {
-                    if ( ( !( context->fsmCommonCheck ) || ( ( *( context->fsmCommonCheck ) ) ( context->curState, state, context ) ) == DEF_FSM_TRUE ) && \
-                        ( !( curfsmTransItem->transCheck ) || ( ( *( curfsmTransItem->transCheck ) ) ( context->curState, state, context ) ) ) == DEF_FSM_TRUE ) {
-                        bTransition = DEF_FSM_TRUE;
-                        break;
-                    } else {
-                        FSM_ERROR_HANDLER(context, FSM_ERR_CHECK_FAILED, context->curState, state);
-                        return FSM_ERR_CHECK_FAILED;
-                    }
-                }
-            } else {
-                // skip all check
-                bTransition = DEF_FSM_TRUE;
-                break;
-            }
+/**
+ * one round: push the due contexts of this worker's share, run them, then steal from the others until
+ * every deque is empty. a context sits in exactly one deque per round and the next round opens only
+ * after all workers left this one, so no context is ever run by two workers at once.
+ */
+FSM_INLINE
+void swcFsmWorkerRound( SWCFsmWorker* worker, uint64_t round )
+{
+    SWCFsmScheduler* scheduler = worker->scheduler;
+    SWCFsmContext* context = NULL;
+    fsm_index_t index = 0;
+    fsm_index_t victim = 0;
+    uint32_t ticks = 0;
+    fsm_bool_t retry = DEF_FSM_FALSE;
+
+    for ( index = worker->id; index < scheduler->contextSize; index += scheduler->workerSize ) {
+        context = scheduler->contexts[ index ];
+        ticks = context->fsmRoutineInterval / scheduler->tick;
+        // spread contexts with the same interval over the rounds
+        if ( ( ticks <= 1U ) || ( ( ( round + index ) % ticks ) == 0U ) ) {
+            swcFsmWorkerPush( worker, context );
         }
     }
 
-    if ( bTransition == DEF_FSM_TRUE ) {
-        curStateItem    = swcFsmGetStateItem( context->curState, context );
-        nextStateItem   = swcFsmGetStateItem( state, context );
-
-        if ( curStateItem && curStateItem->exit ) {
-            // call exit action for cur state
-            if ( ( *( curStateItem->exit ) ) ( curStateItem ) != FSM_OK ) {
-                FSM_ERROR_HANDLER(context, FSM_ERR_EXIT_FAILED, context->curState, state);
-                return FSM_ERR_EXIT_FAILED;
+    for ( ;; ) {
+        context = swcFsmWorkerPop( worker );
+
+        while ( !context ) {
+            retry = DEF_FSM_FALSE;
+            for ( index = 1; ( index < scheduler->workerSize ) && !context; ++index ) {
+                victim = ( worker->id + index ) % scheduler->workerSize;
+                context = swcFsmWorkerSteal( &( scheduler->workers[ victim ] ), &retry );
             }
+            if ( !retry )   break;
         }
+        if ( !context )     break;
 
-        if ( nextStateItem && nextStateItem->entry ) {
-            // call entry action for next state
-            if ( ( *( nextStateItem->entry ) ) ( nextStateItem ) != FSM_OK ) {
-                FSM_ERROR_HANDLER(context, FSM_ERR_ENTRY_FAILED, context->curState, state);
-                return FSM_ERR_ENTRY_FAILED;
+        swcFsmRoutine( context );
+    }
+}
+
+FSM_FUNC
+void* swcFsmWorkerMain( void* arg )
+{
+    SWCFsmWorker* worker = ( SWCFsmWorker* )arg;
+    SWCFsmScheduler* scheduler = worker->scheduler;
+    uint64_t round = 0;
+    uint64_t deadline = swcFsmClockNs();
+    uint64_t now = 0;
+    struct timespec wakeup;
+
+    for ( ;; ) {
+        if ( worker->id == 0 ) {
+            // worker 0 keeps the clock, a late round starts right away instead of piling up
+            now = swcFsmClockNs();
+            deadline += ( uint64_t )( scheduler->tick ) * 1000000ULL;
+            if ( deadline < now )   deadline = now;
+            wakeup.tv_sec = ( time_t )( deadline / 1000000000ULL );
+            wakeup.tv_nsec = ( long )( deadline % 1000000000ULL );
+            // an absolute deadline survives a signal, any other error would fail the same way again
+            while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL ) == EINTR );
+
+            pthread_mutex_lock( &( scheduler->lock ) );
+            while ( scheduler->running && ( scheduler->active != 0 ) ) {
+                pthread_cond_wait( &( scheduler->wake ), &( scheduler->lock ) );
+            }
+            if ( scheduler->running ) {
+                ++( scheduler->round );
+                scheduler->active = scheduler->workerSize;
+                pthread_cond_broadcast( &( scheduler->wake ) );
+            }
+        } else {
+            pthread_mutex_lock( &( scheduler->lock ) );
+            while ( scheduler->running && ( scheduler->round == round ) ) {
+                pthread_cond_wait( &( scheduler->wake ), &( scheduler->lock ) );
             }
         }
 
-        // update state
-        if ( context->curState != state ) {
-            context->preState = context->curState;
+        // a round opened before the stop still runs on every worker, or its contexts would be skipped
+        if ( scheduler->round == round ) {
+            pthread_mutex_unlock( &( scheduler->lock ) );
+            break;
         }
-        context->curState = state;
-        return FSM_OK;
-    } else {
-        FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, context->curState, state );
+        round = scheduler->round;
+        pthread_mutex_unlock( &( scheduler->lock ) );
 
-        return FSM_ERR_NO_TRANSITION;
+        swcFsmWorkerRound( worker, round );
+
+        pthread_mutex_lock( &( scheduler->lock ) );
+        if ( --( scheduler->active ) == 0 )     pthread_cond_broadcast( &( scheduler->wake ) );
+        pthread_mutex_unlock( &( scheduler->lock ) );
     }
+
+    return NULL;
 }
 
+/**
+ * contexts must be initialized with swcFsmInit and added before swcFsmSchedulerStart.
+ */
 FSM_FUNC
-fsm_error_t swcFsmInit( SWCFsmContext* context )
+fsm_error_t swcFsmSchedulerAdd( SWCFsmContext* context, SWCFsmScheduler* scheduler )
 {
-    if ( !context ) {
+    if ( !context || !scheduler ) {
         FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
         return FSM_ERR_NULL_CONTEXT;
     }
 
-    if ( ( context->fsmInit ) && ( ( *( context->fsmInit ) )( context ) != FSM_OK ) ) {
-        FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, context->initState );
-        return FSM_ERR_INIT_FAILED;
+    if ( scheduler->running ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_BUSY, context->curState, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_BUSY;
     }
 
-    // transfer to init state
-    if ( swcFsmTransTo( context->initState, DEF_FSM_TRUE, context ) != FSM_OK ) {
-        FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, DEF_SWC_FSM_STATE_INVALID, context->initState );
-        return FSM_ERR_NO_TRANSITION;
+    if ( scheduler->contextSize >= scheduler->capacity ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_QUEUE_FULL, context->curState, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_QUEUE_FULL;
     }
 
+    scheduler->contexts[ ( scheduler->contextSize )++ ] = context;
     return FSM_OK;
 }
 
 FSM_FUNC
-void swcFsmRoutine( SWCFsmContext* context )
+fsm_error_t swcFsmSchedulerStart( SWCFsmScheduler* scheduler )
 {
-    SWCFsmStateItem* state = NULL;
+    SWCFsmContext* context = NULL;
+    SWCFsmWorker* worker = NULL;
+    fsm_index_t index = 0;
+    fsm_index_t share = 0;
+    fsm_index_t offset = 0;
+    int64_t size = 0;
 
-    UNUSED( state );
-
-    if ( !context ) {
+    if ( !scheduler || !( scheduler->workers ) || !( scheduler->slots ) || ( scheduler->workerSize == 0 ) ) {
         FSM_ERROR_HANDLER(context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
-        return;
-    }
-
-    if ( context->fsmRoutine ) {
-        if ( ( *( context->fsmRoutine ) )( context ) != FSM_OK ) {
-            FSM_ERROR_HANDLER(context, FSM_ERR_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
-        }
+        return FSM_ERR_NULL_CONTEXT;
     }
 
-    state = swcFsmGetCurStateItem( context );
-
-    if ( state && state->routine ) {
-        if ( ( *( state->routine ) )( state ) != FSM_OK ) {
-            FSM_ERROR_HANDLER(context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID);
-        }
+    if ( scheduler->running ) {
+        FSM_ERROR_HANDLER(context, FSM_ERR_BUSY, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+        return FSM_ERR_BUSY;
     }
-}
 
-FSM_FUNC
-void swcFsmExit( SWCFsmContext* context )
-{
-    SWCFsmStateItem* state = NULL;
+    if ( scheduler->tick == 0 )     scheduler->tick = DEF_SWC_FSM_SCHEDULER_TICK;
 
-    UNUSED( state );
+    // worker i owns contexts i, i + workerSize, ...
+    for ( index = 0; index < scheduler->workerSize; ++index ) {
+        worker = &( scheduler->workers[ index ] );
+        share = ( scheduler->contextSize > index ) ? ( scheduler->contextSize - index + scheduler->workerSize - 1U ) / scheduler->workerSize : 0U;
+        for ( size = 1; size < ( int64_t )share; size <<= 1 );
 
-    if ( !context ) {
-        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
-        return;
+        worker->top = 0;
+        worker->bottom = 0;
+        worker->mask = size - 1;
+        worker->tasks = &( scheduler->slots[ offset ] );
+        worker->scheduler = scheduler;
+        worker->id = index;
+        offset += ( fsm_index_t )size;
     }
 
-    state = swcFsmGetCurStateItem( context );
+    scheduler->round = 0;
+    scheduler->active = 0;
+    scheduler->running = DEF_FSM_TRUE;
+    pthread_mutex_init( &( scheduler->lock ), NULL );
+    pthread_cond_init( &( scheduler->wake ), NULL );
 
-    if ( state && state->exit ) {
-        if ( ( *( state->exit ) )( state ) != FSM_OK ) {
-            FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+    for ( index = 0; index < scheduler->workerSize; ++index ) {
+        if ( pthread_create( &( scheduler->workers[ index ].thread ), NULL, swcFsmWorkerMain, &( scheduler->workers[ index ] ) ) != 0 ) {
+            // stop the workers already running
+            pthread_mutex_lock( &( scheduler->lock ) );
+            scheduler->running = DEF_FSM_FALSE;
+            pthread_cond_broadcast( &( scheduler->wake ) );
+            pthread_mutex_unlock( &( scheduler->lock ) );
+            while ( index > 0 )     pthread_join( scheduler->workers[ --index ].thread, NULL );
+            FSM_ERROR_HANDLER(context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID);
+            return FSM_ERR_INIT_FAILED;
         }
     }
 
-    if ( context->fsmExit ) {
-        if ( ( *( context->fsmExit ) )( context ) != FSM_OK ) {
-            FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
-        }
-    }
+    return FSM_OK;
 }
 
+/**
+ * waits for the round in progress, routines never stop halfway.
+ */
 FSM_FUNC
-fsm_error_t swcFsmGoBack( fsm_bool_t bForce, SWCFsmContext* context )
+void swcFsmSchedulerStop( SWCFsmScheduler* scheduler )
 {
-    if ( !context ) {
-        FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
-        return FSM_ERR_NULL_CONTEXT;
+    fsm_index_t index = 0;
+
+    if ( !scheduler || !( scheduler->running ) )    return;
+
+    pthread_mutex_lock( &( scheduler->lock ) );
+    scheduler->running = DEF_FSM_FALSE;
+    pthread_cond_broadcast( &( scheduler->wake ) );
+    pthread_mutex_unlock( &( scheduler->lock ) );
+
+    for ( index = 0; index < scheduler->workerSize; ++index ) {
+        pthread_join( scheduler->workers[ index ].thread, NULL );
     }
 
-    return swcFsmTransTo( context->preState, bForce, context );
+    pthread_cond_destroy( &( scheduler->wake ) );
+    pthread_mutex_destroy( &( scheduler->lock ) );
 }
+#endif
 
 #else
 // implement these function in .c if defined FSM_IMPLEMENTATION 
 extern fsm_error_t                  swcFsmInit( SWCFsmContext* context );
+extern fsm_error_t                  swcFsmBuildIndex( SWCFsmContext* context );
+#ifdef FSM_STATE_MAP
+extern fsm_error_t                  swcFsmBuildStateMap( SWCFsmContext* context );
+#endif
+#ifdef FSM_HIERARCHY
+extern fsm_error_t                  swcFsmBuildHierarchy( SWCFsmContext* context );
+#endif
+#ifdef FSM_ROUTE
+extern void                         swcFsmBuildRoute( SWCFsmContext* context );
+#endif
 extern void                         swcFsmRoutine( SWCFsmContext* fsm );
 extern void                         swcFsmExit( SWCFsmContext* fsm );
+#ifdef FSM_ROUTINE_BATCH
+extern void                         swcFsmRoutineBatch( SWCFsmContext** fsm, fsm_index_t count );
+#endif
 extern fsm_error_t                  swcFsmTransTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* fsm );
 extern fsm_error_t                  swcFsmGoBack( fsm_bool_t bForce, SWCFsmContext* fsm );
+#ifdef FSM_DEFERRED
+extern fsm_error_t                  swcFsmRequestTransition( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* fsm );
+#endif
+#ifdef FSM_ASYNC
+extern fsm_error_t                  swcFsmResume( SWCFsmContext* fsm );
+extern fsm_state_t                  swcFsmGetPendingState( SWCFsmContext* fsm );
+extern SWCFsmActionFrame*           swcFsmActionFrame( const SWCFsmStateItem* item );
+#endif
+#ifdef FSM_ROUTE
+extern fsm_error_t                  swcFsmRouteTo( fsm_state_t state, SWCFsmContext* fsm );
+extern fsm_state_t                  swcFsmRouteNext( fsm_state_t from, fsm_state_t state, SWCFsmContext* fsm );
+#endif
 
 extern fsm_state_t                  swcFsmGetCurState( SWCFsmContext* fsm );
 extern fsm_state_t                  swcFsmGetPreState( SWCFsmContext* fsm );
+#ifdef FSM_CONCURRENT
+extern fsm_bool_t                   swcFsmReadState( fsm_state_t* curState, fsm_state_t* preState, uint32_t* sequence, SWCFsmContext* fsm );
+#endif
+
+#ifdef FSM_EVENT_QUEUE
+extern fsm_error_t                  swcFsmPostEvent( SWCFsmContext* context, fsm_event_t event, void* payload );
+extern uint32_t                     swcFsmDispatch( SWCFsmContext* context );
+#endif
+
+#ifdef FSM_EVENT_TABLE
+extern fsm_error_t                  swcFsmBindEventTable( SWCFsmEventTable* table );
+extern fsm_error_t                  swcFsmHandleEvent( fsm_event_t event, SWCFsmContext* context );
+#endif
+
+#ifdef FSM_DFA
+extern fsm_error_t                  swcFsmDfaBuild( SWCFsmEventTable* table, SWCFsmDfa* dfa );
+extern fsm_index_t                  swcFsmDfaStep( fsm_index_t* slots, const fsm_event_t* events, fsm_index_t count, uint64_t* undefined, const SWCFsmDfa* dfa );
+#endif
+
+#ifdef FSM_BUILDER
+extern fsm_error_t                  swcFsmBuilderInit( void* arena, uint64_t arenaSize, fsm_index_t stateCapacity, fsm_index_t transCapacity, SWCFsmBuilder* builder );
+extern fsm_error_t                  swcFsmBuilderAddState( const SWCFsmStateItem* state, SWCFsmBuilder* builder );
+extern fsm_error_t                  swcFsmBuilderAddTransition( const SWCFsmTransItem* trans, SWCFsmBuilder* builder );
+extern fsm_error_t                  swcFsmBuilderFinish( fsm_context_id_t fsmID, ptrSWCFunTransferCheck fsmCommonCheck, ptrSWCFsmErrorHandler fsmErrorHandler, fsm_state_t fsmInitState,
+                                                         uint32_t fsmRoutineInterval, ptrSWCFunFSMAction fsmInit, ptrSWCFunFSMAction fsmRoutine, ptrSWCFunFSMAction fsmExit, SWCFsmBuilder* builder );
+#endif
+
+#ifdef FSM_INSTANCE_POOL
+extern fsm_error_t                  swcFsmPoolInit( SWCFsmInstancePool* pool );
+extern fsm_error_t                  swcFsmInstanceInit( fsm_index_t instance, SWCFsmInstancePool* pool );
+extern fsm_error_t                  swcFsmInstanceTransTo( fsm_state_t state, fsm_bool_t bForce, fsm_index_t instance, SWCFsmInstancePool* pool );
+extern void                         swcFsmInstanceRoutine( fsm_index_t instance, SWCFsmInstancePool* pool );
+extern void                         swcFsmInstanceExit( fsm_index_t instance, SWCFsmInstancePool* pool );
+extern fsm_state_t                  swcFsmInstanceGetCurState( fsm_index_t instance, SWCFsmInstancePool* pool );
+extern fsm_state_t                  swcFsmInstanceGetPreState( fsm_index_t instance, SWCFsmInstancePool* pool );
+extern void*                        swcFsmInstanceGetUserData( void* owner );
+#ifdef FSM_EVENT_TABLE
+extern fsm_error_t                  swcFsmInstanceHandleEvent( fsm_event_t event, fsm_index_t instance, SWCFsmInstancePool* pool );
+#endif
+#endif
+
+#ifdef FSM_SHARD_POOL
+extern fsm_error_t                  swcFsmShardPoolInit( SWCFsmShardPool* shardPool );
+extern fsm_error_t                  swcFsmShardPin( fsm_index_t shard, int32_t cpu, SWCFsmShardPool* shardPool );
+extern SWCFsmInstancePool*          swcFsmShardGet( fsm_index_t shard, SWCFsmShardPool* shardPool );
+extern fsm_index_t                  swcFsmShardAlloc( fsm_index_t shard, SWCFsmShardPool* shardPool );
+extern fsm_error_t                  swcFsmShardFree( fsm_index_t instance, fsm_index_t shard, SWCFsmShardPool* shardPool );
+extern fsm_index_t                  swcFsmShardPick( int32_t node, SWCFsmShardPool* shardPool );
+#endif
+
+#ifdef FSM_STATS
+extern fsm_error_t                  swcFsmStatsSnapshot( SWCFsmStateStats* states, SWCFsmTransStats* trans, fsm_bool_t bReset, SWCFsmContext* context );
+extern void                         swcFsmStatsReset( SWCFsmContext* context );
+extern uint64_t                     swcFsmStatsPercentile( const SWCFsmLatency* latency, uint32_t permille );
+#endif
+
+#ifdef FSM_TRACE
+extern fsm_error_t                  swcFsmTraceAttach( SWCFsmContext* context, SWCFsmTraceRing* ring );
+extern fsm_index_t                  swcFsmTraceDump( SWCFsmTraceRing* ring, SWCFsmTraceRecord* records, fsm_index_t size );
+extern int                          swcFsmTraceDecode( const SWCFsmTraceRecord* record, char* buffer, size_t size );
+#endif
+
+#ifdef FSM_RECORD
+extern fsm_error_t                  swcFsmRecordAttach( SWCFsmContext* context, SWCFsmRecorder* recorder );
+extern uint32_t                     swcFsmRecordCount( SWCFsmRecorder* recorder );
+extern fsm_error_t                  swcFsmReplayBind( SWCFsmContext* context, SWCFsmReplayState* replay );
+extern uint32_t                     swcFsmReplay( const SWCFsmRecord* records, uint32_t count, uint32_t shard, uint32_t shardCount, SWCFsmReplayState* states, fsm_index_t size );
+#endif
+
+#ifdef FSM_ERROR_QUEUE
+extern fsm_error_t                  swcFsmErrorQueueAttach( SWCFsmContext* context, SWCFsmErrorQueue* queue );
+extern uint32_t                     swcFsmErrorDrain( SWCFsmErrorRecord* records, uint32_t size, SWCFsmErrorQueue* queue );
+#endif
+
+#ifdef FSM_REGISTRY
+extern fsm_error_t                  swcFsmRegistryAdd( SWCFsmContext* context, SWCFsmRegistry* registry );
+extern fsm_error_t                  swcFsmRegistryRemove( SWCFsmContext* context, SWCFsmRegistry* registry );
+extern uint32_t                     swcFsmRegistryForEach( ptrSWCFsmRegistryVisit visit, void* arg, SWCFsmRegistry* registry );
+#ifdef FSM_EVENT_QUEUE
+extern fsm_error_t                  swcFsmRegistryPostEvent( fsm_context_id_t id, fsm_event_t event, void* payload, SWCFsmRegistry* registry );
+#endif
+#endif
+
+#ifdef FSM_TIMER_WHEEL
+extern fsm_error_t                  swcFsmWheelAdd( SWCFsmContext* context, SWCFsmTimerWheel* wheel );
+extern void                         swcFsmWheelRemove( SWCFsmContext* context );
+extern uint32_t                     swcFsmWheelAdvance( SWCFsmTimerWheel* wheel, uint32_t elapsed );
+extern uint32_t                     swcFsmWheelNextDue( SWCFsmTimerWheel* wheel );
+#endif
+
+#ifdef FSM_SNAPSHOT
+extern uint64_t                     swcFsmTableHash( uint64_t hash, SWCFsmContext* context );
+extern fsm_error_t                  swcFsmSnapshotAdd( SWCFsmContext* context, void* blob, uint64_t blobSize, SWCFsmSnapshot* snapshot );
+#ifdef FSM_INSTANCE_POOL
+extern fsm_error_t                  swcFsmSnapshotAddPool( SWCFsmInstancePool* pool, void* blob, uint64_t blobSize, SWCFsmSnapshot* snapshot );
+#endif
+extern fsm_error_t                  swcFsmSnapshotSave( SWCFsmSnapshot* snapshot, const char* path );
+extern fsm_error_t                  swcFsmSnapshotRestore( SWCFsmSnapshot* snapshot, const char* path );
+#endif
+
+#ifdef FSM_SCHEDULER
+extern fsm_error_t                  swcFsmSchedulerAdd( SWCFsmContext* context, SWCFsmScheduler* scheduler );
+extern fsm_error_t                  swcFsmSchedulerStart( SWCFsmScheduler* scheduler );
+extern void                         swcFsmSchedulerStop( SWCFsmScheduler* scheduler );
+#endif
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,676 @@
+/**
+ * @file        SWC_Fsm.hpp
+ * @author      ddkv587 ( ddkv587@gmail.com )
+ * @brief       C++17 compile-time front-end of SWC_Fsm.h
+ * @date        2026-10-17
+ * @details     states and transitions are given as types, the same ones DECLARE_SWC_FSM_CONTEXT takes
+ *              as initializers. Guards and actions are template arguments, so every call is direct and
+ *              can be inlined, and dispatch on the current slot or target state is a chain of compares
+ *              against constants that the compiler lowers to a switch. The machine works on a plain
+ *              SWCFsmContext, C modules can drive the same context with swcFsmTransTo and friends.
+ * @copyright   Copyright (c) 2026
+ * @note
+ * sdk:
+ * platform:
+ * project:     swctool
+ * @version
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author          <th>Description
+ * <tr><td>2026/10/17  <td>1.15     <td>                <td>init version
+ * <tr><td>2026/10/18  <td>1.22     <td>                <td>add C++20 coroutine actions for FSM_ASYNC
+ * </table>
+ */
+#ifndef SWC_FSM_HPP_
+#define SWC_FSM_HPP_
+
+#if __cplusplus < 201703L
+#error "SWC_Fsm.hpp requires C++17"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "SWC_Fsm.h"
+
+#if defined( FSM_ASYNC ) && defined( __cpp_impl_coroutine )
+#include <coroutine>
+#endif
+
+#if defined( FSM_NO_IMPL ) && ( defined( FSM_CONCURRENT ) || defined( FSM_TIMER_WHEEL ) )
+#error "SWC_Fsm.hpp needs the inline implementation for FSM_CONCURRENT and FSM_TIMER_WHEEL, do not define FSM_IMPLEMENTATION"
+#endif
+
+namespace swc {
+namespace fsm {
+
+// one state, the counterpart of DECLARE_SWC_FSM_STATE
+template< fsm_state_t _state, ptrSWCFunTransferAction _entry = nullptr, ptrSWCFunTransferAction _routine = nullptr,
+          ptrSWCFunTransferAction _exit = nullptr, uint32_t _routineInterval = 0U >
+struct State
+{
+    static constexpr fsm_state_t                state           = _state;
+    static constexpr ptrSWCFunTransferAction    entry           = _entry;
+    static constexpr ptrSWCFunTransferAction    routine         = _routine;
+    static constexpr ptrSWCFunTransferAction    exit            = _exit;
+    static constexpr uint32_t                   routineInterval = _routineInterval;
+};
+
+// one row of the transition table, the counterpart of DECLARE_SWC_FSM_TRANSITION
+template< fsm_state_t _curState, fsm_state_t _nextState, ptrSWCFunTransferCheck _transCheck = nullptr >
+struct Trans
+{
+    static constexpr fsm_state_t                curState        = _curState;
+    static constexpr fsm_state_t                nextState       = _nextState;
+    static constexpr ptrSWCFunTransferCheck     transCheck      = _transCheck;
+};
+
+template< typename... _states >
+struct States {};
+
+template< typename... _trans >
+struct Transitions {};
+
+/**
+ * compile-time machine, the arguments follow DECLARE_SWC_FSM_CONTEXT except the error handler, which
+ * stays a field of the context since it only runs on failures.
+ */
+template< fsm_context_id_t _fsmID, typename _fsmStateList, typename _fsmTransTable, ptrSWCFunTransferCheck _fsmCommonCheck,
+          fsm_state_t _fsmInitState, uint32_t _fsmRoutineInterval, ptrSWCFunFSMAction _fsmInit = nullptr,
+          ptrSWCFunFSMAction _fsmRoutine = nullptr, ptrSWCFunFSMAction _fsmExit = nullptr >
+class Machine;
+
+template< fsm_context_id_t _fsmID, typename... _states, typename... _trans, ptrSWCFunTransferCheck _fsmCommonCheck,
+          fsm_state_t _fsmInitState, uint32_t _fsmRoutineInterval, ptrSWCFunFSMAction _fsmInit,
+          ptrSWCFunFSMAction _fsmRoutine, ptrSWCFunFSMAction _fsmExit >
+class Machine< _fsmID, States< _states... >, Transitions< _trans... >, _fsmCommonCheck, _fsmInitState, _fsmRoutineInterval,
+               _fsmInit, _fsmRoutine, _fsmExit >
+{
+public:
+    static constexpr fsm_index_t        stateSize       = sizeof...( _states );
+    static constexpr fsm_index_t        transitionSize  = sizeof...( _trans );
+
+private:
+    using StateTuple = std::tuple< _states... >;
+
+    template< fsm_index_t _slot >
+    using StateAt = std::tuple_element_t< _slot, StateTuple >;
+
+    static constexpr std::array< fsm_state_t, stateSize >       s_stateIds  = { { _states::state... } };
+    static constexpr std::array< fsm_state_t, transitionSize >  s_transCur  = { { _trans::curState... } };
+    static constexpr std::array< fsm_state_t, transitionSize >  s_transNext = { { _trans::nextState... } };
+
+public:
+    // slot of state in fsmStateList, DEF_SWC_FSM_INDEX_INVALID when it is not declared
+    static constexpr fsm_index_t slotOf( fsm_state_t state )
+    {
+        for ( fsm_index_t slot = 0; slot < stateSize; ++slot ) {
+            if ( s_stateIds[ slot ] == state )  return slot;
+        }
+
+        return DEF_SWC_FSM_INDEX_INVALID;
+    }
+
+    // the forced path of swcFsmTransTo only accepts states that some row leads to
+    static constexpr bool isTarget( fsm_state_t state )
+    {
+        for ( fsm_index_t index = 0; index < transitionSize; ++index ) {
+            if ( s_transNext[ index ] == state )    return true;
+        }
+
+        return false;
+    }
+
+private:
+    static constexpr bool uniqueStates()
+    {
+        for ( fsm_index_t slot = 0; slot < stateSize; ++slot ) {
+            if ( ( s_stateIds[ slot ] == DEF_SWC_FSM_STATE_INVALID ) || ( slotOf( s_stateIds[ slot ] ) != slot ) )   return false;
+        }
+
+        return true;
+    }
+
+    // FSM_STATE_FF indexes fsmStateList by state id
+    static constexpr bool idsAreSlots()
+    {
+        for ( fsm_index_t slot = 0; slot < stateSize; ++slot ) {
+            if ( s_stateIds[ slot ] != slot )   return false;
+        }
+
+        return true;
+    }
+
+    static constexpr bool knownEndpoints()
+    {
+        for ( fsm_index_t index = 0; index < transitionSize; ++index ) {
+            if ( ( slotOf( s_transCur[ index ] ) == DEF_SWC_FSM_INDEX_INVALID ) || \
+                ( slotOf( s_transNext[ index ] ) == DEF_SWC_FSM_INDEX_INVALID ) )    return false;
+        }
+
+        return true;
+    }
+
+    // a second row with the same ( curState, nextState ) would never be taken
+    static constexpr bool uniqueTransitions()
+    {
+        for ( fsm_index_t index = 0; index < transitionSize; ++index ) {
+            for ( fsm_index_t other = 0; other < index; ++other ) {
+                if ( ( s_transCur[ index ] == s_transCur[ other ] ) && ( s_transNext[ index ] == s_transNext[ other ] ) )  return false;
+            }
+        }
+
+        return true;
+    }
+
+    // every state can be reached from the init state through the table
+    static constexpr bool allReachable()
+    {
+        std::array< bool, stateSize > seen = {};
+        bool bGrown = true;
+
+        seen[ slotOf( _fsmInitState ) ] = true;
+        while ( bGrown ) {
+            bGrown = false;
+            for ( fsm_index_t index = 0; index < transitionSize; ++index ) {
+                if ( seen[ slotOf( s_transCur[ index ] ) ] && !seen[ slotOf( s_transNext[ index ] ) ] ) {
+                    seen[ slotOf( s_transNext[ index ] ) ] = true;
+                    bGrown = true;
+                }
+            }
+        }
+        for ( fsm_index_t slot = 0; slot < stateSize; ++slot ) {
+            if ( !seen[ slot ] )    return false;
+        }
+
+        return true;
+    }
+
+    static_assert( ( stateSize > 0 ) && ( transitionSize > 0 ), "a machine needs at least one state and one transition" );
+    static_assert( stateSize < DEF_SWC_FSM_STATE_INVALID, "too many states" );
+    static_assert( uniqueStates(), "duplicate or invalid state id in the state list" );
+#ifdef FSM_STATE_FF
+    static_assert( idsAreSlots(), "FSM_STATE_FF needs the state at slot n to have id n" );
+#endif
+    static_assert( slotOf( _fsmInitState ) != DEF_SWC_FSM_INDEX_INVALID, "init state is not in the state list" );
+    static_assert( isTarget( _fsmInitState ), "init state is not the target of any transition, swcFsmInit could not enter it" );
+    static_assert( knownEndpoints(), "transition from or to a state that is not in the state list" );
+    static_assert( uniqueTransitions(), "duplicate transition, only the first row would ever be taken" );
+    static_assert( allReachable(), "unreachable state, no path of transitions leads to it from the init state" );
+
+    template< typename _state >
+    static SWCFsmStateItem makeStateItem()
+    {
+        SWCFsmStateItem item = {};
+
+        item.state              = _state::state;
+        item.entry              = _state::entry;
+        item.routine            = _state::routine;
+        item.exit               = _state::exit;
+        item.routineInterval    = _state::routineInterval;
+#ifdef FSM_TIMER_WHEEL
+        item.timeoutState       = DEF_SWC_FSM_STATE_INVALID;
+#endif
+#ifdef FSM_HIERARCHY
+        item.parent             = DEF_SWC_FSM_STATE_INVALID;
+#endif
+        return item;
+    }
+
+    template< typename _row >
+    static SWCFsmTransItem makeTransItem()
+    {
+        SWCFsmTransItem item = {};
+
+        item.curState           = _row::curState;
+        item.nextState          = _row::nextState;
+        item.transCheck         = _row::transCheck;
+        return item;
+    }
+
+    // the tables swcFsm* functions see, one set per machine type like DECLARE_SWC_FSM_CONTEXT
+    static inline SWCFsmStateItem   s_fsmState[ stateSize ]             = { makeStateItem< _states >()... };
+    static inline SWCFsmTransItem   s_fsmTransTable[ transitionSize ]   = { makeTransItem< _trans >()... };
+    static inline fsm_index_t       s_fsmTransOffset[ stateSize + 1 ]   = {};
+    static inline SWCFsmTransEdge   s_fsmTransEdge[ transitionSize ]    = {};
+    static inline fsm_bool_t        s_fsmStateTarget[ stateSize ]       = {};
+
+    // fn( std::integral_constant< fsm_index_t, slot > ) for the slot equal to the runtime one, if any
+    template< typename _fn, std::size_t... _slot >
+    static bool onSlot( fsm_index_t slot, _fn&& fn, std::index_sequence< _slot... > )
+    {
+        return ( ( ( slot == _slot ) ? ( fn( std::integral_constant< fsm_index_t, _slot >{} ), true ) : false ) || ... );
+    }
+
+    template< typename _fn >
+    static bool onSlot( fsm_index_t slot, _fn&& fn )
+    {
+        return onSlot( slot, std::forward< _fn >( fn ), std::make_index_sequence< stateSize >{} );
+    }
+
+    // same as onSlot, keyed by state id
+    template< typename _fn, std::size_t... _slot >
+    static bool onState( fsm_state_t state, _fn&& fn, std::index_sequence< _slot... > )
+    {
+        return ( ( ( state == s_stateIds[ _slot ] ) ? ( fn( std::integral_constant< fsm_index_t, _slot >{} ), true ) : false ) || ... );
+    }
+
+    template< fsm_index_t _slot, ptrSWCFunTransferAction _action >
+    static fsm_error_t callAction( SWCFsmContext* context )
+    {
+        if constexpr ( _action != nullptr ) {
+            return _action( &( context->fsmStateList[ _slot ] ) );
+        } else {
+            UNUSED( context );
+            return FSM_OK;
+        }
+    }
+
+    template< fsm_index_t _nextSlot >
+    static fsm_error_t enter( SWCFsmContext* context )
+    {
+        constexpr fsm_state_t state = s_stateIds[ _nextSlot ];
+
+        if ( callAction< _nextSlot, StateAt< _nextSlot >::entry >( context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_ENTRY_FAILED, context->curState, state );
+            return FSM_ERR_ENTRY_FAILED;
+        }
+
+        if ( context->curState != state ) {
+            context->preState = context->curState;
+        }
+        context->curState = state;
+        context->curSlot = _nextSlot;
+
+#ifdef FSM_TIMER_WHEEL
+        if ( context->fsmTimerWheel )   swcFsmWheelArmState( &( context->fsmStateList[ _nextSlot ] ), context );
+#endif
+        return FSM_OK;
+    }
+
+    template< fsm_index_t _curSlot >
+    static fsm_error_t leave( fsm_state_t state, SWCFsmContext* context )
+    {
+        if ( callAction< _curSlot, StateAt< _curSlot >::exit >( context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, state );
+            return FSM_ERR_EXIT_FAILED;
+        }
+
+        return FSM_OK;
+    }
+
+    template< fsm_index_t _curSlot, typename _row >
+    static fsm_error_t take( SWCFsmContext* context )
+    {
+        constexpr fsm_index_t nextSlot = slotOf( _row::nextState );
+        fsm_error_t ret = FSM_OK;
+
+        if constexpr ( _fsmCommonCheck != nullptr ) {
+            if ( _fsmCommonCheck( _row::curState, _row::nextState, context ) != DEF_FSM_TRUE ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_CHECK_FAILED, _row::curState, _row::nextState );
+                return FSM_ERR_CHECK_FAILED;
+            }
+        }
+        if constexpr ( _row::transCheck != nullptr ) {
+            if ( _row::transCheck( _row::curState, _row::nextState, context ) != DEF_FSM_TRUE ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_CHECK_FAILED, _row::curState, _row::nextState );
+                return FSM_ERR_CHECK_FAILED;
+            }
+        }
+
+        ret = leave< _curSlot >( _row::nextState, context );
+        return ( ret == FSM_OK ) ? enter< nextSlot >( context ) : ret;
+    }
+
+    // first row out of the state at _curSlot leading to state
+    template< fsm_index_t _curSlot >
+    static bool takeFrom( fsm_state_t state, fsm_error_t* ret, SWCFsmContext* context )
+    {
+        return ( ( ( ( _trans::curState == s_stateIds[ _curSlot ] ) && ( state == _trans::nextState ) ) ? \
+            ( *ret = take< _curSlot, _trans >( context ), true ) : false ) || ... );
+    }
+
+    static fsm_error_t transCore( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+    {
+        fsm_error_t ret = FSM_OK;
+        bool bTransition = false;
+
+        if ( state == DEF_SWC_FSM_STATE_INVALID ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_INVALID_STATE, context->curState, state );
+            return FSM_ERR_INVALID_STATE;
+        }
+
+        // actions run synchronously here, a transition the C functions left in flight completes first
+        if ( FSM_IN_TRANSITION( context ) ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_BUSY, context->curState, state );
+            return FSM_ERR_BUSY;
+        }
+
+        if ( ( bForce == DEF_FSM_FALSE ) && ( context->curState == state ) )   return FSM_OK;
+
+        if ( bForce == DEF_FSM_FALSE ) {
+            onSlot( context->curSlot, [ & ]( auto curSlot ) {
+                bTransition = takeFrom< decltype( curSlot )::value >( state, &ret, context );
+            } );
+        } else {
+            // skip all check, the state must be the target of some row
+            onState( state, [ & ]( auto nextSlot ) {
+                constexpr fsm_index_t slot = decltype( nextSlot )::value;
+
+                if constexpr ( isTarget( s_stateIds[ slot ] ) ) {
+                    bTransition = true;
+                    onSlot( context->curSlot, [ & ]( auto curSlot ) {
+                        ret = leave< decltype( curSlot )::value >( state, context );
+                    } );
+                    if ( ret == FSM_OK )    ret = enter< slot >( context );
+                }
+            }, std::make_index_sequence< stateSize >{} );
+        }
+
+        if ( !bTransition ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, context->curState, state );
+            return FSM_ERR_NO_TRANSITION;
+        }
+
+        return ret;
+    }
+
+public:
+    /**
+     * point context at the tables of this machine and fill the fields DECLARE_SWC_FSM_CONTEXT would,
+     * the error handler and the storage of optional features are left to the caller.
+     */
+    static fsm_error_t attach( SWCFsmContext* context )
+    {
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_NULL_CONTEXT;
+        }
+
+        context->initState          = _fsmInitState;
+        context->curState           = DEF_SWC_FSM_STATE_INVALID;
+        context->preState           = DEF_SWC_FSM_STATE_INVALID;
+        context->curSlot            = DEF_SWC_FSM_INDEX_INVALID;
+        context->fsmStateList       = s_fsmState;
+        context->fsmTransTable      = s_fsmTransTable;
+        context->fsmTransOffset     = s_fsmTransOffset;
+        context->fsmTransEdge       = s_fsmTransEdge;
+        context->fsmStateTarget     = s_fsmStateTarget;
+        context->fsmCommonCheck     = _fsmCommonCheck;
+        context->fsmStateSize       = stateSize;
+        context->fsmTransitionSize  = transitionSize;
+        context->fsmRoutineInterval = _fsmRoutineInterval;
+        context->fsmContextID       = _fsmID;
+        context->fsmInit            = _fsmInit;
+        context->fsmRoutine         = _fsmRoutine;
+        context->fsmExit            = _fsmExit;
+
+        return swcFsmBuildIndex( context );
+    }
+
+    /**
+     * whether context, e.g. one declared in C with DECLARE_SWC_FSM_CONTEXT, lists the same flat states
+     * in the same slots and the same transition rows in the same order, so this machine may drive it.
+     */
+    static bool compatible( const SWCFsmContext* context )
+    {
+        if ( !context || ( context->fsmStateSize != stateSize ) || ( context->fsmTransitionSize != transitionSize ) )   return false;
+
+        for ( fsm_index_t slot = 0; slot < stateSize; ++slot ) {
+            if ( context->fsmStateList[ slot ].state != s_stateIds[ slot ] )  return false;
+#ifdef FSM_HIERARCHY
+            // the machine only knows flat states
+            if ( context->fsmStateList[ slot ].parent != DEF_SWC_FSM_STATE_INVALID )    return false;
+#endif
+        }
+        for ( fsm_index_t index = 0; index < transitionSize; ++index ) {
+            if ( ( context->fsmTransTable[ index ].curState != s_transCur[ index ] ) || \
+                ( context->fsmTransTable[ index ].nextState != s_transNext[ index ] ) )    return false;
+        }
+
+        return true;
+    }
+
+    // swcFsmInit, the context must be attached or compatible
+    static fsm_error_t init( SWCFsmContext* context )
+    {
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_NULL_CONTEXT;
+        }
+
+        if constexpr ( _fsmInit != nullptr ) {
+            if ( _fsmInit( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_INIT_FAILED, DEF_SWC_FSM_STATE_INVALID, _fsmInitState );
+                return FSM_ERR_INIT_FAILED;
+            }
+        }
+
+        if ( !( context->fsmIndexReady ) )  swcFsmBuildIndex( context );
+        context->curSlot = DEF_SWC_FSM_INDEX_INVALID;
+        onState( context->curState, [ & ]( auto slot ) { context->curSlot = decltype( slot )::value; }, std::make_index_sequence< stateSize >{} );
+
+        if ( transTo( _fsmInitState, DEF_FSM_TRUE, context ) != FSM_OK ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NO_TRANSITION, DEF_SWC_FSM_STATE_INVALID, _fsmInitState );
+            return FSM_ERR_NO_TRANSITION;
+        }
+
+        return FSM_OK;
+    }
+
+    // swcFsmTransTo, not traced nor counted by FSM_TRACE and FSM_STATS
+    static fsm_error_t transTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+    {
+#ifdef FSM_CONCURRENT
+        uint64_t word = 0;
+        fsm_error_t ret = FSM_OK;
+#endif
+
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, state );
+            return FSM_ERR_NULL_CONTEXT;
+        }
+
+#ifdef FSM_CONCURRENT
+        if ( ( bForce == DEF_FSM_FALSE ) && ( swcFsmGetCurState( context ) == state ) )   return FSM_OK;
+        if ( swcFsmClaim( &word, context ) != FSM_OK )  return FSM_ERR_BUSY;
+
+        ret = transCore( state, bForce, context );
+        swcFsmRelease( word, context );
+        return ret;
+#else
+        return transCore( state, bForce, context );
+#endif
+    }
+
+    static fsm_error_t goBack( fsm_bool_t bForce, SWCFsmContext* context )
+    {
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return FSM_ERR_NULL_CONTEXT;
+        }
+
+        return transTo( swcFsmGetPreState( context ), bForce, context );
+    }
+
+    // swcFsmRoutine, not traced nor timed by FSM_TRACE and FSM_STATS
+    static void routine( SWCFsmContext* context )
+    {
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return;
+        }
+
+#ifdef FSM_ASYNC
+        if ( FSM_IN_TRANSITION( context ) ) {
+            swcFsmResume( context );
+            return;
+        }
+#endif
+
+        if constexpr ( _fsmRoutine != nullptr ) {
+            if ( _fsmRoutine( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            }
+        }
+
+        onSlot( context->curSlot, [ & ]( auto slot ) {
+            if ( callAction< decltype( slot )::value, StateAt< decltype( slot )::value >::routine >( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_STATE_ROUTINE_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            }
+        } );
+    }
+
+    static void exit( SWCFsmContext* context )
+    {
+        if ( !context ) {
+            FSM_ERROR_HANDLER( context, FSM_ERR_NULL_CONTEXT, DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID );
+            return;
+        }
+
+        onSlot( context->curSlot, [ & ]( auto slot ) {
+            if ( callAction< decltype( slot )::value, StateAt< decltype( slot )::value >::exit >( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            }
+        } );
+
+        if constexpr ( _fsmExit != nullptr ) {
+            if ( _fsmExit( context ) != FSM_OK ) {
+                FSM_ERROR_HANDLER( context, FSM_ERR_EXIT_FAILED, context->curState, DEF_SWC_FSM_STATE_INVALID );
+            }
+        }
+
+#ifdef FSM_TIMER_WHEEL
+        swcFsmWheelRemove( context );
+#endif
+    }
+};
+
+#if defined( FSM_ASYNC ) && defined( __cpp_impl_coroutine )
+/**
+ * C++20 coroutine as an entry or exit action of a context driven by the C functions:
+ *
+ *   swc::fsm::Action flush( SWCFsmStateItem& state )
+ *   {
+ *       startWrite();
+ *       co_await swc::fsm::until( [] { return writeDone(); } );
+ *       co_return FSM_OK;
+ *   }
+ *
+ *   DECLARE_SWC_FSM_STATE( SAVING, swc::fsm::asyncAction< flush >, NULL, NULL, 0 )
+ *
+ * the body runs up to its first suspension inside the transition, which then returns FSM_PENDING.
+ * each later call, from swcFsmRoutine through swcFsmResume, checks the awaited condition and resumes
+ * the body only once it holds. co_return ends the action with its result.
+ */
+class Action
+{
+public:
+    struct promise_type
+    {
+        fsm_error_t                 result          = FSM_OK;
+        bool                        ( *poll )( void* awaiter ) = nullptr;      // nullptr resumes on the next call
+        void*                       awaiter         = nullptr;
+
+        Action get_return_object() noexcept { return Action( std::coroutine_handle< promise_type >::from_promise( *this ) ); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value( fsm_error_t ret ) noexcept { result = ret; }
+        void unhandled_exception() noexcept { result = FSM_ERR_UNKNOWN; }
+    };
+
+    Action( Action&& other ) noexcept : m_handle( std::exchange( other.m_handle, nullptr ) ) {}
+    Action( const Action& ) = delete;
+    Action& operator=( const Action& ) = delete;
+    Action& operator=( Action&& ) = delete;
+    ~Action() { if ( m_handle )  m_handle.destroy(); }
+
+    std::coroutine_handle< promise_type > release() noexcept { return std::exchange( m_handle, nullptr ); }
+
+private:
+    explicit Action( std::coroutine_handle< promise_type > handle ) noexcept : m_handle( handle ) {}
+
+    std::coroutine_handle< promise_type >   m_handle;
+};
+
+// suspend until the next call of the action
+struct Yield
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend( std::coroutine_handle< Action::promise_type > handle ) const noexcept { handle.promise().poll = nullptr; }
+    void await_resume() const noexcept {}
+};
+
+inline Yield yield() noexcept { return {}; }
+
+// suspend until ready() holds, polled by each call of the action without resuming the body
+template< typename _ready >
+struct Until
+{
+    _ready                          ready;
+
+    bool await_ready() { return ready(); }
+    void await_suspend( std::coroutine_handle< Action::promise_type > handle ) noexcept
+    {
+        handle.promise().poll       = []( void* awaiter ) -> bool { return static_cast< Until* >( awaiter )->ready(); };
+        handle.promise().awaiter    = this;
+    }
+    void await_resume() const noexcept {}
+};
+
+template< typename _ready >
+Until< std::decay_t< _ready > > until( _ready&& ready ) { return { std::forward< _ready >( ready ) }; }
+
+// frees the frame of a coroutine whose transition was dropped
+inline void releaseAction( void* frame )
+{
+    std::coroutine_handle< Action::promise_type >::from_address( frame ).destroy();
+}
+
+/**
+ * the plain action running _coroutine, its frame is kept by the owner of the transition while
+ * suspended, see swcFsmActionFrame. a transition dropped by swcFsmExit frees it, and so does a pooled
+ * instance or swc::fsm::Machine, which fail the transition instead of waiting.
+ */
+template< Action ( *_coroutine )( SWCFsmStateItem& ) >
+fsm_error_t asyncAction( void* item )
+{
+    SWCFsmStateItem* state = static_cast< SWCFsmStateItem* >( item );
+    SWCFsmActionFrame* frame = swcFsmActionFrame( state );
+    std::coroutine_handle< Action::promise_type > handle;
+    fsm_error_t ret = FSM_OK;
+
+    if ( frame && frame->frame ) {
+        handle = std::coroutine_handle< Action::promise_type >::from_address( frame->frame );
+        if ( !( handle.promise().poll ) || handle.promise().poll( handle.promise().awaiter ) )  handle.resume();
+    } else {
+        handle = _coroutine( *state ).release();
+    }
+
+    if ( !handle.done() ) {
+        if ( frame ) {
+            frame->frame    = handle.address();
+            frame->release  = releaseAction;
+        } else {
+            handle.destroy();
+        }
+        return FSM_PENDING;
+    }
+
+    ret = handle.promise().result;
+    handle.destroy();
+    if ( frame ) {
+        frame->frame    = nullptr;
+        frame->release  = nullptr;
+    }
+
+    return ret;
+}
+#endif
+
+} // namespace fsm
+} // namespace swc
+
+#endif
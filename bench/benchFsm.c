@@ -0,0 +1,311 @@
+/**
+ * @file        benchFsm.c
+ * @brief       microbenchmarks of swcFsmTransTo, swcFsmRoutine and swcFsmGetStateItem
+ * @details     every state s of a generated machine has two outgoing transitions, s -> s + 1 and
+ *              s -> ( 7s + 3 ) mod N, for N from 4 to 65535 states. Each operation is timed over
+ *              enough iterations to run for at least DEF_BENCH_MIN_NS and reported as ns/op, with
+ *              last level cache misses per op when perf_event_open is available.
+ *              The state lookup ( linear, FSM_STATE_FF, FSM_STATE_MAP ) and the build ( header-only
+ *              or FSM_IMPLEMENTATION ) are chosen at compile time, see bench/CMakeLists.txt; the
+ *              transition guard is toggled at run time.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "SWC_Fsm.h"
+
+#if defined( FSM_STATE_FF )
+#define BENCH_LOOKUP                    "ff"
+#elif defined( FSM_STATE_MAP )
+#define BENCH_LOOKUP                    "map"
+#else
+#define BENCH_LOOKUP                    "linear"
+#endif
+
+#ifdef FSM_IMPLEMENTATION
+#define BENCH_BUILD                     "impl"
+#else
+#define BENCH_BUILD                     "header"
+#endif
+
+#define DEF_BENCH_MIN_NS                ( 50000000ULL )     // 50ms per measurement
+#define DEF_BENCH_LOOKUP_IDS            ( 4096U )           // power of 2
+
+typedef struct
+{
+    SWCFsmContext                   context;
+    SWCFsmStateItem*                states;
+    SWCFsmTransItem*                trans;
+    fsm_index_t*                    offset;
+    SWCFsmTransEdge*                edge;
+    fsm_bool_t*                     target;
+#ifdef FSM_STATE_MAP
+    fsm_index_t*                    map;
+#endif
+    fsm_state_t*                    ids;                // random lookup keys
+} BenchFsm;
+
+typedef void            ( *ptrBenchOp )( BenchFsm* fsm, uint64_t iterations );
+
+static volatile uintptr_t   s_benchSink = 0U;
+static int                  s_benchPerf = -1;
+
+static fsm_error_t benchAction( void* item )
+{
+    UNUSED( item );
+    return FSM_OK;
+}
+
+static fsm_bool_t benchGuard( fsm_state_t from, fsm_state_t to, void* context )
+{
+    UNUSED( context );
+    return ( from != to ) ? DEF_FSM_TRUE : DEF_FSM_FALSE;
+}
+
+static uint64_t benchNow( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t )ts.tv_sec * 1000000000ULL + ( uint64_t )ts.tv_nsec;
+}
+
+static void benchPerfOpen( void )
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+
+    memset( &attr, 0, sizeof( attr ) );
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof( attr );
+    attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    s_benchPerf = ( int )syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+#endif
+}
+
+static void benchPerfStart( void )
+{
+#ifdef __linux__
+    if ( s_benchPerf >= 0 ) {
+        ioctl( s_benchPerf, PERF_EVENT_IOC_RESET, 0 );
+        ioctl( s_benchPerf, PERF_EVENT_IOC_ENABLE, 0 );
+    }
+#endif
+}
+
+// cache misses since benchPerfStart, -1 when not counted
+static int64_t benchPerfStop( void )
+{
+#ifdef __linux__
+    uint64_t value = 0U;
+
+    if ( s_benchPerf >= 0 ) {
+        ioctl( s_benchPerf, PERF_EVENT_IOC_DISABLE, 0 );
+        if ( read( s_benchPerf, &value, sizeof( value ) ) == ( ssize_t )sizeof( value ) ) {
+            return ( int64_t )value;
+        }
+    }
+#endif
+    return -1;
+}
+
+static fsm_error_t benchFsmCreate( BenchFsm* fsm, fsm_index_t stateSize )
+{
+    fsm_index_t transSize = stateSize * 2U;
+    uint32_t seed = 0x2545F491U;
+    fsm_index_t i;
+
+    memset( fsm, 0, sizeof( BenchFsm ) );
+    fsm->states = ( SWCFsmStateItem* )calloc( stateSize, sizeof( SWCFsmStateItem ) );
+    fsm->trans  = ( SWCFsmTransItem* )calloc( transSize, sizeof( SWCFsmTransItem ) );
+    fsm->offset = ( fsm_index_t* )calloc( stateSize + 1U, sizeof( fsm_index_t ) );
+    fsm->edge   = ( SWCFsmTransEdge* )calloc( transSize, sizeof( SWCFsmTransEdge ) );
+    fsm->target = ( fsm_bool_t* )calloc( stateSize, sizeof( fsm_bool_t ) );
+    fsm->ids    = ( fsm_state_t* )calloc( DEF_BENCH_LOOKUP_IDS, sizeof( fsm_state_t ) );
+#ifdef FSM_STATE_MAP
+    fsm->map    = ( fsm_index_t* )calloc( DEF_SWC_FSM_STATE_MAP_SIZE( stateSize ), sizeof( fsm_index_t ) );
+    if ( !fsm->map ) {
+        return FSM_ERR_INIT_FAILED;
+    }
+#endif
+    if ( !fsm->states || !fsm->trans || !fsm->offset || !fsm->edge || !fsm->target || !fsm->ids ) {
+        return FSM_ERR_INIT_FAILED;
+    }
+
+    for ( i = 0U; i < stateSize; ++i ) {
+        fsm->states[ i ].state   = ( fsm_state_t )i;
+        fsm->states[ i ].routine = benchAction;
+        fsm->trans[ i * 2U ].curState       = ( fsm_state_t )i;
+        fsm->trans[ i * 2U ].nextState      = ( fsm_state_t )( ( i + 1U ) % stateSize );
+        fsm->trans[ i * 2U + 1U ].curState  = ( fsm_state_t )i;
+        fsm->trans[ i * 2U + 1U ].nextState = ( fsm_state_t )( ( i * 7U + 3U ) % stateSize );
+    }
+    for ( i = 0U; i < DEF_BENCH_LOOKUP_IDS; ++i ) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        fsm->ids[ i ] = ( fsm_state_t )( seed % stateSize );
+    }
+
+    fsm->context.initState          = 0U;
+    fsm->context.curState           = DEF_SWC_FSM_STATE_INVALID;
+    fsm->context.preState           = DEF_SWC_FSM_STATE_INVALID;
+    fsm->context.fsmStateList       = fsm->states;
+    fsm->context.fsmTransTable      = fsm->trans;
+    fsm->context.fsmTransOffset     = fsm->offset;
+    fsm->context.fsmTransEdge       = fsm->edge;
+    fsm->context.fsmStateTarget     = fsm->target;
+    fsm->context.fsmStateSize       = stateSize;
+    fsm->context.fsmTransitionSize  = transSize;
+#ifdef FSM_STATE_MAP
+    fsm->context.fsmStateMap        = fsm->map;
+    fsm->context.fsmStateMapSize    = DEF_SWC_FSM_STATE_MAP_SIZE( stateSize );
+#endif
+
+    return swcFsmInit( &( fsm->context ) );
+}
+
+static void benchFsmDestroy( BenchFsm* fsm )
+{
+    free( fsm->states );
+    free( fsm->trans );
+    free( fsm->offset );
+    free( fsm->edge );
+    free( fsm->target );
+    free( fsm->ids );
+#ifdef FSM_STATE_MAP
+    free( fsm->map );
+#endif
+}
+
+static void benchFsmGuard( BenchFsm* fsm, fsm_bool_t bGuard )
+{
+    fsm_index_t i;
+
+    for ( i = 0U; i < fsm->context.fsmTransitionSize; ++i ) {
+        fsm->trans[ i ].transCheck = bGuard ? benchGuard : NULL;
+    }
+}
+
+// walks the s -> s + 1 ring
+static void benchOpTransTo( BenchFsm* fsm, uint64_t iterations )
+{
+    fsm_index_t stateSize = fsm->context.fsmStateSize;
+    fsm_index_t state = fsm->context.curState;
+    uint64_t i;
+
+    for ( i = 0U; i < iterations; ++i ) {
+        state = ( state + 1U == stateSize ) ? 0U : state + 1U;
+        s_benchSink += ( uintptr_t )swcFsmTransTo( ( fsm_state_t )state, DEF_FSM_FALSE, &( fsm->context ) );
+    }
+}
+
+static void benchOpRoutine( BenchFsm* fsm, uint64_t iterations )
+{
+    uint64_t i;
+
+    for ( i = 0U; i < iterations; ++i ) {
+        swcFsmRoutine( &( fsm->context ) );
+    }
+}
+
+static void benchOpGetStateItem( BenchFsm* fsm, uint64_t iterations )
+{
+    uintptr_t sum = 0U;
+    uint64_t i;
+
+    for ( i = 0U; i < iterations; ++i ) {
+        sum += ( uintptr_t )swcFsmGetStateItem( fsm->ids[ i & ( DEF_BENCH_LOOKUP_IDS - 1U ) ], &( fsm->context ) );
+    }
+    s_benchSink += sum;
+}
+
+static void benchRun( const char* name, ptrBenchOp op, BenchFsm* fsm, const char* guard )
+{
+    uint64_t iterations = 64U;
+    uint64_t elapsed;
+    int64_t misses;
+    char missText[ 32 ];
+
+    // grow until one run lasts DEF_BENCH_MIN_NS, which also warms the caches
+    for ( ;; ) {
+        elapsed = benchNow();
+        ( *op )( fsm, iterations );
+        elapsed = benchNow() - elapsed;
+        if ( elapsed >= DEF_BENCH_MIN_NS ) {
+            break;
+        }
+        iterations *= ( elapsed < DEF_BENCH_MIN_NS / 16U ) ? 8U : 2U;
+    }
+
+    benchPerfStart();
+    elapsed = benchNow();
+    ( *op )( fsm, iterations );
+    elapsed = benchNow() - elapsed;
+    misses = benchPerfStop();
+
+    if ( misses >= 0 ) {
+        snprintf( missText, sizeof( missText ), "%.4f", ( double )misses / ( double )iterations );
+    } else {
+        snprintf( missText, sizeof( missText ), "n/a" );
+    }
+    printf( "%-18s %-7s %-7s %-6s %8u %8u %10.2f %12s\n", name, BENCH_LOOKUP, BENCH_BUILD, guard,
+            ( unsigned )fsm->context.fsmStateSize, ( unsigned )fsm->context.fsmTransitionSize,
+            ( double )elapsed / ( double )iterations, missText );
+    fflush( stdout );
+}
+
+int main( int argc, char* argv[] )
+{
+    static const fsm_index_t sizes[] = { 4U, 64U, 1024U, 16384U, 65535U };
+    fsm_index_t maxSize = 65535U;
+    BenchFsm fsm;
+    size_t i;
+
+    // optional upper bound on the state count, e.g. to keep the linear lookup runs short
+    if ( argc > 1 ) {
+        maxSize = ( fsm_index_t )strtoul( argv[ 1 ], NULL, 0 );
+    }
+
+    benchPerfOpen();
+    printf( "%-18s %-7s %-7s %-6s %8s %8s %10s %12s\n", "op", "lookup", "build", "guard", "states", "trans", "ns/op", "misses/op" );
+
+    for ( i = 0U; i < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++i ) {
+        if ( sizes[ i ] > maxSize ) {
+            break;
+        }
+        if ( benchFsmCreate( &fsm, sizes[ i ] ) != FSM_OK ) {
+            fprintf( stderr, "failed to create a machine of %u states\n", ( unsigned )sizes[ i ] );
+            benchFsmDestroy( &fsm );
+            return 1;
+        }
+
+        benchFsmGuard( &fsm, DEF_FSM_FALSE );
+        benchRun( "swcFsmTransTo", benchOpTransTo, &fsm, "none" );
+        benchFsmGuard( &fsm, DEF_FSM_TRUE );
+        benchRun( "swcFsmTransTo", benchOpTransTo, &fsm, "table" );
+        benchRun( "swcFsmRoutine", benchOpRoutine, &fsm, "-" );
+        benchRun( "swcFsmGetStateItem", benchOpGetStateItem, &fsm, "-" );
+
+        swcFsmExit( &( fsm.context ) );
+        benchFsmDestroy( &fsm );
+    }
+
+#ifdef __linux__
+    if ( s_benchPerf >= 0 ) {
+        close( s_benchPerf );
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,6 @@
+/**
+ * @file        benchImpl.c
+ * @brief       provides the functions that benchFsm.c declares extern under FSM_IMPLEMENTATION
+ */
+#define FSM_FUNC
+#include "SWC_Fsm.h"
@@ -0,0 +1,74 @@
+/**
+ * @file        doorFsm.c
+ * @brief       state machine from examples/door.fsm, tables generated by tools/fsmc at build time
+ */
+#include <stdio.h>
+#include "doorFsmTables.h"
+
+static uint32_t s_doorTravel = 0;
+static fsm_bool_t s_doorBlocked = DEF_FSM_FALSE;
+
+fsm_error_t doorClosedEntry( void* state )      { UNUSED( state ); printf( "door closed\n" ); return FSM_OK; }
+fsm_error_t doorOpenEntry( void* state )        { UNUSED( state ); printf( "door open\n" ); return FSM_OK; }
+fsm_error_t doorLockedEntry( void* state )      { UNUSED( state ); printf( "door locked\n" ); return FSM_OK; }
+fsm_error_t doorMotorOn( void* state )          { UNUSED( state ); s_doorTravel = 0; printf( "motor on\n" ); return FSM_OK; }
+fsm_error_t doorMotorOff( void* state )         { UNUSED( state ); printf( "motor off\n" ); return FSM_OK; }
+
+fsm_error_t doorOpeningRoutine( void* state )
+{
+    UNUSED( state );
+    if ( ++s_doorTravel >= 3U ) {
+        return swcFsmTransTo( DEF_STATE_Door_OPEN, DEF_FSM_FALSE, DECLARE_SWC_FSM_CONTEXT_REF( Door ) );
+    }
+    return FSM_OK;
+}
+
+fsm_error_t doorClosingRoutine( void* state )
+{
+    UNUSED( state );
+    if ( s_doorBlocked ) {
+        s_doorBlocked = DEF_FSM_FALSE;
+        return swcFsmTransTo( DEF_STATE_Door_OPENING, DEF_FSM_FALSE, DECLARE_SWC_FSM_CONTEXT_REF( Door ) );
+    }
+    if ( ++s_doorTravel >= 3U ) {
+        return swcFsmTransTo( DEF_STATE_Door_CLOSED, DEF_FSM_FALSE, DECLARE_SWC_FSM_CONTEXT_REF( Door ) );
+    }
+    return FSM_OK;
+}
+
+fsm_bool_t doorCanOpen( fsm_state_t from, fsm_state_t to, void* context )
+{
+    UNUSED( from );
+    UNUSED( to );
+    UNUSED( context );
+    return DEF_FSM_TRUE;
+}
+
+void doorErrorHandler( fsm_error_t error, fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( context );
+    fprintf( stderr, "door error %d: %u -> %u\n", error, curState, nextState );
+}
+
+int main( void )
+{
+    SWCFsmContext* door = DECLARE_SWC_FSM_CONTEXT_REF( Door );
+    uint32_t tick = 0;
+
+    if ( swcFsmInit( door ) != FSM_OK )     return 1;
+
+    swcFsmTransTo( DEF_STATE_Door_OPENING, DEF_FSM_FALSE, door );
+    for ( tick = 0; tick < 4U; ++tick )     swcFsmRoutine( door );
+
+    swcFsmTransTo( DEF_STATE_Door_CLOSING, DEF_FSM_FALSE, door );
+    s_doorBlocked = DEF_FSM_TRUE;
+    for ( tick = 0; tick < 8U; ++tick )     swcFsmRoutine( door );
+
+    swcFsmTransTo( DEF_STATE_Door_CLOSING, DEF_FSM_FALSE, door );
+    for ( tick = 0; tick < 4U; ++tick )     swcFsmRoutine( door );
+
+    swcFsmTransTo( DEF_STATE_Door_LOCKED, DEF_FSM_FALSE, door );
+    swcFsmExit( door );
+
+    return ( swcFsmGetCurState( door ) == DEF_STATE_Door_LOCKED ) ? 0 : 1;
+}
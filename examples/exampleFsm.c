@@ -79,7 +79,12 @@ fsm_error_t exampleFsmInnerExit( void *fsm )       { UNUSED( fsm ); printf( "exa
 fsm_error_t exampleFsmTransTo( fsm_state_t state, fsm_bool_t bForce )
 {
     printf( "exampleFsmTransTo from %d to %d, %d\n", swcFsmGetCurState( DECLARE_SWC_FSM_CONTEXT_REF( Example ) ), state, bForce ? 1 : 0 );
+#ifdef FSM_DEFERRED
+    // called from state routines, the transition is taken once the routine has returned
+    return swcFsmRequestTransition( state, bForce, DECLARE_SWC_FSM_CONTEXT_REF( Example ) );
+#else
     return swcFsmTransTo( state, bForce, DECLARE_SWC_FSM_CONTEXT_REF( Example ) );
+#endif
 }
 
 void exampleFsmErrorHandler( fsm_error_t error, fsm_state_t curState, fsm_state_t nextState, void *fsm )
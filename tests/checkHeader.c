@@ -0,0 +1,10 @@
+/**
+ * @file        checkHeader.c
+ * @brief       compiles SWC_Fsm.h under the feature flags set by tests/CMakeLists.txt
+ */
+#include "SWC_Fsm.h"
+
+int main( void )
+{
+    return ( swcFsmGetCurState( NULL ) == DEF_SWC_FSM_STATE_INVALID ) ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+/**
+ * @file        checkHeader.cpp
+ * @brief       compiles SWC_Fsm.hpp under the feature flags set by tests/CMakeLists.txt
+ */
+#include "SWC_Fsm.hpp"
+
+int main()
+{
+    return ( swcFsmGetCurState( nullptr ) == DEF_SWC_FSM_STATE_INVALID ) ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file        testAsyncTimer.c
+ * @brief       FSM_ASYNC transitions resumed by the FSM_TIMER_WHEEL
+ * @details     the entry action of WORK is pending on its first call and fails on the second,
+ *              which the 10 ms routine timer of IDLE makes while the transition is in flight. The
+ *              context stays in IDLE, whose routine must go on running afterwards.
+ */
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_IDLE_ROUTINE           ( 10U )             // ms
+
+enum
+{
+    TEST_STATE_IDLE,
+    TEST_STATE_WORK,
+};
+
+static uint32_t s_testIdleRoutines = 0U;
+static uint32_t s_testWorkEntries = 0U;
+
+static fsm_error_t testIdleRoutine( void* item )
+{
+    UNUSED( item );
+    ++s_testIdleRoutines;
+    return FSM_OK;
+}
+
+static fsm_error_t testWorkEntry( void* item )
+{
+    UNUSED( item );
+    return ( ++s_testWorkEntries == 1U ) ? FSM_PENDING : FSM_ERR_UNKNOWN;
+}
+
+DECLARE_SWC_FSM_TIMER_WHEEL( Test )
+
+DECLARE_SWC_FSM_CONTEXT( Async, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, NULL, testIdleRoutine, NULL, DEF_TEST_IDLE_ROUTINE ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_WORK, testWorkEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_WORK, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_WORK, TEST_STATE_IDLE, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, 0, NULL, NULL, NULL )
+
+int main( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Async );
+    SWCFsmTimerWheel* wheel = DECLARE_SWC_FSM_TIMER_WHEEL_REF( Test );
+    uint32_t routines = 0;
+    uint32_t elapsed = 0;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( swcFsmWheelAdd( context, wheel ) == FSM_OK );
+    swcFsmWheelAdvance( wheel, 25U );
+    TEST_CHECK( s_testIdleRoutines == 2U );
+
+    // the routine timer due at 30 ms resumes the transition instead of running the routine
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_WORK, DEF_FSM_FALSE, context ) == FSM_PENDING );
+    swcFsmWheelAdvance( wheel, 5U );
+    TEST_CHECK( s_testWorkEntries == 2U );
+    TEST_CHECK( s_testIdleRoutines == 2U );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_IDLE );
+
+    // back in IDLE, its timers are armed again
+    routines = s_testIdleRoutines;
+    for ( elapsed = 0; elapsed < 100U; ++elapsed ) {
+        TEST_CHECK( swcFsmWheelNextDue( wheel ) != DEF_SWC_FSM_WHEEL_IDLE );
+        swcFsmWheelAdvance( wheel, 1U );
+    }
+    TEST_CHECK( s_testIdleRoutines == routines + 100U / DEF_TEST_IDLE_ROUTINE );
+    TEST_CHECK( s_testWorkEntries == 2U );
+
+    swcFsmExit( context );
+    TEST_CHECK( swcFsmWheelNextDue( wheel ) == DEF_SWC_FSM_WHEEL_IDLE );
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file        testConcurrent.c
+ * @brief       FSM_CONCURRENT claims of one context by several threads
+ * @details     the entry action yields while the claim is held, so the other threads lose their
+ *              claims even on one cpu. A lost claim must return FSM_ERR_BUSY without running any
+ *              action, no two actions may overlap, and every won claim must enter exactly once.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_THREADS                ( 4U )
+#define DEF_TEST_ROUNDS                 ( 20000U )          // per thread
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+};
+
+static uint32_t s_testInside = 0U;
+static uint32_t s_testOverlaps = 0U;
+static uint32_t s_testEntries = 0U;
+static uint32_t s_testWon = 0U;
+static uint32_t s_testLost = 0U;
+static fsm_error_t s_testNested = FSM_OK;
+static SWCFsmContext* s_testNestedContext = NULL;
+
+static fsm_error_t testEntry( void* item )
+{
+    UNUSED( item );
+
+    if ( __atomic_fetch_add( &s_testInside, 1U, __ATOMIC_ACQ_REL ) != 0U ) {
+        __atomic_fetch_add( &s_testOverlaps, 1U, __ATOMIC_RELAXED );
+    }
+    ++s_testEntries;
+    sched_yield();
+    __atomic_fetch_sub( &s_testInside, 1U, __ATOMIC_ACQ_REL );
+
+    return FSM_OK;
+}
+
+// tries a transition of its own context while the claim of the running one is held
+static fsm_error_t testNestedEntry( void* item )
+{
+    UNUSED( item );
+    s_testNested = swcFsmTransTo( TEST_STATE_A, DEF_FSM_TRUE, s_testNestedContext );
+    return FSM_OK;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Shared, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, testEntry, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_CONTEXT( Nested, 2,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testNestedEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+static void* testWorker( void* arg )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Shared );
+    fsm_state_t curState = DEF_SWC_FSM_STATE_INVALID;
+    fsm_error_t ret = FSM_OK;
+    uint32_t round = 0;
+
+    UNUSED( arg );
+
+    for ( round = 0; round < DEF_TEST_ROUNDS; ++round ) {
+        // forced, so every won claim runs the entry action, even towards the state already left
+        curState = swcFsmGetCurState( context );
+        ret = swcFsmTransTo( ( curState == TEST_STATE_A ) ? TEST_STATE_B : TEST_STATE_A, DEF_FSM_TRUE, context );
+        if ( ret == FSM_OK ) {
+            __atomic_fetch_add( &s_testWon, 1U, __ATOMIC_RELAXED );
+        } else if ( ret == FSM_ERR_BUSY ) {
+            __atomic_fetch_add( &s_testLost, 1U, __ATOMIC_RELAXED );
+        }
+    }
+
+    return NULL;
+}
+
+int main( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Shared );
+    SWCFsmContext* nested = DECLARE_SWC_FSM_CONTEXT_REF( Nested );
+    pthread_t threads[ DEF_TEST_THREADS ];
+    fsm_state_t curState = DEF_SWC_FSM_STATE_INVALID;
+    fsm_state_t preState = DEF_SWC_FSM_STATE_INVALID;
+    uint32_t sequence = 0;
+    uint32_t index = 0;
+
+    // the claim is held for the whole transition, the same thread loses it too
+    s_testNestedContext = nested;
+    TEST_CHECK( swcFsmInit( nested ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, nested ) == FSM_OK );
+    TEST_CHECK( s_testNested == FSM_ERR_BUSY );
+    TEST_CHECK( swcFsmGetCurState( nested ) == TEST_STATE_B );
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( s_testEntries == 1U );
+
+    for ( index = 0; index < DEF_TEST_THREADS; ++index ) {
+        TEST_CHECK( pthread_create( &threads[ index ], NULL, testWorker, NULL ) == 0 );
+    }
+    for ( index = 0; index < DEF_TEST_THREADS; ++index ) {
+        pthread_join( threads[ index ], NULL );
+    }
+
+    TEST_CHECK( s_testOverlaps == 0U );
+    TEST_CHECK( s_testLost > 0U );
+    TEST_CHECK( s_testEntries == s_testWon + 1U );
+
+    TEST_CHECK( swcFsmReadState( &curState, &preState, &sequence, context ) );
+    TEST_CHECK( ( curState == swcFsmGetCurState( context ) ) && ( preState == swcFsmGetPreState( context ) ) );
+    TEST_CHECK( ( curState != preState ) && ( ( sequence & 1U ) == 0U ) );
+
+    return 0;
+}
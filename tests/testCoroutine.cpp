@@ -0,0 +1,113 @@
+/**
+ * @file        testCoroutine.cpp
+ * @brief       C++20 coroutine actions of FSM_ASYNC
+ * @details     the exit action of IDLE yields once and fails the first time, which ends the
+ *              transition in IDLE. The entry action of WORK yields, then waits until five calls of
+ *              swcFsmRoutine have ticked, each resuming the transition. A transition dropped by
+ *              swcFsmExit while its action is suspended frees the coroutine frame. Skipped when
+ *              the compiler has no coroutines, e.g. GCC 10 without -fcoroutines.
+ */
+#include "SWC_Fsm.hpp"
+#include "testFsm.h"
+
+#ifndef __cpp_impl_coroutine
+int main()
+{
+    return 77;
+}
+#else
+#define DEF_TEST_TICKS                  ( 5U )
+
+enum
+{
+    TEST_STATE_IDLE,
+    TEST_STATE_WORK,
+};
+
+static uint32_t s_testTicks = 0U;
+static uint32_t s_testYields = 0U;
+static uint32_t s_testFrames = 0U;              // coroutine frames alive
+static bool s_testExitFails = true;
+static bool s_testDone = false;
+
+// lives in the coroutine frame, so its destructor tells when the frame is freed
+struct TestFrame
+{
+    TestFrame() { ++s_testFrames; }
+    ~TestFrame() { --s_testFrames; }
+};
+
+static swc::fsm::Action testLeave( SWCFsmStateItem& state )
+{
+    TestFrame frame;
+
+    UNUSED( state );
+    co_await swc::fsm::yield();
+    co_return s_testExitFails ? FSM_ERR_UNKNOWN : FSM_OK;
+}
+
+static swc::fsm::Action testWork( SWCFsmStateItem& state )
+{
+    TestFrame frame;
+
+    UNUSED( state );
+    co_await swc::fsm::yield();
+    ++s_testYields;
+    co_await swc::fsm::until( [] { return ++s_testTicks >= DEF_TEST_TICKS; } );
+    s_testDone = true;
+    co_return FSM_OK;
+}
+
+static swc::fsm::Action testReady( SWCFsmStateItem& state )
+{
+    UNUSED( state );
+    co_return FSM_OK;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Async, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, swc::fsm::asyncAction< testReady >, NULL, swc::fsm::asyncAction< testLeave >, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_WORK, swc::fsm::asyncAction< testWork >, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_WORK, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_WORK, TEST_STATE_IDLE, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, 0, NULL, NULL, NULL )
+
+int main()
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Async );
+    uint32_t routines = 0;
+
+    // an action that completes without suspending leaves nothing in flight
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( ( swcFsmGetCurState( context ) == TEST_STATE_IDLE ) && !FSM_IN_TRANSITION( context ) );
+
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_WORK, DEF_FSM_FALSE, context ) == FSM_PENDING );
+    TEST_CHECK( FSM_IN_TRANSITION( context ) && ( s_testFrames == 1U ) );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_WORK, DEF_FSM_FALSE, context ) == FSM_ERR_BUSY );
+    TEST_CHECK( swcFsmResume( context ) == FSM_ERR_EXIT_FAILED );
+    TEST_CHECK( ( swcFsmGetCurState( context ) == TEST_STATE_IDLE ) && !FSM_IN_TRANSITION( context ) );
+    TEST_CHECK( ( context->fsmPending.frame.frame == nullptr ) && ( s_testFrames == 0U ) );
+
+    // swcFsmRoutine resumes the transition instead of running the routines
+    s_testExitFails = false;
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_WORK, DEF_FSM_FALSE, context ) == FSM_PENDING );
+    while ( swcFsmGetCurState( context ) != TEST_STATE_WORK ) {
+        TEST_CHECK( ++routines <= 2U * DEF_TEST_TICKS );
+        swcFsmRoutine( context );
+    }
+    TEST_CHECK( s_testDone && ( s_testYields == 1U ) && ( s_testTicks == DEF_TEST_TICKS ) );
+    TEST_CHECK( routines == 1U + DEF_TEST_TICKS );
+    TEST_CHECK( ( swcFsmGetPreState( context ) == TEST_STATE_IDLE ) && ( s_testFrames == 0U ) );
+
+    // dropped while suspended, the frame goes with the transition
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_IDLE, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_WORK, DEF_FSM_FALSE, context ) == FSM_PENDING );
+    TEST_CHECK( swcFsmResume( context ) == FSM_PENDING );
+    TEST_CHECK( s_testFrames == 1U );
+    swcFsmExit( context );
+    TEST_CHECK( ( s_testFrames == 0U ) && !FSM_IN_TRANSITION( context ) );
+
+    return 0;
+}
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file        testDfa.c
+ * @brief       FSM_DFA batch steps, built with -mavx2 and with FSM_DFA_SCALAR
+ * @details     swcFsmDfaStep runs the AVX2 kernel when the compiler targets it and FSM_DFA_SCALAR
+ *              is not set. Every step is compared with swcFsmDfaStepScalar and with a lookup of the
+ *              delta table on copies of the same slots: the slots, the count and every word of the
+ *              undefined mask must match. Counts are not multiples of 8, so the scalar tail runs
+ *              too. The AVX2 build is skipped on a cpu without AVX2.
+ */
+#include <string.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_INSTANCES              ( 1003U )
+#define DEF_TEST_WORDS                  ( ( DEF_TEST_INSTANCES + 63U ) / 64U )
+#define DEF_TEST_STEPS                  ( 50U )
+#define DEF_TEST_WIDE_STATES            ( 300U )
+#define DEF_TEST_WIDE_EVENTS            ( 17U )
+
+// recognizer of "ab*c", events a = 0, b = 1, c = 2, d = 3
+enum
+{
+    TEST_STATE_START,
+    TEST_STATE_B,
+    TEST_STATE_END,
+};
+
+DECLARE_SWC_FSM_CONTEXT( Word, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_START, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_END, NULL, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_START, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_END, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_END, TEST_STATE_START, NULL ), ),
+    NULL, NULL, TEST_STATE_START, 0, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_EVENT_TABLE( WordEvents, Word, 4,
+    DECLARE_SWC_FSM_EVENT_TRANSITIONS(
+        DECLARE_SWC_FSM_EVENT_TRANSITION( TEST_STATE_START, 0, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_EVENT_TRANSITION( TEST_STATE_B, 1, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_EVENT_TRANSITION( TEST_STATE_B, 2, TEST_STATE_END, NULL ), ) )
+
+DECLARE_SWC_FSM_DFA( Word, Word, 4 )
+
+static fsm_index_t s_testWideDelta[ DEF_TEST_WIDE_STATES * DEF_TEST_WIDE_EVENTS ];
+static fsm_index_t s_testSlots[ DEF_TEST_INSTANCES ];
+static fsm_index_t s_testScalarSlots[ DEF_TEST_INSTANCES ];
+static fsm_index_t s_testModelSlots[ DEF_TEST_INSTANCES ];
+static fsm_event_t s_testEvents[ DEF_TEST_INSTANCES ];
+static uint32_t s_testSeed = 7U;
+
+static uint32_t testRandom( void )
+{
+    s_testSeed ^= s_testSeed << 13;
+    s_testSeed ^= s_testSeed >> 17;
+    s_testSeed ^= s_testSeed << 5;
+    return s_testSeed;
+}
+
+// one step of every instance through the delta table
+static fsm_index_t testModelStep( fsm_index_t* slots, const fsm_event_t* events, fsm_index_t count, uint64_t* undefined, const SWCFsmDfa* dfa )
+{
+    fsm_index_t next = DEF_SWC_FSM_INDEX_INVALID;
+    fsm_index_t missed = 0;
+    fsm_index_t index = 0;
+
+    memset( undefined, 0, DEF_TEST_WORDS * sizeof( uint64_t ) );
+    for ( index = 0; index < count; ++index ) {
+        next = ( ( slots[ index ] < dfa->fsmStateSize ) && ( events[ index ] < dfa->fsmEventCount ) ) ? \
+            dfa->fsmDelta[ slots[ index ] * dfa->fsmEventCount + events[ index ] ] : DEF_SWC_FSM_INDEX_INVALID;
+        if ( next == DEF_SWC_FSM_INDEX_INVALID ) {
+            undefined[ index >> 6 ] |= ( uint64_t )1U << ( index & 63U );
+            ++missed;
+        } else {
+            slots[ index ] = next;
+        }
+    }
+
+    return missed;
+}
+
+// slots and events out of range now and then, slots every 97th instance invalid
+static void testRun( const SWCFsmDfa* dfa, fsm_index_t count )
+{
+    uint64_t undefined[ DEF_TEST_WORDS ];
+    uint64_t scalarUndefined[ DEF_TEST_WORDS ];
+    uint64_t modelUndefined[ DEF_TEST_WORDS ];
+    fsm_index_t missed = 0;
+    fsm_index_t index = 0;
+    uint32_t step = 0;
+
+    for ( index = 0; index < count; ++index ) {
+        s_testSlots[ index ] = ( index % 97U == 0U ) ? DEF_SWC_FSM_INDEX_INVALID : ( fsm_index_t )( testRandom() % ( dfa->fsmStateSize + 1U ) );
+    }
+    memcpy( s_testScalarSlots, s_testSlots, count * sizeof( fsm_index_t ) );
+    memcpy( s_testModelSlots, s_testSlots, count * sizeof( fsm_index_t ) );
+
+    for ( step = 0; step < DEF_TEST_STEPS; ++step ) {
+        for ( index = 0; index < count; ++index ) {
+            s_testEvents[ index ] = ( fsm_event_t )( testRandom() % ( dfa->fsmEventCount + 1U ) );
+        }
+        // the words are cleared by the step, stale bits must not survive
+        memset( undefined, 0xAA, sizeof( undefined ) );
+        memset( scalarUndefined, 0, sizeof( scalarUndefined ) );
+
+        missed = swcFsmDfaStep( s_testSlots, s_testEvents, count, undefined, dfa );
+        TEST_CHECK( missed == swcFsmDfaStepScalar( s_testScalarSlots, s_testEvents, 0U, count, scalarUndefined, dfa ) );
+        TEST_CHECK( missed == testModelStep( s_testModelSlots, s_testEvents, count, modelUndefined, dfa ) );
+        TEST_CHECK( memcmp( s_testSlots, s_testScalarSlots, count * sizeof( fsm_index_t ) ) == 0 );
+        TEST_CHECK( memcmp( s_testSlots, s_testModelSlots, count * sizeof( fsm_index_t ) ) == 0 );
+        TEST_CHECK( memcmp( undefined, scalarUndefined, ( ( count + 63U ) / 64U ) * sizeof( uint64_t ) ) == 0 );
+        TEST_CHECK( memcmp( undefined, modelUndefined, ( ( count + 63U ) / 64U ) * sizeof( uint64_t ) ) == 0 );
+
+        // without a mask only the count comes back
+        memcpy( s_testScalarSlots, s_testSlots, count * sizeof( fsm_index_t ) );
+        TEST_CHECK( swcFsmDfaStep( s_testScalarSlots, s_testEvents, count, NULL, dfa ) == testModelStep( s_testModelSlots, s_testEvents, count, modelUndefined, dfa ) );
+        memcpy( s_testSlots, s_testScalarSlots, count * sizeof( fsm_index_t ) );
+    }
+}
+
+int main( void )
+{
+    SWCFsmDfa* word = DECLARE_SWC_FSM_DFA_REF( Word );
+    SWCFsmDfa wide = { 0 };
+    fsm_index_t slots[ 2 ] = { TEST_STATE_START, TEST_STATE_B };
+    fsm_event_t events[ 2 ] = { 0U, 3U };
+    uint64_t undefined = 0;
+    fsm_index_t index = 0;
+
+#ifdef __AVX2__
+    __builtin_cpu_init();
+    if ( !__builtin_cpu_supports( "avx2" ) )    return 77;
+#endif
+
+    TEST_CHECK( swcFsmInit( DECLARE_SWC_FSM_CONTEXT_REF( Word ) ) == FSM_OK );
+    TEST_CHECK( swcFsmDfaBuild( DECLARE_SWC_FSM_EVENT_TABLE_REF( WordEvents ), word ) == FSM_OK );
+
+    // a moves START to B, d is not defined in B
+    TEST_CHECK( swcFsmDfaStep( slots, events, 2U, &undefined, word ) == 1U );
+    TEST_CHECK( ( slots[ 0 ] == TEST_STATE_B ) && ( slots[ 1 ] == TEST_STATE_B ) && ( undefined == 2U ) );
+
+    // a wider table filled by hand, a quarter of it undefined
+    for ( index = 0; index < DEF_TEST_WIDE_STATES * DEF_TEST_WIDE_EVENTS; ++index ) {
+        s_testWideDelta[ index ] = ( testRandom() & 3U ) ? ( fsm_index_t )( testRandom() % DEF_TEST_WIDE_STATES ) : DEF_SWC_FSM_INDEX_INVALID;
+    }
+    wide.fsmDelta       = s_testWideDelta;
+    wide.fsmCapacity    = DEF_TEST_WIDE_STATES * DEF_TEST_WIDE_EVENTS;
+    wide.fsmStateSize   = DEF_TEST_WIDE_STATES;
+    wide.fsmEventCount  = DEF_TEST_WIDE_EVENTS;
+
+    testRun( word, DEF_TEST_INSTANCES );
+    testRun( &wide, DEF_TEST_INSTANCES );
+    testRun( &wide, 7U );
+    testRun( &wide, 64U );
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file        testErrorQueue.c
+ * @brief       FSM_ERROR_QUEUE coalescing of repeated errors
+ * @details     without a queue every error reaches the handler at once. With one, repeated errors
+ *              of a context and code wait in a single record whose count the drain fills in, and a
+ *              rate limited queue holds them back for the interval. Two threads failing guards
+ *              while a third drains must not lose a single occurrence.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_STORM                  ( 100000U )         // errors per producer
+#define DEF_TEST_DRAIN                  ( 64U )
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+};
+
+static uint32_t s_testCalls = 0U;
+static uint64_t s_testTotal = 0U;
+static volatile int s_testStop = 0;
+
+static void testErrorHandler( fsm_error_t err, fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( err );
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    ++s_testCalls;
+}
+
+static fsm_bool_t testGuard( fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    return DEF_FSM_FALSE;
+}
+
+// A -> B never passes its guard
+#define DECLARE_TEST_CONTEXT( _name, _fsmID ) \
+    DECLARE_SWC_FSM_CONTEXT( _name, _fsmID, \
+        DECLARE_SWC_FSM_STATES( \
+            DECLARE_SWC_FSM_STATE( TEST_STATE_A, NULL, NULL, NULL, 0 ), \
+            DECLARE_SWC_FSM_STATE( TEST_STATE_B, NULL, NULL, NULL, 0 ), ), \
+        DECLARE_SWC_FSM_TRANSITIONS( \
+            DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, testGuard ), \
+            DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_A, NULL ), ), \
+        NULL, testErrorHandler, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+DECLARE_TEST_CONTEXT( First, 1 )
+DECLARE_TEST_CONTEXT( Second, 2 )
+DECLARE_TEST_CONTEXT( Limited, 3 )
+
+DECLARE_SWC_FSM_ERROR_QUEUE( Test, 0 )
+DECLARE_SWC_FSM_ERROR_QUEUE( Slow, 100000 )
+
+static uint32_t testDrain( SWCFsmErrorQueue* queue )
+{
+    SWCFsmErrorRecord records[ DEF_TEST_DRAIN ];
+    uint32_t count = swcFsmErrorDrain( records, DEF_TEST_DRAIN, queue );
+    uint32_t index = 0;
+
+    for ( index = 0; index < count; ++index ) {
+        s_testTotal += records[ index ].count;
+    }
+    return count;
+}
+
+static void* testConsumer( void* arg )
+{
+    while ( !s_testStop ) {
+        if ( testDrain( ( SWCFsmErrorQueue* )arg ) == 0U )  sched_yield();
+    }
+    return NULL;
+}
+
+static void* testProducer( void* arg )
+{
+    uint32_t index = 0;
+
+    for ( index = 0; index < DEF_TEST_STORM; ++index ) {
+        swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, ( SWCFsmContext* )arg );
+    }
+    return NULL;
+}
+
+int main( void )
+{
+    SWCFsmContext* first = DECLARE_SWC_FSM_CONTEXT_REF( First );
+    SWCFsmContext* second = DECLARE_SWC_FSM_CONTEXT_REF( Second );
+    SWCFsmContext* limited = DECLARE_SWC_FSM_CONTEXT_REF( Limited );
+    SWCFsmErrorQueue* queue = DECLARE_SWC_FSM_ERROR_QUEUE_REF( Test );
+    SWCFsmErrorQueue* slow = DECLARE_SWC_FSM_ERROR_QUEUE_REF( Slow );
+    SWCFsmErrorRecord records[ 8 ];
+    pthread_t consumer;
+    pthread_t producers[ 2 ];
+    uint32_t index = 0;
+
+    TEST_CHECK( swcFsmInit( first ) == FSM_OK );
+    TEST_CHECK( swcFsmInit( second ) == FSM_OK );
+    TEST_CHECK( swcFsmInit( limited ) == FSM_OK );
+
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, first ) == FSM_ERR_CHECK_FAILED );
+    TEST_CHECK( s_testCalls == 1U );
+
+    // a thousand failed guards and one unknown state make two records, the handler runs on drain
+    TEST_CHECK( swcFsmErrorQueueAttach( first, queue ) == FSM_OK );
+    for ( index = 0; index < 1000U; ++index ) {
+        TEST_CHECK( swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, first ) == FSM_ERR_CHECK_FAILED );
+    }
+    swcFsmTransTo( 77U, DEF_FSM_FALSE, first );
+    TEST_CHECK( s_testCalls == 1U );
+    TEST_CHECK( swcFsmErrorDrain( records, 8U, queue ) == 2U );
+    TEST_CHECK( s_testCalls == 3U );
+    TEST_CHECK( ( records[ 0 ].error == FSM_ERR_CHECK_FAILED ) && ( records[ 0 ].count == 1000U ) );
+    TEST_CHECK( ( records[ 0 ].context == first ) && ( records[ 0 ].nextState == TEST_STATE_B ) );
+    TEST_CHECK( ( records[ 1 ].error == FSM_ERR_NO_TRANSITION ) && ( records[ 1 ].count == 1U ) );
+    TEST_CHECK( swcFsmErrorDrain( records, 8U, queue ) == 0U );
+
+    // within the interval only the first error is queued, the others wait in the gate
+    TEST_CHECK( swcFsmErrorQueueAttach( limited, slow ) == FSM_OK );
+    for ( index = 0; index < 10U; ++index ) {
+        swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, limited );
+        TEST_CHECK( swcFsmErrorDrain( records, 8U, slow ) == ( ( index == 0U ) ? 1U : 0U ) );
+    }
+    TEST_CHECK( limited->fsmErrorGates[ DEF_SWC_FSM_ERROR_GATE( FSM_ERR_CHECK_FAILED ) ].count == 9U );
+
+    TEST_CHECK( swcFsmErrorQueueAttach( second, queue ) == FSM_OK );
+    TEST_CHECK( pthread_create( &consumer, NULL, testConsumer, queue ) == 0 );
+    TEST_CHECK( pthread_create( &producers[ 0 ], NULL, testProducer, first ) == 0 );
+    TEST_CHECK( pthread_create( &producers[ 1 ], NULL, testProducer, second ) == 0 );
+    pthread_join( producers[ 0 ], NULL );
+    pthread_join( producers[ 1 ], NULL );
+    s_testStop = 1;
+    pthread_join( consumer, NULL );
+    while ( testDrain( queue ) != 0U );
+
+    TEST_CHECK( s_testTotal == 2U * DEF_TEST_STORM );
+    TEST_CHECK( s_testCalls < 3U + 2U * DEF_TEST_STORM );
+
+    return 0;
+}
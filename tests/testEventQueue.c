@@ -0,0 +1,106 @@
+/**
+ * @file        testEventQueue.c
+ * @brief       FSM_EVENT_QUEUE posting from several threads, dispatching on one
+ * @details     every producer posts a numbered run of events, retrying while the queue is full.
+ *              the dispatching thread must see every event once and the events of each producer
+ *              in the order they were posted. Event 1 moves A to B, event 0 moves B back.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_PRODUCERS              ( 4U )
+#define DEF_TEST_EVENTS                 ( 20000U )          // per producer
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+};
+
+static uint32_t s_testNext[ DEF_TEST_PRODUCERS ];
+static uint32_t s_testHandled = 0U;
+static uint32_t s_testOutOfOrder = 0U;
+
+// payload is producer << 24 | sequence
+static void testCount( void* payload )
+{
+    uint32_t value = ( uint32_t )( uintptr_t )payload;
+    uint32_t producer = value >> 24;
+
+    if ( ( producer >= DEF_TEST_PRODUCERS ) || ( ( value & 0xFFFFFFU ) != s_testNext[ producer ] ) ) {
+        ++s_testOutOfOrder;
+    } else {
+        ++( s_testNext[ producer ] );
+    }
+    ++s_testHandled;
+}
+
+static fsm_error_t testEventA( fsm_event_t event, void* payload, void* context )
+{
+    testCount( payload );
+    return ( event == 1U ) ? swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, ( SWCFsmContext* )context ) : FSM_OK;
+}
+
+static fsm_error_t testEventB( fsm_event_t event, void* payload, void* context )
+{
+    testCount( payload );
+    return ( event == 0U ) ? swcFsmTransTo( TEST_STATE_A, DEF_FSM_FALSE, ( SWCFsmContext* )context ) : FSM_OK;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Queue, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE_EVENT( TEST_STATE_A, NULL, NULL, NULL, 0, testEventA ),
+        DECLARE_SWC_FSM_STATE_EVENT( TEST_STATE_B, NULL, NULL, NULL, 0, testEventB ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+static void* testProducer( void* arg )
+{
+    uint32_t producer = ( uint32_t )( uintptr_t )arg;
+    uint32_t sequence = 0;
+
+    while ( sequence < DEF_TEST_EVENTS ) {
+        if ( swcFsmPostEvent( DECLARE_SWC_FSM_CONTEXT_REF( Queue ), ( fsm_event_t )( sequence & 1U ),
+                              ( void* )( uintptr_t )( ( producer << 24 ) | sequence ) ) == FSM_OK ) {
+            ++sequence;
+        } else {
+            // full, let the dispatcher run on a single cpu
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+int main( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Queue );
+    pthread_t threads[ DEF_TEST_PRODUCERS ];
+    uint32_t index = 0;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( swcFsmDispatch( context ) == 0U );
+
+    for ( index = 0; index < DEF_TEST_PRODUCERS; ++index ) {
+        TEST_CHECK( pthread_create( &threads[ index ], NULL, testProducer, ( void* )( uintptr_t )index ) == 0 );
+    }
+    while ( s_testHandled < DEF_TEST_PRODUCERS * DEF_TEST_EVENTS ) {
+        if ( swcFsmDispatch( context ) == 0U )  sched_yield();
+    }
+    for ( index = 0; index < DEF_TEST_PRODUCERS; ++index ) {
+        pthread_join( threads[ index ], NULL );
+    }
+
+    TEST_CHECK( swcFsmDispatch( context ) == 0U );
+    TEST_CHECK( s_testHandled == DEF_TEST_PRODUCERS * DEF_TEST_EVENTS );
+    TEST_CHECK( s_testOutOfOrder == 0U );
+    for ( index = 0; index < DEF_TEST_PRODUCERS; ++index ) {
+        TEST_CHECK( s_testNext[ index ] == DEF_TEST_EVENTS );
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file        testFsm.h
+ * @brief       check macro shared by the behavior tests in tests/
+ * @details     assert is compiled out of the default Release build, TEST_CHECK is not. A failed
+ *              check prints its location and ends the test with exit code 1, which ctest reports.
+ */
+#ifndef SWC_FSM_TEST_H_
+#define SWC_FSM_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_CHECK( _cond ) \
+    do { \
+        if ( !( _cond ) ) { \
+            fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #_cond ); \
+            exit( 1 ); \
+        } \
+    } while ( 0 )
+
+#endif
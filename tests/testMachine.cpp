@@ -0,0 +1,96 @@
+/**
+ * @file        testMachine.cpp
+ * @brief       swc::fsm::Machine and the C functions driving the same context
+ * @details     a context attached to the machine is driven by Machine::transTo and by
+ *              swcFsmTransTo in turns, both must see the slots and states the other one left. A
+ *              context declared in testMachineTables.c with the same tables is compatible and runs
+ *              under the machine and the C functions of that file, one with the rows in another
+ *              order is not.
+ */
+#include "SWC_Fsm.hpp"
+#include "testFsm.h"
+#include "testMachine.h"
+
+using TestMachine = swc::fsm::Machine< 7,
+    swc::fsm::States<
+        swc::fsm::State< TEST_STATE_IDLE, testEntry, testRoutine, testExit >,
+        swc::fsm::State< TEST_STATE_RUN, testEntry, testRoutine, testExit, 10 >,
+        swc::fsm::State< TEST_STATE_STOP, testEntry > >,
+    swc::fsm::Transitions<
+        swc::fsm::Trans< TEST_STATE_IDLE, TEST_STATE_RUN, testGuard >,
+        swc::fsm::Trans< TEST_STATE_RUN, TEST_STATE_STOP >,
+        swc::fsm::Trans< TEST_STATE_STOP, TEST_STATE_IDLE > >,
+    nullptr, TEST_STATE_IDLE, 100 >;
+
+static_assert( ( TestMachine::stateSize == 3 ) && ( TestMachine::transitionSize == 3 ), "three states, three rows" );
+static_assert( TestMachine::slotOf( TEST_STATE_STOP ) == 2, "slots follow the state list" );
+static_assert( TestMachine::slotOf( 9 ) == DEF_SWC_FSM_INDEX_INVALID, "undeclared state has no slot" );
+static_assert( TestMachine::isTarget( TEST_STATE_IDLE ), "STOP -> IDLE leads to the init state" );
+
+static void testAttached()
+{
+    SWCFsmContext context = {};
+
+    TEST_CHECK( TestMachine::attach( &context ) == FSM_OK );
+    TEST_CHECK( TestMachine::compatible( &context ) && context.fsmIndexReady );
+    TEST_CHECK( TestMachine::init( &context ) == FSM_OK );
+    TEST_CHECK( ( context.curState == TEST_STATE_IDLE ) && ( context.curSlot == 0U ) && ( g_testEntries == 1U ) );
+
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_STOP, DEF_FSM_FALSE, &context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_RUN, DEF_FSM_FALSE, &context ) == FSM_OK );
+    TEST_CHECK( ( context.curSlot == 1U ) && ( context.preState == TEST_STATE_IDLE ) );
+    TEST_CHECK( ( g_testExits == 1U ) && ( g_testEntries == 2U ) );
+    TestMachine::routine( &context );
+    TEST_CHECK( g_testRoutines == 1U );
+
+    // the C functions go on from the slot the machine left
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_STOP, DEF_FSM_FALSE, &context ) == FSM_OK );
+    TEST_CHECK( ( swcFsmGetCurState( &context ) == TEST_STATE_STOP ) && ( context.curSlot == 2U ) );
+    TEST_CHECK( ( g_testExits == 2U ) && ( g_testEntries == 3U ) );
+    swcFsmRoutine( &context );
+    TEST_CHECK( g_testRoutines == 1U );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_RUN, DEF_FSM_FALSE, &context ) == FSM_ERR_NO_TRANSITION );
+
+    // and the machine from theirs
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_IDLE, DEF_FSM_FALSE, &context ) == FSM_OK );
+    TEST_CHECK( swcFsmGetPreState( &context ) == TEST_STATE_STOP );
+    TEST_CHECK( TestMachine::goBack( DEF_FSM_FALSE, &context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_STOP, DEF_FSM_TRUE, &context ) == FSM_OK );
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_RUN, DEF_FSM_TRUE, &context ) == FSM_OK );
+    TEST_CHECK( context.curSlot == 1U );
+    TEST_CHECK( TestMachine::transTo( 9, DEF_FSM_TRUE, &context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( TestMachine::transTo( DEF_SWC_FSM_STATE_INVALID, DEF_FSM_FALSE, &context ) == FSM_ERR_INVALID_STATE );
+
+    TestMachine::exit( &context );
+}
+
+static void testDeclared()
+{
+    SWCFsmContext* context = testMachineSame();
+
+    TEST_CHECK( TestMachine::compatible( context ) );
+    TEST_CHECK( !TestMachine::compatible( testMachineReordered() ) );
+    TEST_CHECK( !TestMachine::compatible( nullptr ) );
+
+    TEST_CHECK( TestMachine::init( context ) == FSM_OK );
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_RUN, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_RUN );
+    TEST_CHECK( testMachineTransTo( TEST_STATE_STOP, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( testMachineTransTo( TEST_STATE_IDLE, DEF_FSM_FALSE, context ) == FSM_OK );
+
+    // the guard of the C table and of the machine is the same function
+    g_testBlocked = DEF_FSM_TRUE;
+    TEST_CHECK( TestMachine::transTo( TEST_STATE_RUN, DEF_FSM_FALSE, context ) == FSM_ERR_CHECK_FAILED );
+    TEST_CHECK( testMachineTransTo( TEST_STATE_RUN, DEF_FSM_FALSE, context ) == FSM_ERR_CHECK_FAILED );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_IDLE );
+
+    TestMachine::exit( context );
+}
+
+int main()
+{
+    testAttached();
+    testDeclared();
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file        testMachine.h
+ * @brief       shared by testMachine.cpp and testMachineTables.c
+ */
+#ifndef SWC_FSM_TEST_MACHINE_H_
+#define SWC_FSM_TEST_MACHINE_H_
+
+#include "SWC_Fsm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    TEST_STATE_IDLE,
+    TEST_STATE_RUN,
+    TEST_STATE_STOP,
+};
+
+extern uint32_t                     g_testEntries;
+extern uint32_t                     g_testExits;
+extern uint32_t                     g_testRoutines;
+extern fsm_bool_t                   g_testBlocked;
+
+extern fsm_error_t                  testEntry( void* item );
+extern fsm_error_t                  testExit( void* item );
+extern fsm_error_t                  testRoutine( void* item );
+extern fsm_bool_t                   testGuard( fsm_state_t curState, fsm_state_t nextState, void* context );
+
+extern SWCFsmContext*               testMachineSame( void );
+extern SWCFsmContext*               testMachineReordered( void );
+extern fsm_error_t                  testMachineTransTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SWC_FSM_TEST_MACHINE_H_
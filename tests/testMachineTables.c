@@ -0,0 +1,79 @@
+/**
+ * @file        testMachineTables.c
+ * @brief       C side of testMachine.cpp, the actions of both and contexts declared in C
+ * @details     Same lists the tables of TestMachine, Reordered the same rows in another order.
+ */
+#include "SWC_Fsm.h"
+#include "testMachine.h"
+
+uint32_t g_testEntries = 0U;
+uint32_t g_testExits = 0U;
+uint32_t g_testRoutines = 0U;
+fsm_bool_t g_testBlocked = DEF_FSM_FALSE;
+
+fsm_error_t testEntry( void* item )
+{
+    UNUSED( item );
+    ++g_testEntries;
+    return FSM_OK;
+}
+
+fsm_error_t testExit( void* item )
+{
+    UNUSED( item );
+    ++g_testExits;
+    return FSM_OK;
+}
+
+fsm_error_t testRoutine( void* item )
+{
+    UNUSED( item );
+    ++g_testRoutines;
+    return FSM_OK;
+}
+
+fsm_bool_t testGuard( fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    return g_testBlocked ? DEF_FSM_FALSE : DEF_FSM_TRUE;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Same, 8,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, testEntry, testRoutine, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_RUN, testEntry, testRoutine, testExit, 10 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_STOP, testEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_RUN, testGuard ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_RUN, TEST_STATE_STOP, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_STOP, TEST_STATE_IDLE, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, 100, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_CONTEXT( Reordered, 9,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, testEntry, testRoutine, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_RUN, testEntry, testRoutine, testExit, 10 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_STOP, testEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_RUN, TEST_STATE_STOP, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_RUN, testGuard ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_STOP, TEST_STATE_IDLE, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, 100, NULL, NULL, NULL )
+
+SWCFsmContext* testMachineSame( void )
+{
+    return DECLARE_SWC_FSM_CONTEXT_REF( Same );
+}
+
+SWCFsmContext* testMachineReordered( void )
+{
+    return DECLARE_SWC_FSM_CONTEXT_REF( Reordered );
+}
+
+// the C functions of this translation unit on a context the machine drives too
+fsm_error_t testMachineTransTo( fsm_state_t state, fsm_bool_t bForce, SWCFsmContext* context )
+{
+    return swcFsmTransTo( state, bForce, context );
+}
@@ -0,0 +1,160 @@
+/**
+ * @file        testRecord.c
+ * @brief       FSM_RECORD record and replay of two contexts sharing one recorder
+ * @details     random transitions with failing guards and entry actions are recorded, replaying
+ *              them against the same tables must end in the recorded final states without a
+ *              mismatch, also split into two shards on two threads. Tables that dropped a row
+ *              must report mismatches for that context only. A full recorder drops records.
+ */
+#include <pthread.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_TRANSITIONS            ( 100000U )
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+    TEST_STATE_C,
+    TEST_STATE_D,
+};
+
+static uint32_t s_testSeed = 1U;
+
+// xorshift, the same sequence on every platform
+static uint32_t testRandom( void )
+{
+    s_testSeed ^= s_testSeed << 13;
+    s_testSeed ^= s_testSeed >> 17;
+    s_testSeed ^= s_testSeed << 5;
+    return s_testSeed;
+}
+
+static fsm_bool_t testGuard( fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    return ( testRandom() & 3U ) ? DEF_FSM_TRUE : DEF_FSM_FALSE;
+}
+
+static fsm_error_t testEntry( void* item )
+{
+    UNUSED( item );
+    return ( testRandom() % 7U == 0U ) ? FSM_ERR_UNKNOWN : FSM_OK;
+}
+
+#define TEST_STATES \
+    DECLARE_SWC_FSM_STATES( \
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, NULL, NULL, NULL, 0 ), \
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testEntry, NULL, NULL, 0 ), \
+        DECLARE_SWC_FSM_STATE( TEST_STATE_C, NULL, NULL, NULL, 0 ), \
+        DECLARE_SWC_FSM_STATE( TEST_STATE_D, NULL, NULL, NULL, 0 ), )
+
+#define TEST_TRANSITIONS \
+    DECLARE_SWC_FSM_TRANSITIONS( \
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, testGuard ), \
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_C, testGuard ), \
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_A, NULL ), \
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_D, testGuard ), \
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_D, TEST_STATE_A, NULL ), )
+
+DECLARE_SWC_FSM_CONTEXT( First, 0, TEST_STATES, TEST_TRANSITIONS, NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+DECLARE_SWC_FSM_CONTEXT( Second, 1, TEST_STATES, TEST_TRANSITIONS, NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+// a later version of the tables of context 1, C -> D is gone
+DECLARE_SWC_FSM_CONTEXT( Changed, 1, TEST_STATES,
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_C, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_D, TEST_STATE_A, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_RECORDER( Test, DEF_TEST_TRANSITIONS + 16U )
+DECLARE_SWC_FSM_RECORDER( Small, 3 )
+
+typedef struct
+{
+    uint32_t                        shard;
+    uint32_t                        count;
+    uint32_t                        mismatches;
+} TestShard;
+
+static SWCFsmReplayState s_testStates[ 2 ];
+
+static void* testReplayShard( void* arg )
+{
+    TestShard* shard = ( TestShard* )arg;
+
+    shard->mismatches = swcFsmReplay( s_fsmRecordTest, shard->count, shard->shard, 2U, s_testStates, 2U );
+    return NULL;
+}
+
+static void testBind( SWCFsmContext* first, SWCFsmContext* second )
+{
+    TEST_CHECK( swcFsmReplayBind( first, &( s_testStates[ 0 ] ) ) == FSM_OK );
+    TEST_CHECK( swcFsmReplayBind( second, &( s_testStates[ 1 ] ) ) == FSM_OK );
+}
+
+int main( void )
+{
+    SWCFsmContext* first = DECLARE_SWC_FSM_CONTEXT_REF( First );
+    SWCFsmContext* second = DECLARE_SWC_FSM_CONTEXT_REF( Second );
+    SWCFsmContext* context = NULL;
+    SWCFsmRecorder* recorder = DECLARE_SWC_FSM_RECORDER_REF( Test );
+    SWCFsmRecorder* small = DECLARE_SWC_FSM_RECORDER_REF( Small );
+    TestShard shards[ 2 ] = { { 0U, 0U, 0U }, { 1U, 0U, 0U } };
+    pthread_t threads[ 2 ];
+    fsm_state_t nextState = 0;
+    uint32_t count = 0;
+    uint32_t index = 0;
+
+    TEST_CHECK( swcFsmRecordAttach( first, recorder ) == FSM_OK );
+    TEST_CHECK( swcFsmRecordAttach( second, recorder ) == FSM_OK );
+    TEST_CHECK( swcFsmInit( first ) == FSM_OK );
+    TEST_CHECK( swcFsmInit( second ) == FSM_OK );
+
+    // one in five to a state that does not exist, one in fifty forced
+    for ( index = 0; index < DEF_TEST_TRANSITIONS; ++index ) {
+        context = ( index & 1U ) ? second : first;
+        nextState = ( testRandom() % 5U == 0U ) ? 9U : ( fsm_state_t )( testRandom() & 3U );
+        swcFsmTransTo( nextState, ( testRandom() % 50U == 0U ) ? DEF_FSM_TRUE : DEF_FSM_FALSE, context );
+    }
+    count = swcFsmRecordCount( recorder );
+    TEST_CHECK( ( count > DEF_TEST_TRANSITIONS / 2U ) && ( count <= DEF_TEST_TRANSITIONS + 4U ) );
+    TEST_CHECK( recorder->dropped == 0U );
+
+    testBind( first, second );
+    TEST_CHECK( swcFsmReplay( s_fsmRecordTest, count, 0U, 1U, s_testStates, 2U ) == 0U );
+    TEST_CHECK( s_testStates[ 0 ].curState == swcFsmGetCurState( first ) );
+    TEST_CHECK( s_testStates[ 1 ].curState == swcFsmGetCurState( second ) );
+    TEST_CHECK( s_testStates[ 0 ].records + s_testStates[ 1 ].records == count );
+
+    // each shard replays the contexts with fsmContextID % 2 == shard
+    testBind( first, second );
+    for ( index = 0; index < 2U; ++index ) {
+        shards[ index ].count = count;
+        TEST_CHECK( pthread_create( &threads[ index ], NULL, testReplayShard, &( shards[ index ] ) ) == 0 );
+    }
+    for ( index = 0; index < 2U; ++index ) {
+        pthread_join( threads[ index ], NULL );
+    }
+    TEST_CHECK( ( shards[ 0 ].mismatches == 0U ) && ( shards[ 1 ].mismatches == 0U ) );
+    TEST_CHECK( s_testStates[ 0 ].curState == swcFsmGetCurState( first ) );
+    TEST_CHECK( s_testStates[ 1 ].curState == swcFsmGetCurState( second ) );
+
+    testBind( first, DECLARE_SWC_FSM_CONTEXT_REF( Changed ) );
+    TEST_CHECK( swcFsmReplay( s_fsmRecordTest, count, 0U, 1U, s_testStates, 2U ) > 0U );
+    TEST_CHECK( ( s_testStates[ 0 ].mismatches == 0U ) && ( s_testStates[ 1 ].mismatches > 0U ) );
+
+    // the start record and two transitions fit, the rest is dropped
+    TEST_CHECK( swcFsmRecordAttach( first, small ) == FSM_OK );
+    for ( index = 0; index < 5U; ++index ) {
+        swcFsmTransTo( TEST_STATE_A, DEF_FSM_TRUE, first );
+    }
+    TEST_CHECK( ( swcFsmRecordCount( small ) == 3U ) && ( small->dropped == 3U ) );
+
+    return 0;
+}
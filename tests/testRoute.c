@@ -0,0 +1,110 @@
+/**
+ * @file        testRoute.c
+ * @brief       FSM_ROUTE shortest paths and swcFsmRouteTo
+ * @details     A -> B -> C -> D and the shorter A -> E -> D, D leads back to A and F is not
+ *              reachable. Every hop of a route runs the exit and entry actions, a guard failing
+ *              on the way stops the route in the state reached so far.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+    TEST_STATE_C,
+    TEST_STATE_D,
+    TEST_STATE_E,
+    TEST_STATE_F,
+};
+
+static char s_testLog[ 256 ];
+static fsm_bool_t s_testBlocked = DEF_FSM_FALSE;
+
+static void testLog( char action, void* item )
+{
+    size_t length = strlen( s_testLog );
+
+    snprintf( s_testLog + length, sizeof( s_testLog ) - length, "%c%u", action, ( unsigned )( ( SWCFsmStateItem* )item )->state );
+}
+
+static fsm_error_t testEntry( void* item )
+{
+    testLog( '+', item );
+    return FSM_OK;
+}
+
+static fsm_error_t testExit( void* item )
+{
+    testLog( '-', item );
+    return FSM_OK;
+}
+
+static fsm_bool_t testGuard( fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    return s_testBlocked ? DEF_FSM_FALSE : DEF_FSM_TRUE;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Route, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, testEntry, NULL, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testEntry, NULL, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_C, testEntry, NULL, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_D, testEntry, NULL, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_E, testEntry, NULL, testExit, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_F, testEntry, NULL, testExit, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_C, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_D, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_E, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_E, TEST_STATE_D, testGuard ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_D, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_F, TEST_STATE_A, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+int main( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Route );
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+
+    TEST_CHECK( swcFsmRouteNext( TEST_STATE_A, TEST_STATE_D, context ) == TEST_STATE_E );
+    TEST_CHECK( swcFsmRouteNext( TEST_STATE_B, TEST_STATE_A, context ) == TEST_STATE_C );
+    TEST_CHECK( swcFsmRouteNext( TEST_STATE_C, TEST_STATE_C, context ) == TEST_STATE_C );
+    TEST_CHECK( swcFsmRouteNext( TEST_STATE_A, TEST_STATE_F, context ) == DEF_SWC_FSM_STATE_INVALID );
+
+    // the short way over E, then the long way round over A and B
+    s_testLog[ 0 ] = '\0';
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_D, context ) == FSM_OK );
+    TEST_CHECK( strcmp( s_testLog, "-0+4-4+3" ) == 0 );
+    s_testLog[ 0 ] = '\0';
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_C, context ) == FSM_OK );
+    TEST_CHECK( strcmp( s_testLog, "-3+0-0+1-1+2" ) == 0 );
+
+    // nothing runs for the state already reached, an unreachable or unknown state
+    s_testLog[ 0 ] = '\0';
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_C, context ) == FSM_OK );
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_F, context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( swcFsmRouteTo( 77U, context ) == FSM_ERR_INVALID_STATE );
+    TEST_CHECK( ( s_testLog[ 0 ] == '\0' ) && ( swcFsmGetCurState( context ) == TEST_STATE_C ) );
+
+    // the guard of E -> D stops the route in E
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_A, context ) == FSM_OK );
+    s_testBlocked = DEF_FSM_TRUE;
+    s_testLog[ 0 ] = '\0';
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_D, context ) == FSM_ERR_CHECK_FAILED );
+    TEST_CHECK( strcmp( s_testLog, "-0+4" ) == 0 );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_E );
+
+    s_testBlocked = DEF_FSM_FALSE;
+    TEST_CHECK( swcFsmRouteTo( TEST_STATE_D, context ) == FSM_OK );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_D );
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file        testScheduler.c
+ * @brief       FSM_SCHEDULER rounds over many contexts
+ * @details     contexts with an interval shorter than the tick run in every round, those with four
+ *              ticks in every fourth round. No routine may run on two workers at once, a stop
+ *              finishes the round in progress and nothing is added past the capacity.
+ */
+#include <time.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_CONTEXTS               ( 2000U )
+#define DEF_TEST_WORKERS                ( 4U )
+#define DEF_TEST_TICK                   ( 5U )              // ms
+#define DEF_TEST_SLOW                   ( 4U * DEF_TEST_TICK )
+
+enum
+{
+    TEST_STATE_IDLE,
+};
+
+static SWCFsmStateItem  s_testStates[] = { DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, NULL, NULL, NULL, 0 ) };
+static SWCFsmTransItem  s_testTrans[] = { DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_IDLE, NULL ) };
+static fsm_index_t      s_testOffset[ DEF_TEST_CONTEXTS ][ 2 ];
+static SWCFsmTransEdge  s_testEdge[ DEF_TEST_CONTEXTS ][ 1 ];
+static fsm_bool_t       s_testTarget[ DEF_TEST_CONTEXTS ][ 1 ];
+static SWCFsmContext    s_testContexts[ DEF_TEST_CONTEXTS ];
+static uint32_t         s_testInside[ DEF_TEST_CONTEXTS ];
+static uint32_t         s_testRuns[ DEF_TEST_CONTEXTS ];
+static uint32_t         s_testOverlaps = 0U;
+
+DECLARE_SWC_FSM_SCHEDULER( Test, DEF_TEST_WORKERS, DEF_TEST_CONTEXTS, DEF_TEST_TICK )
+
+static fsm_error_t testRoutine( void* context )
+{
+    fsm_context_id_t id = ( ( SWCFsmContext* )context )->fsmContextID;
+
+    if ( __atomic_fetch_add( &( s_testInside[ id ] ), 1U, __ATOMIC_ACQ_REL ) != 0U ) {
+        __atomic_fetch_add( &s_testOverlaps, 1U, __ATOMIC_RELAXED );
+    }
+    ++( s_testRuns[ id ] );
+    __atomic_fetch_sub( &( s_testInside[ id ] ), 1U, __ATOMIC_ACQ_REL );
+
+    return FSM_OK;
+}
+
+int main( void )
+{
+    SWCFsmScheduler* scheduler = DECLARE_SWC_FSM_SCHEDULER_REF( Test );
+    SWCFsmContext* context = NULL;
+    struct timespec wait = { 0, 300000000L };
+    uint64_t rounds = 0;
+    uint32_t index = 0;
+
+    for ( index = 0; index < DEF_TEST_CONTEXTS; ++index ) {
+        context = &( s_testContexts[ index ] );
+        context->initState          = TEST_STATE_IDLE;
+        context->curState           = DEF_SWC_FSM_STATE_INVALID;
+        context->preState           = DEF_SWC_FSM_STATE_INVALID;
+        context->curSlot            = DEF_SWC_FSM_INDEX_INVALID;
+        context->fsmStateList       = s_testStates;
+        context->fsmTransTable      = s_testTrans;
+        context->fsmTransOffset     = s_testOffset[ index ];
+        context->fsmTransEdge       = s_testEdge[ index ];
+        context->fsmStateTarget     = s_testTarget[ index ];
+        context->fsmStateSize       = 1U;
+        context->fsmTransitionSize  = 1U;
+        context->fsmContextID       = ( fsm_context_id_t )index;
+        context->fsmRoutine         = testRoutine;
+        context->fsmRoutineInterval = ( index & 1U ) ? DEF_TEST_SLOW : 1U;
+        TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+        TEST_CHECK( swcFsmSchedulerAdd( context, scheduler ) == FSM_OK );
+    }
+    TEST_CHECK( swcFsmSchedulerAdd( &( s_testContexts[ 0 ] ), scheduler ) != FSM_OK );
+
+    TEST_CHECK( swcFsmSchedulerStart( scheduler ) == FSM_OK );
+    nanosleep( &wait, NULL );
+    swcFsmSchedulerStop( scheduler );
+
+    rounds = scheduler->round;
+    TEST_CHECK( rounds >= 4U );
+    TEST_CHECK( s_testOverlaps == 0U );
+    for ( index = 0; index < DEF_TEST_CONTEXTS; index += 2U ) {
+        TEST_CHECK( s_testRuns[ index ] == rounds );
+    }
+    // contexts of one interval are spread over the rounds, each is at most one run off the mean
+    for ( index = 1U; index < DEF_TEST_CONTEXTS; index += 2U ) {
+        TEST_CHECK( ( s_testRuns[ index ] + 1U >= rounds / 4U ) && ( s_testRuns[ index ] <= rounds / 4U + 1U ) );
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file        testShardPool.c
+ * @brief       FSM_SHARD_POOL allocation by the owner threads of the shards
+ * @details     each thread pins its shard, fills it up and drives its instances. Freeing an
+ *              instance twice must be refused and leave it on the free list once, the pick must
+ *              find the only shard with room. Pinned with cpu -1, the affinity is left alone.
+ */
+#include <pthread.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_SHARDS                 ( 4U )
+#define DEF_TEST_INSTANCES              ( 100U )            // per shard
+#define DEF_TEST_ROUNDS                 ( 1000U )
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+};
+
+DECLARE_SWC_FSM_CONTEXT( Shard, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, NULL, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_A, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_SHARD_POOL( Test, Shard, DEF_TEST_SHARDS, DEF_TEST_INSTANCES )
+
+static void* testOwner( void* arg )
+{
+    SWCFsmShardPool* shardPool = DECLARE_SWC_FSM_SHARD_POOL_REF( Test );
+    fsm_index_t shard = ( fsm_index_t )( uintptr_t )arg;
+    SWCFsmInstancePool* pool = NULL;
+    fsm_index_t instance = 0;
+    uint32_t round = 0;
+
+    TEST_CHECK( swcFsmShardPin( shard, -1, shardPool ) == FSM_OK );
+    pool = swcFsmShardGet( shard, shardPool );
+    TEST_CHECK( pool != NULL );
+
+    for ( instance = 0; instance < DEF_TEST_INSTANCES; ++instance ) {
+        TEST_CHECK( swcFsmShardAlloc( shard, shardPool ) == instance );
+        TEST_CHECK( swcFsmInstanceInit( instance, pool ) == FSM_OK );
+    }
+    TEST_CHECK( swcFsmShardAlloc( shard, shardPool ) == DEF_SWC_FSM_INDEX_INVALID );
+
+    for ( round = 0; round < DEF_TEST_ROUNDS; ++round ) {
+        for ( instance = 0; instance < DEF_TEST_INSTANCES; ++instance ) {
+            TEST_CHECK( swcFsmInstanceTransTo( ( round & 1U ) ? TEST_STATE_A : TEST_STATE_B, DEF_FSM_FALSE, instance, pool ) == FSM_OK );
+        }
+    }
+
+    TEST_CHECK( swcFsmShardFree( 7U, shard, shardPool ) == FSM_OK );
+    TEST_CHECK( swcFsmInstanceGetCurState( 7U, pool ) == DEF_SWC_FSM_STATE_INVALID );
+    TEST_CHECK( swcFsmShardFree( 7U, shard, shardPool ) == FSM_ERR_INVALID_STATE );
+    TEST_CHECK( shardPool->shards[ shard ].freeCount == 1U );
+    TEST_CHECK( swcFsmShardAlloc( shard, shardPool ) == 7U );
+    TEST_CHECK( swcFsmShardAlloc( shard, shardPool ) == DEF_SWC_FSM_INDEX_INVALID );
+
+    return NULL;
+}
+
+int main( void )
+{
+    SWCFsmShardPool* shardPool = DECLARE_SWC_FSM_SHARD_POOL_REF( Test );
+    pthread_t threads[ DEF_TEST_SHARDS ];
+    uintptr_t index = 0;
+
+    // shards own whole pages, their headers whole cache lines
+    TEST_CHECK( ( ( ( uintptr_t )shardPool->arena & 4095U ) == 0U ) && ( ( shardPool->shardBytes % 4096U ) == 0U ) );
+    TEST_CHECK( ( sizeof( SWCFsmShard ) % 64U ) == 0U );
+
+    TEST_CHECK( swcFsmShardPoolInit( shardPool ) == FSM_OK );
+    TEST_CHECK( swcFsmShardPick( -1, shardPool ) == DEF_SWC_FSM_INDEX_INVALID );
+
+    for ( index = 0; index < DEF_TEST_SHARDS; ++index ) {
+        TEST_CHECK( pthread_create( &threads[ index ], NULL, testOwner, ( void* )index ) == 0 );
+    }
+    for ( index = 0; index < DEF_TEST_SHARDS; ++index ) {
+        pthread_join( threads[ index ], NULL );
+    }
+
+    for ( index = 0; index < DEF_TEST_SHARDS; ++index ) {
+        TEST_CHECK( shardPool->shards[ index ].freeCount == 0U );
+    }
+    TEST_CHECK( swcFsmShardPick( -1, shardPool ) == DEF_SWC_FSM_INDEX_INVALID );
+    TEST_CHECK( swcFsmShardFree( 3U, 2U, shardPool ) == FSM_OK );
+    TEST_CHECK( swcFsmShardPick( -1, shardPool ) == 2U );
+    TEST_CHECK( swcFsmShardFree( DEF_TEST_INSTANCES, 2U, shardPool ) != FSM_OK );
+    TEST_CHECK( swcFsmShardPin( DEF_TEST_SHARDS, -1, shardPool ) == FSM_ERR_NULL_CONTEXT );
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file        testSnapshot.c
+ * @brief       FSM_SNAPSHOT round trip of a context and an instance pool
+ * @details     the file written by swcFsmSnapshotSave is restored after the states and blobs
+ *              were wiped, without running any action. A snapshot of other tables, a torn file
+ *              and a missing file must be refused and leave everything untouched.
+ *              usage: testSnapshot <file>
+ */
+#include <stdio.h>
+#include <string.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_INSTANCES              ( 1000U )
+
+enum
+{
+    TEST_STATE_A,
+    TEST_STATE_B,
+    TEST_STATE_C,
+};
+
+static uint32_t s_testEntries = 0U;
+static uint32_t s_testErrors = 0U;
+
+static fsm_error_t testEntry( void* item )
+{
+    UNUSED( item );
+    ++s_testEntries;
+    return FSM_OK;
+}
+
+static void testErrorHandler( fsm_error_t err, fsm_state_t curState, fsm_state_t nextState, void* context )
+{
+    UNUSED( curState );
+    UNUSED( nextState );
+    UNUSED( context );
+    if ( err == FSM_ERR_SNAPSHOT )  ++s_testErrors;
+}
+
+DECLARE_SWC_FSM_CONTEXT( Saved, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, testEntry, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testEntry, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_C, testEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_C, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_A, NULL ), ),
+    NULL, testErrorHandler, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+// same states, one more row, so its table hash differs
+DECLARE_SWC_FSM_CONTEXT( Other, 2,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_A, testEntry, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_B, testEntry, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_C, testEntry, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_B, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_B, TEST_STATE_C, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_C, TEST_STATE_A, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_A, TEST_STATE_C, NULL ), ),
+    NULL, NULL, TEST_STATE_A, 0, NULL, NULL, NULL )
+
+DECLARE_SWC_FSM_INSTANCE_POOL( Pool, Saved, DEF_TEST_INSTANCES )
+DECLARE_SWC_FSM_SNAPSHOT( Saved, 2 )
+DECLARE_SWC_FSM_SNAPSHOT( Other, 2 )
+
+static struct
+{
+    uint32_t                        counter;
+    char                            name[ 13 ];
+} s_testBlob, s_testOtherBlob;
+static uint32_t s_testUser[ DEF_TEST_INSTANCES ];
+
+static void testWipe( SWCFsmContext* context, SWCFsmInstancePool* pool )
+{
+    fsm_index_t instance = 0;
+
+    context->curState   = DEF_SWC_FSM_STATE_INVALID;
+    context->preState   = DEF_SWC_FSM_STATE_INVALID;
+    context->curSlot    = DEF_SWC_FSM_INDEX_INVALID;
+#ifdef FSM_CONCURRENT
+    context->fsmStateWord = DEF_SWC_FSM_WORD_PACK( DEF_SWC_FSM_STATE_INVALID, DEF_SWC_FSM_STATE_INVALID, 0U );
+#endif
+    TEST_CHECK( swcFsmPoolInit( pool ) == FSM_OK );
+    memset( &s_testBlob, 0, sizeof( s_testBlob ) );
+    for ( instance = 0; instance < DEF_TEST_INSTANCES; ++instance ) {
+        s_testUser[ instance ] = 0U;
+    }
+}
+
+static void testCheckRestored( SWCFsmContext* context, SWCFsmInstancePool* pool )
+{
+    fsm_index_t instance = 0;
+
+    TEST_CHECK( ( swcFsmGetCurState( context ) == TEST_STATE_C ) && ( swcFsmGetPreState( context ) == TEST_STATE_B ) );
+    TEST_CHECK( ( s_testBlob.counter == 42U ) && ( strcmp( s_testBlob.name, "snapshot" ) == 0 ) );
+    for ( instance = 0; instance < DEF_TEST_INSTANCES; ++instance ) {
+        TEST_CHECK( swcFsmInstanceGetCurState( instance, pool ) == ( ( instance % 3U ) ? TEST_STATE_B : TEST_STATE_A ) );
+        TEST_CHECK( s_testUser[ instance ] == instance * 7U );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Saved );
+    SWCFsmContext* other = DECLARE_SWC_FSM_CONTEXT_REF( Other );
+    SWCFsmInstancePool* pool = DECLARE_SWC_FSM_INSTANCE_POOL_REF( Pool );
+    SWCFsmSnapshot* snapshot = DECLARE_SWC_FSM_SNAPSHOT_REF( Saved );
+    SWCFsmSnapshot* otherSnapshot = DECLARE_SWC_FSM_SNAPSHOT_REF( Other );
+    const char* path = ( argc > 1 ) ? argv[ 1 ] : "testSnapshot.bin";
+    fsm_index_t instance = 0;
+    uint32_t entries = 0;
+    uint32_t magic = 0;
+    FILE* file = NULL;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_B, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_C, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmPoolInit( pool ) == FSM_OK );
+    for ( instance = 0; instance < DEF_TEST_INSTANCES; ++instance ) {
+        TEST_CHECK( swcFsmInstanceInit( instance, pool ) == FSM_OK );
+        if ( instance % 3U )    TEST_CHECK( swcFsmInstanceTransTo( TEST_STATE_B, DEF_FSM_FALSE, instance, pool ) == FSM_OK );
+        s_testUser[ instance ] = instance * 7U;
+    }
+    s_testBlob.counter = 42U;
+    strcpy( s_testBlob.name, "snapshot" );
+
+    TEST_CHECK( swcFsmSnapshotAdd( context, &s_testBlob, sizeof( s_testBlob ), snapshot ) == FSM_OK );
+    TEST_CHECK( swcFsmSnapshotAddPool( pool, s_testUser, sizeof( s_testUser ), snapshot ) == FSM_OK );
+    TEST_CHECK( swcFsmSnapshotSave( snapshot, path ) == FSM_OK );
+
+    // restoring puts states and blobs back, no entry action runs
+    testWipe( context, pool );
+    entries = s_testEntries;
+    TEST_CHECK( swcFsmSnapshotRestore( snapshot, path ) == FSM_OK );
+    TEST_CHECK( s_testEntries == entries );
+    testCheckRestored( context, pool );
+    TEST_CHECK( swcFsmInstanceTransTo( TEST_STATE_C, DEF_FSM_FALSE, 1U, pool ) == FSM_OK );
+    TEST_CHECK( swcFsmInstanceTransTo( TEST_STATE_B, DEF_FSM_TRUE, 1U, pool ) == FSM_OK );
+
+    // the tables of another machine hash differently, nothing is written into it
+    TEST_CHECK( swcFsmSnapshotAdd( other, &s_testOtherBlob, sizeof( s_testOtherBlob ), otherSnapshot ) == FSM_OK );
+    TEST_CHECK( swcFsmSnapshotAddPool( pool, s_testUser, sizeof( s_testUser ), otherSnapshot ) == FSM_OK );
+    TEST_CHECK( swcFsmSnapshotRestore( otherSnapshot, path ) == FSM_ERR_SNAPSHOT );
+    TEST_CHECK( swcFsmGetCurState( other ) == DEF_SWC_FSM_STATE_INVALID );
+    TEST_CHECK( s_testOtherBlob.counter == 0U );
+
+    // a torn file keeps the restored states, the failure reaches the error handler
+    file = fopen( path, "r+b" );
+    TEST_CHECK( file && ( fwrite( &magic, sizeof( magic ), 1, file ) == 1U ) );
+    fclose( file );
+    TEST_CHECK( swcFsmSnapshotRestore( snapshot, path ) == FSM_ERR_SNAPSHOT );
+    TEST_CHECK( s_testErrors == 1U );
+    testCheckRestored( context, pool );
+
+    // saving again replaces the torn file
+    TEST_CHECK( swcFsmSnapshotSave( snapshot, path ) == FSM_OK );
+    testWipe( context, pool );
+    TEST_CHECK( swcFsmSnapshotRestore( snapshot, path ) == FSM_OK );
+    testCheckRestored( context, pool );
+
+    TEST_CHECK( remove( path ) == 0 );
+    TEST_CHECK( swcFsmSnapshotRestore( snapshot, path ) == FSM_ERR_SNAPSHOT );
+    TEST_CHECK( s_testErrors == 2U );
+
+    return 0;
+}
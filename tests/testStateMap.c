@@ -0,0 +1,116 @@
+/**
+ * @file        testStateMap.c
+ * @brief       FSM_STATE_MAP lookup of compact and sparse state ids
+ * @details     a compact id range gets the direct table, sparse ids the hash fallback. Every listed
+ *              id must map to its slot, ids between them to no slot, and transitions must run the
+ *              same as with the linear lookup.
+ */
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_SPARSE_STATES          ( 3000U )
+#define DEF_TEST_SPARSE_STEP            ( 21U )
+#define DEF_TEST_SPARSE_BASE            ( 9U )
+
+enum
+{
+    TEST_STATE_IDLE = 100,
+    TEST_STATE_OPEN,
+    TEST_STATE_RUN,
+    TEST_STATE_STOP,
+};
+
+DECLARE_SWC_FSM_CONTEXT( Compact, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE( TEST_STATE_IDLE, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_OPEN, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_RUN, NULL, NULL, NULL, 0 ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_STOP, NULL, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_STOP, TEST_STATE_IDLE, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_OPEN, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_OPEN, TEST_STATE_RUN, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_RUN, TEST_STATE_STOP, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, 0, NULL, NULL, NULL )
+
+static SWCFsmStateItem  s_testStates[ DEF_TEST_SPARSE_STATES ];
+static SWCFsmTransItem  s_testTrans[ DEF_TEST_SPARSE_STATES ];
+static fsm_index_t      s_testOffset[ DEF_TEST_SPARSE_STATES + 1U ];
+static SWCFsmTransEdge  s_testEdge[ DEF_TEST_SPARSE_STATES ];
+static fsm_bool_t       s_testTarget[ DEF_TEST_SPARSE_STATES ];
+static fsm_index_t      s_testMap[ DEF_SWC_FSM_STATE_MAP_SIZE( DEF_TEST_SPARSE_STATES ) ];
+
+static fsm_state_t testSparseId( fsm_index_t slot )
+{
+    return ( fsm_state_t )( slot * DEF_TEST_SPARSE_STEP + DEF_TEST_SPARSE_BASE );
+}
+
+static void testCompact( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Compact );
+    fsm_state_t state = 0;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( context->fsmStateMapMode == DEF_SWC_FSM_STATE_MAP_DIRECT );
+
+    for ( state = TEST_STATE_IDLE; state <= TEST_STATE_STOP; ++state ) {
+        TEST_CHECK( swcFsmGetStateSlot( state, context ) == ( fsm_index_t )( state - TEST_STATE_IDLE ) );
+    }
+    TEST_CHECK( swcFsmGetStateSlot( TEST_STATE_IDLE - 1, context ) == DEF_SWC_FSM_INDEX_INVALID );
+    TEST_CHECK( swcFsmGetStateSlot( TEST_STATE_STOP + 1, context ) == DEF_SWC_FSM_INDEX_INVALID );
+    TEST_CHECK( swcFsmGetStateSlot( 60000U, context ) == DEF_SWC_FSM_INDEX_INVALID );
+
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_OPEN, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_STOP, DEF_FSM_FALSE, context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_RUN, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( ( swcFsmGetCurState( context ) == TEST_STATE_RUN ) && ( context->curSlot == 2U ) );
+}
+
+static void testSparse( void )
+{
+    SWCFsmContext context = { 0 };
+    fsm_index_t slot = 0;
+
+    for ( slot = 0; slot < DEF_TEST_SPARSE_STATES; ++slot ) {
+        s_testStates[ slot ].state      = testSparseId( slot );
+        s_testTrans[ slot ].curState    = testSparseId( slot );
+        s_testTrans[ slot ].nextState   = testSparseId( ( slot + 1U ) % DEF_TEST_SPARSE_STATES );
+    }
+
+    context.initState           = testSparseId( 0U );
+    context.curState            = DEF_SWC_FSM_STATE_INVALID;
+    context.preState            = DEF_SWC_FSM_STATE_INVALID;
+    context.curSlot             = DEF_SWC_FSM_INDEX_INVALID;
+    context.fsmStateList        = s_testStates;
+    context.fsmTransTable       = s_testTrans;
+    context.fsmTransOffset      = s_testOffset;
+    context.fsmTransEdge        = s_testEdge;
+    context.fsmStateTarget      = s_testTarget;
+    context.fsmStateMap         = s_testMap;
+    context.fsmStateMapSize     = DEF_SWC_FSM_STATE_MAP_SIZE( DEF_TEST_SPARSE_STATES );
+    context.fsmStateSize        = DEF_TEST_SPARSE_STATES;
+    context.fsmTransitionSize   = DEF_TEST_SPARSE_STATES;
+
+    TEST_CHECK( swcFsmInit( &context ) == FSM_OK );
+    TEST_CHECK( context.fsmStateMapMode == DEF_SWC_FSM_STATE_MAP_HASH );
+
+    for ( slot = 0; slot < DEF_TEST_SPARSE_STATES; ++slot ) {
+        TEST_CHECK( swcFsmGetStateSlot( testSparseId( slot ), &context ) == slot );
+        TEST_CHECK( swcFsmGetStateSlot( ( fsm_state_t )( testSparseId( slot ) + 1U ), &context ) == DEF_SWC_FSM_INDEX_INVALID );
+    }
+    TEST_CHECK( swcFsmGetStateSlot( 1U, &context ) == DEF_SWC_FSM_INDEX_INVALID );
+
+    for ( slot = 1U; slot <= DEF_TEST_SPARSE_STATES; ++slot ) {
+        TEST_CHECK( swcFsmTransTo( testSparseId( slot % DEF_TEST_SPARSE_STATES ), DEF_FSM_FALSE, &context ) == FSM_OK );
+    }
+    TEST_CHECK( swcFsmTransTo( testSparseId( 5U ), DEF_FSM_FALSE, &context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( ( swcFsmGetCurState( &context ) == testSparseId( 0U ) ) && ( context.curSlot == 0U ) );
+}
+
+int main( void )
+{
+    testCompact();
+    testSparse();
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file        testTables.c
+ * @brief       transitions of generated machines with more than 255 and more than 65535 rows
+ * @details     state s has the rows s -> s + 1 and s -> ( 7s + 3 ) mod N. One more state has no
+ *              incoming row, so forced transitions to it fail. Run with the linear lookup and
+ *              with FSM_STATE_FF, state ids equal slots for both.
+ */
+#include <string.h>
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+typedef struct
+{
+    SWCFsmContext                   context;
+    SWCFsmStateItem*                states;
+    SWCFsmTransItem*                trans;
+    fsm_index_t*                    offset;
+    SWCFsmTransEdge*                edge;
+    fsm_bool_t*                     target;
+} TestTables;
+
+static uint32_t s_testEntries = 0U;
+
+static fsm_error_t testEntry( void* item )
+{
+    UNUSED( item );
+    ++s_testEntries;
+    return FSM_OK;
+}
+
+static void testTablesCreate( TestTables* fsm, fsm_index_t ringSize )
+{
+    fsm_index_t stateSize = ringSize + 1U;
+    fsm_index_t transSize = ringSize * 2U;
+    fsm_index_t i;
+
+    memset( fsm, 0, sizeof( TestTables ) );
+    fsm->states = ( SWCFsmStateItem* )calloc( stateSize, sizeof( SWCFsmStateItem ) );
+    fsm->trans  = ( SWCFsmTransItem* )calloc( transSize, sizeof( SWCFsmTransItem ) );
+    fsm->offset = ( fsm_index_t* )calloc( stateSize + 1U, sizeof( fsm_index_t ) );
+    fsm->edge   = ( SWCFsmTransEdge* )calloc( transSize, sizeof( SWCFsmTransEdge ) );
+    fsm->target = ( fsm_bool_t* )calloc( stateSize, sizeof( fsm_bool_t ) );
+    TEST_CHECK( fsm->states && fsm->trans && fsm->offset && fsm->edge && fsm->target );
+
+    for ( i = 0; i < stateSize; ++i ) {
+        fsm->states[ i ].state = ( fsm_state_t )i;
+        fsm->states[ i ].entry = testEntry;
+    }
+    for ( i = 0; i < ringSize; ++i ) {
+        fsm->trans[ 2U * i ].curState       = ( fsm_state_t )i;
+        fsm->trans[ 2U * i ].nextState      = ( fsm_state_t )( ( i + 1U ) % ringSize );
+        fsm->trans[ 2U * i + 1U ].curState  = ( fsm_state_t )i;
+        fsm->trans[ 2U * i + 1U ].nextState = ( fsm_state_t )( ( 7U * i + 3U ) % ringSize );
+    }
+
+    fsm->context.initState          = 0U;
+    fsm->context.curState           = DEF_SWC_FSM_STATE_INVALID;
+    fsm->context.preState           = DEF_SWC_FSM_STATE_INVALID;
+    fsm->context.curSlot            = DEF_SWC_FSM_INDEX_INVALID;
+    fsm->context.fsmStateList       = fsm->states;
+    fsm->context.fsmTransTable      = fsm->trans;
+    fsm->context.fsmTransOffset     = fsm->offset;
+    fsm->context.fsmTransEdge       = fsm->edge;
+    fsm->context.fsmStateTarget     = fsm->target;
+    fsm->context.fsmStateSize       = stateSize;
+    fsm->context.fsmTransitionSize  = transSize;
+}
+
+static void testTablesDestroy( TestTables* fsm )
+{
+    free( fsm->states );
+    free( fsm->trans );
+    free( fsm->offset );
+    free( fsm->edge );
+    free( fsm->target );
+}
+
+static void testTablesRun( fsm_index_t ringSize )
+{
+    TestTables fsm;
+    SWCFsmContext* context = &( fsm.context );
+    fsm_state_t isolated = ( fsm_state_t )ringSize;
+    fsm_index_t i;
+
+    testTablesCreate( &fsm, ringSize );
+    s_testEntries = 0U;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( context->fsmIndexReady && ( swcFsmGetCurState( context ) == 0U ) && ( s_testEntries == 1U ) );
+    TEST_CHECK( context->fsmTransOffset[ ringSize ] == 2U * ringSize );
+    TEST_CHECK( context->fsmTransOffset[ ringSize + 1U ] == 2U * ringSize );
+    TEST_CHECK( context->fsmStateTarget[ ringSize - 1U ] && !( context->fsmStateTarget[ isolated ] ) );
+
+    // once around the ring, the last row of the table is reached too
+    for ( i = 1U; i <= ringSize; ++i ) {
+        TEST_CHECK( swcFsmTransTo( ( fsm_state_t )( i % ringSize ), DEF_FSM_FALSE, context ) == FSM_OK );
+        TEST_CHECK( context->curSlot == i % ringSize );
+    }
+    TEST_CHECK( s_testEntries == ringSize + 1U );
+
+    // the second row of every state, then a state no row of the current one leads to
+    TEST_CHECK( swcFsmTransTo( 3U, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( 24U, DEF_FSM_FALSE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( 27U, DEF_FSM_FALSE, context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( swcFsmGetCurState( context ) == 24U );
+
+    // forced transitions need some row leading to the state, wherever it starts
+    TEST_CHECK( swcFsmTransTo( ( fsm_state_t )( ringSize - 2U ), DEF_FSM_TRUE, context ) == FSM_OK );
+    TEST_CHECK( swcFsmTransTo( isolated, DEF_FSM_TRUE, context ) == FSM_ERR_NO_TRANSITION );
+    TEST_CHECK( swcFsmTransTo( ( fsm_state_t )( ringSize + 7U ), DEF_FSM_TRUE, context ) != FSM_OK );
+    TEST_CHECK( swcFsmGetCurState( context ) == ringSize - 2U );
+    TEST_CHECK( swcFsmGetPreState( context ) == 24U );
+
+    swcFsmExit( context );
+    testTablesDestroy( &fsm );
+}
+
+int main( void )
+{
+    testTablesRun( 200U );          // 400 rows
+    testTablesRun( 40000U );        // 80000 rows
+
+    return 0;
+}
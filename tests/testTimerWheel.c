@@ -0,0 +1,106 @@
+/**
+ * @file        testTimerWheel.c
+ * @brief       FSM_TIMER_WHEEL routine intervals and state timeouts
+ * @details     the context routine runs every 10 ms, IDLE runs its routine every 7 ms and times
+ *              out to WAIT after 50 ms, WAIT times out back to IDLE after 30 ms. Leaving IDLE for
+ *              STOP must disarm its timers, swcFsmExit every timer of the context.
+ */
+#include "SWC_Fsm.h"
+#include "testFsm.h"
+
+#define DEF_TEST_ROUTINE                ( 10U )             // ms
+#define DEF_TEST_IDLE_ROUTINE           ( 7U )
+#define DEF_TEST_IDLE_TIMEOUT           ( 50U )
+#define DEF_TEST_WAIT_TIMEOUT           ( 30U )
+
+enum
+{
+    TEST_STATE_IDLE,
+    TEST_STATE_WAIT,
+    TEST_STATE_STOP,
+};
+
+static uint32_t s_testRoutines = 0U;
+static uint32_t s_testIdleRoutines = 0U;
+static uint32_t s_testWaitEntries = 0U;
+
+static fsm_error_t testRoutine( void* context )
+{
+    UNUSED( context );
+    ++s_testRoutines;
+    return FSM_OK;
+}
+
+static fsm_error_t testIdleRoutine( void* item )
+{
+    UNUSED( item );
+    ++s_testIdleRoutines;
+    return FSM_OK;
+}
+
+static fsm_error_t testWaitEntry( void* item )
+{
+    UNUSED( item );
+    ++s_testWaitEntries;
+    return FSM_OK;
+}
+
+DECLARE_SWC_FSM_TIMER_WHEEL( Test )
+
+DECLARE_SWC_FSM_CONTEXT( Timer, 1,
+    DECLARE_SWC_FSM_STATES(
+        DECLARE_SWC_FSM_STATE_TIMEOUT( TEST_STATE_IDLE, NULL, testIdleRoutine, NULL, DEF_TEST_IDLE_ROUTINE, DEF_TEST_IDLE_TIMEOUT, TEST_STATE_WAIT ),
+        DECLARE_SWC_FSM_STATE_TIMEOUT( TEST_STATE_WAIT, testWaitEntry, NULL, NULL, 0, DEF_TEST_WAIT_TIMEOUT, TEST_STATE_IDLE ),
+        DECLARE_SWC_FSM_STATE( TEST_STATE_STOP, NULL, NULL, NULL, 0 ), ),
+    DECLARE_SWC_FSM_TRANSITIONS(
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_WAIT, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_WAIT, TEST_STATE_IDLE, NULL ),
+        DECLARE_SWC_FSM_TRANSITION( TEST_STATE_IDLE, TEST_STATE_STOP, NULL ), ),
+    NULL, NULL, TEST_STATE_IDLE, DEF_TEST_ROUTINE, NULL, testRoutine, NULL )
+
+int main( void )
+{
+    SWCFsmContext* context = DECLARE_SWC_FSM_CONTEXT_REF( Timer );
+    SWCFsmTimerWheel* wheel = DECLARE_SWC_FSM_TIMER_WHEEL_REF( Test );
+    uint32_t elapsed = 0;
+
+    TEST_CHECK( swcFsmInit( context ) == FSM_OK );
+    TEST_CHECK( swcFsmWheelAdd( context, wheel ) == FSM_OK );
+    TEST_CHECK( swcFsmWheelAdd( context, wheel ) == FSM_ERR_BUSY );
+    TEST_CHECK( swcFsmWheelNextDue( wheel ) == DEF_TEST_IDLE_ROUTINE );
+
+    // one ms short of the timeout, IDLE ran its routine at 7, 14 .. 49
+    for ( elapsed = 0; elapsed < DEF_TEST_IDLE_TIMEOUT - 1U; ++elapsed ) {
+        swcFsmWheelAdvance( wheel, 1U );
+    }
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_IDLE );
+    TEST_CHECK( s_testIdleRoutines == ( DEF_TEST_IDLE_TIMEOUT - 1U ) / DEF_TEST_IDLE_ROUTINE );
+    TEST_CHECK( s_testRoutines == ( DEF_TEST_IDLE_TIMEOUT - 1U ) / DEF_TEST_ROUTINE );
+
+    swcFsmWheelAdvance( wheel, 1U );
+    TEST_CHECK( ( swcFsmGetCurState( context ) == TEST_STATE_WAIT ) && ( s_testWaitEntries == 1U ) );
+
+    // a single step over the whole WAIT timeout, IDLE is entered again at 80 ms
+    swcFsmWheelAdvance( wheel, DEF_TEST_WAIT_TIMEOUT );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_IDLE );
+    TEST_CHECK( s_testIdleRoutines == ( DEF_TEST_IDLE_TIMEOUT - 1U ) / DEF_TEST_IDLE_ROUTINE );
+    TEST_CHECK( s_testRoutines == 8U );
+
+    swcFsmWheelAdvance( wheel, DEF_TEST_IDLE_ROUTINE );
+    TEST_CHECK( s_testIdleRoutines == ( DEF_TEST_IDLE_TIMEOUT - 1U ) / DEF_TEST_IDLE_ROUTINE + 1U );
+
+    // STOP has no timers of its own, only the context routine keeps running
+    TEST_CHECK( swcFsmTransTo( TEST_STATE_STOP, DEF_FSM_FALSE, context ) == FSM_OK );
+    swcFsmWheelAdvance( wheel, 1000U );
+    TEST_CHECK( swcFsmGetCurState( context ) == TEST_STATE_STOP );
+    TEST_CHECK( s_testIdleRoutines == ( DEF_TEST_IDLE_TIMEOUT - 1U ) / DEF_TEST_IDLE_ROUTINE + 1U );
+    TEST_CHECK( s_testWaitEntries == 1U );
+    TEST_CHECK( s_testRoutines == ( 80U + DEF_TEST_IDLE_ROUTINE + 1000U ) / DEF_TEST_ROUTINE );
+    TEST_CHECK( swcFsmWheelNextDue( wheel ) <= DEF_TEST_ROUTINE );
+
+    swcFsmExit( context );
+    TEST_CHECK( ( wheel->armed == 0U ) && ( swcFsmWheelNextDue( wheel ) == DEF_SWC_FSM_WHEEL_IDLE ) );
+    TEST_CHECK( swcFsmWheelAdvance( wheel, 1000U ) == 0U );
+
+    return 0;
+}
@@ -0,0 +1,682 @@
+/**
+ * @file        fsmc.c
+ * @brief       offline table compiler, turns an FSM description into a header for SWC_Fsm.h
+ * @details     the description is line based, '#' starts a comment:
+ *
+ *                  fsm     Door 1                      name and fsmContextID
+ *                  init    CLOSED                      init state
+ *                  interval 100                        fsmRoutineInterval in ms, default 0
+ *                  check   canMove                     fsmCommonCheck, optional
+ *                  error   onError                     fsmErrorHandler, optional
+ *                  hooks   doorInit doorRoutine -      fsmInit, fsmRoutine, fsmExit, '-' for none
+ *                  state   CLOSED entry=onClosed routine=pollClosed exit=leaveClosed every=100
+ *                  CLOSED -> OPEN if canOpen           transition with an optional guard
+ *
+ *              states get dense slots in breadth first order from the init state and their id is
+ *              their slot, so FSM_STATE_FF applies. rows are sorted by source slot and emitted with
+ *              the CSR offsets and edges swcFsmBuildIndex would compute, all cache line aligned,
+ *              for DECLARE_SWC_FSM_CONTEXT_PREBUILT. undeclared or duplicate states, duplicate
+ *              rows, an init state no row enters and states unreachable from it are errors.
+ *
+ *              usage: fsmc [ -o output.h ] [ -n ] input.fsm
+ *                  -o      write to output.h instead of stdout
+ *                  -n      no prototypes for the callbacks, declare them before the include
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#define DEF_FSMC_LINE                   ( 1024U )
+#define DEF_FSMC_TOKENS                 ( 16U )
+#define DEF_FSMC_NAME                   ( 64U )
+#define DEF_FSMC_STATE_MAX              ( 0xFFFEU )     // DEF_SWC_FSM_STATE_INVALID is 0xFFFF
+#define DEF_FSMC_NONE                   ( 0xFFFFFFFFU )
+#define DEF_FSMC_DEAD_REPORTS           ( 32U )         // unreachable states listed one by one
+
+// callback kinds, one prototype each
+#define DEF_FSMC_KIND_ACTION            ( 0U )          // ptrSWCFunTransferAction
+#define DEF_FSMC_KIND_CHECK             ( 1U )          // ptrSWCFunTransferCheck
+#define DEF_FSMC_KIND_HOOK              ( 2U )          // ptrSWCFunFSMAction
+#define DEF_FSMC_KIND_ERROR             ( 3U )          // ptrSWCFsmErrorHandler
+
+typedef struct
+{
+    char                            name[ DEF_FSMC_NAME ];
+    char                            entry[ DEF_FSMC_NAME ];
+    char                            routine[ DEF_FSMC_NAME ];
+    char                            exit[ DEF_FSMC_NAME ];
+    uint32_t                        interval;
+    uint32_t                        line;
+    uint32_t                        slot;           // DEF_FSMC_NONE until reached from the init state
+} FsmcState;
+
+typedef struct
+{
+    char                            fromName[ DEF_FSMC_NAME ];
+    char                            toName[ DEF_FSMC_NAME ];
+    char                            guard[ DEF_FSMC_NAME ];
+    uint32_t                        from;           // state index
+    uint32_t                        to;
+    uint32_t                        line;
+} FsmcTrans;
+
+// open addressing set of names, value is an index or a callback kind
+typedef struct
+{
+    const char**                    keys;
+    uint32_t*                       values;
+    uint32_t                        mask;
+} FsmcNames;
+
+typedef struct
+{
+    char                            name[ DEF_FSMC_NAME ];
+    uint32_t                        id;
+    uint32_t                        nameLine;
+    char                            init[ DEF_FSMC_NAME ];
+    uint32_t                        initLine;
+    uint32_t                        interval;
+    char                            check[ DEF_FSMC_NAME ];
+    char                            error[ DEF_FSMC_NAME ];
+    char                            hookInit[ DEF_FSMC_NAME ];
+    char                            hookRoutine[ DEF_FSMC_NAME ];
+    char                            hookExit[ DEF_FSMC_NAME ];
+
+    FsmcState*                      states;
+    uint32_t                        stateSize;
+    uint32_t                        stateCapacity;
+    FsmcTrans*                      trans;
+    uint32_t                        transSize;
+    uint32_t                        transCapacity;
+
+    uint32_t*                       order;          // state index by slot
+    uint32_t*                       offset;         // CSR row offsets by slot, stateSize + 1 entries
+    uint32_t*                       rows;           // trans index by sorted position
+
+    const char*                     path;
+    uint32_t                        errors;
+} Fsmc;
+
+static void fsmcError( Fsmc* fsmc, uint32_t line, const char* message, const char* detail )
+{
+    fprintf( stderr, "%s:%u: error: %s%s%s\n", fsmc->path, line, message, detail ? " " : "", detail ? detail : "" );
+    ++( fsmc->errors );
+}
+
+static void fsmcWarning( Fsmc* fsmc, uint32_t line, const char* message, const char* detail )
+{
+    fprintf( stderr, "%s:%u: warning: %s%s%s\n", fsmc->path, line, message, detail ? " " : "", detail ? detail : "" );
+}
+
+static void* fsmcAlloc( size_t size )
+{
+    void* data = calloc( 1, size ? size : 1U );
+
+    if ( !data ) {
+        fprintf( stderr, "fsmc: out of memory\n" );
+        exit( 2 );
+    }
+
+    return data;
+}
+
+static void* fsmcGrow( void* data, uint32_t* capacity, size_t item )
+{
+    uint32_t next = ( *capacity ) ? ( *capacity ) * 2U : 64U;
+    void* grown = realloc( data, ( size_t )next * item );
+
+    if ( !grown ) {
+        fprintf( stderr, "fsmc: out of memory\n" );
+        exit( 2 );
+    }
+    *capacity = next;
+
+    return grown;
+}
+
+static int fsmcIdentifier( const char* name )
+{
+    if ( !( isalpha( ( unsigned char )name[ 0 ] ) || ( name[ 0 ] == '_' ) ) )  return 0;
+
+    for ( ++name; *name; ++name ) {
+        if ( !( isalnum( ( unsigned char )*name ) || ( *name == '_' ) ) )   return 0;
+    }
+
+    return 1;
+}
+
+static void fsmcNamesInit( FsmcNames* names, uint32_t count )
+{
+    uint32_t size = 16U;
+
+    while ( size < count * 2U )     size <<= 1;
+
+    names->keys     = ( const char** )fsmcAlloc( size * sizeof( const char* ) );
+    names->values   = ( uint32_t* )fsmcAlloc( size * sizeof( uint32_t ) );
+    names->mask     = size - 1U;
+}
+
+static void fsmcNamesFree( FsmcNames* names )
+{
+    free( ( void* )names->keys );
+    free( names->values );
+}
+
+// slot of key, empty when key is not in the set
+static uint32_t fsmcNamesFind( FsmcNames* names, const char* key )
+{
+    uint32_t hash = 2166136261U;
+    const char* c = key;
+
+    for ( ; *c; ++c ) {
+        hash = ( hash ^ ( uint8_t )( *c ) ) * 16777619U;
+    }
+
+    hash &= names->mask;
+    while ( names->keys[ hash ] && strcmp( names->keys[ hash ], key ) ) {
+        hash = ( hash + 1U ) & names->mask;
+    }
+
+    return hash;
+}
+
+// copy a token, callbacks may be '-' or "NULL" for none
+static int fsmcCopy( Fsmc* fsmc, uint32_t line, char* dst, const char* src, int bCallback )
+{
+    if ( bCallback && ( !strcmp( src, "-" ) || !strcmp( src, "NULL" ) ) ) {
+        dst[ 0 ] = '\0';
+        return 1;
+    }
+
+    if ( ( strlen( src ) >= DEF_FSMC_NAME ) || !fsmcIdentifier( src ) ) {
+        fsmcError( fsmc, line, "not a C identifier:", src );
+        return 0;
+    }
+
+    strcpy( dst, src );
+
+    return 1;
+}
+
+static int fsmcNumber( Fsmc* fsmc, uint32_t line, const char* src, uint32_t* value )
+{
+    char* end = NULL;
+    unsigned long number = strtoul( src, &end, 0 );
+
+    if ( !*src || *end || ( number > 0xFFFFFFFFUL ) ) {
+        fsmcError( fsmc, line, "not a 32 bit number:", src );
+        return 0;
+    }
+
+    *value = ( uint32_t )number;
+
+    return 1;
+}
+
+static void fsmcParseState( Fsmc* fsmc, uint32_t line, char** tokens, uint32_t count )
+{
+    FsmcState* state = NULL;
+    uint32_t index = 0;
+    char* value = NULL;
+
+    if ( count < 2U ) {
+        fsmcError( fsmc, line, "state needs a name", NULL );
+        return;
+    }
+
+    if ( fsmc->stateSize == fsmc->stateCapacity ) {
+        fsmc->states = ( FsmcState* )fsmcGrow( fsmc->states, &( fsmc->stateCapacity ), sizeof( FsmcState ) );
+    }
+    state = &( fsmc->states[ fsmc->stateSize++ ] );
+    memset( state, 0, sizeof( *state ) );
+    state->line = line;
+    state->slot = DEF_FSMC_NONE;
+    fsmcCopy( fsmc, line, state->name, tokens[ 1 ], 0 );
+
+    for ( index = 2; index < count; ++index ) {
+        value = strchr( tokens[ index ], '=' );
+        if ( !value ) {
+            fsmcError( fsmc, line, "expected key=value, got", tokens[ index ] );
+            continue;
+        }
+        *value++ = '\0';
+
+        if ( !strcmp( tokens[ index ], "entry" ) ) {
+            fsmcCopy( fsmc, line, state->entry, value, 1 );
+        } else if ( !strcmp( tokens[ index ], "routine" ) ) {
+            fsmcCopy( fsmc, line, state->routine, value, 1 );
+        } else if ( !strcmp( tokens[ index ], "exit" ) ) {
+            fsmcCopy( fsmc, line, state->exit, value, 1 );
+        } else if ( !strcmp( tokens[ index ], "every" ) ) {
+            fsmcNumber( fsmc, line, value, &( state->interval ) );
+        } else {
+            fsmcError( fsmc, line, "unknown state attribute", tokens[ index ] );
+        }
+    }
+}
+
+static void fsmcParseTrans( Fsmc* fsmc, uint32_t line, char** tokens, uint32_t count )
+{
+    FsmcTrans* trans = NULL;
+
+    if ( ( count != 3U ) && !( ( count == 5U ) && !strcmp( tokens[ 3 ], "if" ) ) ) {
+        fsmcError( fsmc, line, "expected FROM -> TO [ if GUARD ]", NULL );
+        return;
+    }
+
+    if ( fsmc->transSize == fsmc->transCapacity ) {
+        fsmc->trans = ( FsmcTrans* )fsmcGrow( fsmc->trans, &( fsmc->transCapacity ), sizeof( FsmcTrans ) );
+    }
+    trans = &( fsmc->trans[ fsmc->transSize++ ] );
+    memset( trans, 0, sizeof( *trans ) );
+    trans->line = line;
+    fsmcCopy( fsmc, line, trans->fromName, tokens[ 0 ], 0 );
+    fsmcCopy( fsmc, line, trans->toName, tokens[ 2 ], 0 );
+    if ( count == 5U )  fsmcCopy( fsmc, line, trans->guard, tokens[ 4 ], 1 );
+}
+
+static void fsmcParseLine( Fsmc* fsmc, uint32_t line, char* text )
+{
+    char* tokens[ DEF_FSMC_TOKENS ];
+    uint32_t count = 0;
+    char* comment = strchr( text, '#' );
+    char* token = NULL;
+
+    if ( comment )  *comment = '\0';
+
+    for ( token = strtok( text, " \t\r\n" ); token; token = strtok( NULL, " \t\r\n" ) ) {
+        if ( count == DEF_FSMC_TOKENS ) {
+            fsmcError( fsmc, line, "too many tokens", NULL );
+            return;
+        }
+        tokens[ count++ ] = token;
+    }
+
+    if ( count == 0U )  return;
+
+    if ( ( count >= 2U ) && !strcmp( tokens[ 1 ], "->" ) ) {
+        fsmcParseTrans( fsmc, line, tokens, count );
+    } else if ( !strcmp( tokens[ 0 ], "state" ) ) {
+        fsmcParseState( fsmc, line, tokens, count );
+    } else if ( !strcmp( tokens[ 0 ], "fsm" ) && ( count == 3U ) ) {
+        fsmc->nameLine = line;
+        fsmcCopy( fsmc, line, fsmc->name, tokens[ 1 ], 0 );
+        fsmcNumber( fsmc, line, tokens[ 2 ], &( fsmc->id ) );
+    } else if ( !strcmp( tokens[ 0 ], "init" ) && ( count == 2U ) ) {
+        fsmc->initLine = line;
+        fsmcCopy( fsmc, line, fsmc->init, tokens[ 1 ], 0 );
+    } else if ( !strcmp( tokens[ 0 ], "interval" ) && ( count == 2U ) ) {
+        fsmcNumber( fsmc, line, tokens[ 1 ], &( fsmc->interval ) );
+    } else if ( !strcmp( tokens[ 0 ], "check" ) && ( count == 2U ) ) {
+        fsmcCopy( fsmc, line, fsmc->check, tokens[ 1 ], 1 );
+    } else if ( !strcmp( tokens[ 0 ], "error" ) && ( count == 2U ) ) {
+        fsmcCopy( fsmc, line, fsmc->error, tokens[ 1 ], 1 );
+    } else if ( !strcmp( tokens[ 0 ], "hooks" ) && ( count == 4U ) ) {
+        fsmcCopy( fsmc, line, fsmc->hookInit, tokens[ 1 ], 1 );
+        fsmcCopy( fsmc, line, fsmc->hookRoutine, tokens[ 2 ], 1 );
+        fsmcCopy( fsmc, line, fsmc->hookExit, tokens[ 3 ], 1 );
+    } else {
+        fsmcError( fsmc, line, "unknown statement", tokens[ 0 ] );
+    }
+}
+
+static void fsmcParse( Fsmc* fsmc, FILE* input )
+{
+    char text[ DEF_FSMC_LINE ];
+    uint32_t line = 0;
+
+    while ( fgets( text, sizeof( text ), input ) ) {
+        ++line;
+        if ( !strchr( text, '\n' ) && !feof( input ) ) {
+            fsmcError( fsmc, line, "line too long", NULL );
+            return;
+        }
+        fsmcParseLine( fsmc, line, text );
+    }
+}
+
+// resolve names, assign slots breadth first from the init state and sort rows by source slot
+static void fsmcResolve( Fsmc* fsmc )
+{
+    FsmcNames names;
+    uint32_t* first = NULL;         // rows by declaring state, CSR over state indices
+    uint32_t* byState = NULL;
+    uint32_t* seen = NULL;
+    uint32_t index = 0;
+    uint32_t pos = 0;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t dead = 0;
+    uint32_t state = 0;
+    uint32_t init = DEF_FSMC_NONE;
+    int bEntered = 0;
+
+    if ( !fsmc->name[ 0 ] )     fsmcError( fsmc, 1, "missing 'fsm NAME ID'", NULL );
+    if ( fsmc->stateSize == 0U ) {
+        fsmcError( fsmc, 1, "no states", NULL );
+        return;
+    }
+    if ( fsmc->stateSize > DEF_FSMC_STATE_MAX ) {
+        fsmcError( fsmc, fsmc->states[ DEF_FSMC_STATE_MAX ].line, "too many states for fsm_state_t", NULL );
+        return;
+    }
+
+    fsmcNamesInit( &names, fsmc->stateSize );
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        pos = fsmcNamesFind( &names, fsmc->states[ index ].name );
+        if ( names.keys[ pos ] ) {
+            fsmcError( fsmc, fsmc->states[ index ].line, "duplicate state", fsmc->states[ index ].name );
+            continue;
+        }
+        names.keys[ pos ]   = fsmc->states[ index ].name;
+        names.values[ pos ] = index;
+        if ( !strcmp( fsmc->states[ index ].name, "COUNT" ) ) {
+            fsmcError( fsmc, fsmc->states[ index ].line, "state name reserved for DEF_STATE_<fsm>_COUNT:", fsmc->states[ index ].name );
+        }
+    }
+
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        pos = fsmcNamesFind( &names, fsmc->trans[ index ].fromName );
+        fsmc->trans[ index ].from = names.keys[ pos ] ? names.values[ pos ] : DEF_FSMC_NONE;
+        if ( !names.keys[ pos ] )   fsmcError( fsmc, fsmc->trans[ index ].line, "undeclared state", fsmc->trans[ index ].fromName );
+
+        pos = fsmcNamesFind( &names, fsmc->trans[ index ].toName );
+        fsmc->trans[ index ].to = names.keys[ pos ] ? names.values[ pos ] : DEF_FSMC_NONE;
+        if ( !names.keys[ pos ] )   fsmcError( fsmc, fsmc->trans[ index ].line, "undeclared state", fsmc->trans[ index ].toName );
+    }
+
+    if ( !fsmc->init[ 0 ] ) {
+        fsmcError( fsmc, 1, "missing 'init STATE'", NULL );
+    } else {
+        pos = fsmcNamesFind( &names, fsmc->init );
+        if ( names.keys[ pos ] ) {
+            init = names.values[ pos ];
+        } else {
+            fsmcError( fsmc, fsmc->initLine, "undeclared init state", fsmc->init );
+        }
+    }
+    fsmcNamesFree( &names );
+
+    if ( fsmc->errors || ( init == DEF_FSMC_NONE ) )    return;
+
+    // rows grouped by declaring state, in file order
+    first   = ( uint32_t* )fsmcAlloc( ( fsmc->stateSize + 1U ) * sizeof( uint32_t ) );
+    byState = ( uint32_t* )fsmcAlloc( ( fsmc->transSize + 1U ) * sizeof( uint32_t ) );
+    seen    = ( uint32_t* )fsmcAlloc( fsmc->stateSize * sizeof( uint32_t ) );
+
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        ++( first[ fsmc->trans[ index ].from + 1U ] );
+        if ( fsmc->trans[ index ].to == init )  bEntered = 1;
+    }
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        first[ index + 1U ] += first[ index ];
+    }
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        byState[ first[ fsmc->trans[ index ].from ] + ( seen[ fsmc->trans[ index ].from ] )++ ] = index;
+    }
+
+    if ( !bEntered )    fsmcError( fsmc, fsmc->initLine, "no transition enters the init state, swcFsmInit would fail:", fsmc->init );
+
+    // duplicate rows, seen[ to ] holds the last source that named it plus one
+    memset( seen, 0, fsmc->stateSize * sizeof( uint32_t ) );
+    for ( state = 0; state < fsmc->stateSize; ++state ) {
+        for ( pos = first[ state ]; pos < first[ state + 1U ]; ++pos ) {
+            index = fsmc->trans[ byState[ pos ] ].to;
+            if ( seen[ index ] == state + 1U ) {
+                fsmcError( fsmc, fsmc->trans[ byState[ pos ] ].line, "duplicate transition to", fsmc->states[ index ].name );
+            }
+            seen[ index ] = state + 1U;
+        }
+    }
+
+    // breadth first from the init state, the visiting order is the slot order
+    fsmc->order = ( uint32_t* )fsmcAlloc( fsmc->stateSize * sizeof( uint32_t ) );
+    fsmc->order[ tail++ ] = init;
+    fsmc->states[ init ].slot = 0;
+    while ( head < tail ) {
+        state = fsmc->order[ head++ ];
+        for ( pos = first[ state ]; pos < first[ state + 1U ]; ++pos ) {
+            index = fsmc->trans[ byState[ pos ] ].to;
+            if ( fsmc->states[ index ].slot == DEF_FSMC_NONE ) {
+                fsmc->states[ index ].slot = tail;
+                fsmc->order[ tail++ ] = index;
+            }
+        }
+        if ( first[ state ] == first[ state + 1U ] ) {
+            fsmcWarning( fsmc, fsmc->states[ state ].line, "no transition leaves", fsmc->states[ state ].name );
+        }
+    }
+
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        if ( fsmc->states[ index ].slot != DEF_FSMC_NONE )  continue;
+        if ( dead++ < DEF_FSMC_DEAD_REPORTS ) {
+            fsmcError( fsmc, fsmc->states[ index ].line, "state unreachable from the init state:", fsmc->states[ index ].name );
+        }
+    }
+    if ( dead > DEF_FSMC_DEAD_REPORTS ) {
+        fprintf( stderr, "%s: error: %u more unreachable states\n", fsmc->path, dead - DEF_FSMC_DEAD_REPORTS );
+    }
+
+    // rows sorted by source slot, file order within a slot
+    if ( fsmc->errors == 0U ) {
+        fsmc->offset    = ( uint32_t* )fsmcAlloc( ( fsmc->stateSize + 1U ) * sizeof( uint32_t ) );
+        fsmc->rows      = ( uint32_t* )fsmcAlloc( ( fsmc->transSize + 1U ) * sizeof( uint32_t ) );
+        for ( index = 0; index < fsmc->stateSize; ++index ) {
+            state = fsmc->order[ index ];
+            fsmc->offset[ index + 1U ] = fsmc->offset[ index ] + ( first[ state + 1U ] - first[ state ] );
+            memcpy( &( fsmc->rows[ fsmc->offset[ index ] ] ), &( byState[ first[ state ] ] ), ( first[ state + 1U ] - first[ state ] ) * sizeof( uint32_t ) );
+        }
+    }
+
+    free( first );
+    free( byState );
+    free( seen );
+}
+
+static const char* fsmcOr( const char* name )
+{
+    return name[ 0 ] ? name : "NULL";
+}
+
+// one prototype per callback, a name used with two signatures is an error
+static void fsmcPrototype( Fsmc* fsmc, FsmcNames* names, FILE* output, const char* name, uint32_t kind, uint32_t line )
+{
+    static const char* s_formats[] = {
+        "fsm_error_t %s( void* state );\n",
+        "fsm_bool_t %s( fsm_state_t from, fsm_state_t to, void* context );\n",
+        "fsm_error_t %s( void* context );\n",
+        "void %s( fsm_error_t error, fsm_state_t curState, fsm_state_t nextState, void* context );\n"
+    };
+    uint32_t pos = 0;
+
+    if ( !name[ 0 ] )   return;
+
+    pos = fsmcNamesFind( names, name );
+    if ( names->keys[ pos ] ) {
+        if ( names->values[ pos ] != kind )     fsmcError( fsmc, line, "callback used with two signatures:", name );
+        return;
+    }
+    names->keys[ pos ]      = name;
+    names->values[ pos ]    = kind;
+
+    if ( output )   fprintf( output, s_formats[ kind ], name );
+}
+
+static void fsmcPrototypes( Fsmc* fsmc, FILE* output )
+{
+    FsmcNames names;
+    FsmcState* state = NULL;
+    uint32_t index = 0;
+
+    fsmcNamesInit( &names, 3U * fsmc->stateSize + fsmc->transSize + 5U );
+
+    fsmcPrototype( fsmc, &names, output, fsmc->check, DEF_FSMC_KIND_CHECK, 1 );
+    fsmcPrototype( fsmc, &names, output, fsmc->error, DEF_FSMC_KIND_ERROR, 1 );
+    fsmcPrototype( fsmc, &names, output, fsmc->hookInit, DEF_FSMC_KIND_HOOK, 1 );
+    fsmcPrototype( fsmc, &names, output, fsmc->hookRoutine, DEF_FSMC_KIND_HOOK, 1 );
+    fsmcPrototype( fsmc, &names, output, fsmc->hookExit, DEF_FSMC_KIND_HOOK, 1 );
+
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        state = &( fsmc->states[ fsmc->order[ index ] ] );
+        fsmcPrototype( fsmc, &names, output, state->entry, DEF_FSMC_KIND_ACTION, state->line );
+        fsmcPrototype( fsmc, &names, output, state->routine, DEF_FSMC_KIND_ACTION, state->line );
+        fsmcPrototype( fsmc, &names, output, state->exit, DEF_FSMC_KIND_ACTION, state->line );
+    }
+
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        fsmcPrototype( fsmc, &names, output, fsmc->trans[ fsmc->rows[ index ] ].guard, DEF_FSMC_KIND_CHECK, fsmc->trans[ fsmc->rows[ index ] ].line );
+    }
+
+    fsmcNamesFree( &names );
+}
+
+static void fsmcEmit( Fsmc* fsmc, FILE* output, int bPrototypes )
+{
+    FsmcState* state = NULL;
+    FsmcTrans* trans = NULL;
+    uint8_t* target = NULL;
+    uint32_t index = 0;
+    uint32_t fanOut = 0;
+    const char* name = fsmc->name;
+    const char* source = strrchr( fsmc->path, '/' );
+
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        if ( fsmc->offset[ index + 1U ] - fsmc->offset[ index ] > fanOut )  fanOut = fsmc->offset[ index + 1U ] - fsmc->offset[ index ];
+    }
+
+    fprintf( output, "/**\n" );
+    fprintf( output, " * @brief       tables of %s, generated by fsmc from %s, do not edit\n", name, source ? source + 1 : fsmc->path );
+    fprintf( output, " * @details     %u states, %u transitions, at most %u leaving one state.\n", fsmc->stateSize, fsmc->transSize, fanOut );
+    fprintf( output, " *              state ids are slots, rows are grouped by source and the index is prebuilt.\n" );
+    fprintf( output, " */\n" );
+    fprintf( output, "#ifndef SWC_FSM_TABLES_%s_H_\n#define SWC_FSM_TABLES_%s_H_\n\n", name, name );
+    fprintf( output, "#include \"SWC_Fsm.h\"\n\n" );
+
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        fprintf( output, "#define DEF_STATE_%s_%-24s ( %uU )\n", name, fsmc->states[ fsmc->order[ index ] ].name, index );
+    }
+    fprintf( output, "#define DEF_STATE_%s_%-24s ( %uU )\n\n", name, "COUNT", fsmc->stateSize );
+
+    if ( bPrototypes ) {
+        fsmcPrototypes( fsmc, output );
+        fprintf( output, "\n" );
+    }
+
+    fprintf( output, "static SWCFsmStateItem s_fsmState%s[] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ) = {\n", name );
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        state = &( fsmc->states[ fsmc->order[ index ] ] );
+        fprintf( output, "    DECLARE_SWC_FSM_STATE( DEF_STATE_%s_%s, %s, %s, %s, %u ),\n", name, state->name,
+                 fsmcOr( state->entry ), fsmcOr( state->routine ), fsmcOr( state->exit ), state->interval );
+    }
+    fprintf( output, "};\n\n" );
+
+    fprintf( output, "static SWCFsmTransItem s_fsmTransTable%s[] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ) = {\n", name );
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        trans = &( fsmc->trans[ fsmc->rows[ index ] ] );
+        fprintf( output, "    DECLARE_SWC_FSM_TRANSITION( DEF_STATE_%s_%s, DEF_STATE_%s_%s, %s ),\n", name, fsmc->states[ trans->from ].name,
+                 name, fsmc->states[ trans->to ].name, fsmcOr( trans->guard ) );
+    }
+    fprintf( output, "};\n\n" );
+
+    fprintf( output, "static fsm_index_t s_fsmTransOffset%s[ %u ] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ) = {", name, fsmc->stateSize + 1U );
+    for ( index = 0; index <= fsmc->stateSize; ++index ) {
+        fprintf( output, "%s%uU%s", ( index % 16U ) ? " " : "\n    ", fsmc->offset[ index ], ( index < fsmc->stateSize ) ? "," : "" );
+    }
+    fprintf( output, "\n};\n\n" );
+
+    fprintf( output, "static SWCFsmTransEdge s_fsmTransEdge%s[] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ) = {\n", name );
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        trans = &( fsmc->trans[ fsmc->rows[ index ] ] );
+        fprintf( output, "    { .nextState = DEF_STATE_%s_%s, .nextSlot = %uU, .transIndex = %uU },\n", name, fsmc->states[ trans->to ].name,
+                 fsmc->states[ trans->to ].slot, index );
+    }
+    fprintf( output, "};\n\n" );
+
+    // slots some row leads to, checked by forced transitions
+    target = ( uint8_t* )fsmcAlloc( fsmc->stateSize );
+    for ( index = 0; index < fsmc->transSize; ++index ) {
+        target[ fsmc->states[ fsmc->trans[ fsmc->rows[ index ] ].to ].slot ] = 1U;
+    }
+    fprintf( output, "static fsm_bool_t s_fsmStateTarget%s[ %u ] FSM_ALIGNED( DEF_SWC_FSM_CACHE_LINE ) = {", name, fsmc->stateSize );
+    for ( index = 0; index < fsmc->stateSize; ++index ) {
+        fprintf( output, "%s%uU%s", ( index % 16U ) ? " " : "\n    ", target[ index ], ( index + 1U < fsmc->stateSize ) ? "," : "" );
+    }
+    fprintf( output, "\n};\n\n" );
+    free( target );
+
+    fprintf( output, "DECLARE_SWC_FSM_CONTEXT_PREBUILT( %s, %u, %s, %s, DEF_STATE_%s_%s, %u, %s, %s, %s )\n\n", name, fsmc->id,
+             fsmcOr( fsmc->check ), fsmcOr( fsmc->error ), name, fsmc->init, fsmc->interval,
+             fsmcOr( fsmc->hookInit ), fsmcOr( fsmc->hookRoutine ), fsmcOr( fsmc->hookExit ) );
+    fprintf( output, "#endif\n" );
+}
+
+int main( int argc, char* argv[] )
+{
+    Fsmc fsmc;
+    FILE* input = NULL;
+    FILE* output = stdout;
+    const char* outputPath = NULL;
+    int bPrototypes = 1;
+    int index = 0;
+
+    memset( &fsmc, 0, sizeof( fsmc ) );
+
+    for ( index = 1; index < argc; ++index ) {
+        if ( !strcmp( argv[ index ], "-o" ) && ( index + 1 < argc ) ) {
+            outputPath = argv[ ++index ];
+        } else if ( !strcmp( argv[ index ], "-n" ) ) {
+            bPrototypes = 0;
+        } else if ( ( argv[ index ][ 0 ] != '-' ) && !fsmc.path ) {
+            fsmc.path = argv[ index ];
+        } else {
+            fsmc.path = NULL;
+            break;
+        }
+    }
+
+    if ( !fsmc.path ) {
+        fprintf( stderr, "usage: %s [ -o output.h ] [ -n ] input.fsm\n", argv[ 0 ] );
+        return 2;
+    }
+
+    input = fopen( fsmc.path, "r" );
+    if ( !input ) {
+        perror( fsmc.path );
+        return 2;
+    }
+    fsmcParse( &fsmc, input );
+    fclose( input );
+
+    fsmcResolve( &fsmc );
+    if ( fsmc.errors == 0U )    fsmcPrototypes( &fsmc, NULL );
+
+    if ( fsmc.errors ) {
+        fprintf( stderr, "%s: %u error%s\n", fsmc.path, fsmc.errors, ( fsmc.errors > 1U ) ? "s" : "" );
+        return 1;
+    }
+
+    if ( outputPath ) {
+        output = fopen( outputPath, "w" );
+        if ( !output ) {
+            perror( outputPath );
+            return 2;
+        }
+    }
+
+    fsmcEmit( &fsmc, output, bPrototypes );
+
+    if ( outputPath && ( fclose( output ) != 0 ) ) {
+        perror( outputPath );
+        return 2;
+    }
+
+    free( fsmc.states );
+    free( fsmc.trans );
+    free( fsmc.order );
+    free( fsmc.offset );
+    free( fsmc.rows );
+
+    return 0;
+}